@@ -0,0 +1,41 @@
+#ifndef BYTE_HISTOGRAM_HPP
+#define BYTE_HISTOGRAM_HPP
+
+#include<cstddef>
+#include<stdint.h>
+
+/**
+ * @brief Byte-frequency kernels used by ByteMoments (and so by DataRandomness).
+ *
+ * A single counter table serializes on random data: consecutive equal bytes increment the same counter, and each
+ * increment waits for the previous store. The kernels spread consecutive elements over four interleaved uint32_t
+ * sub-histograms, flushed into the caller's 64-bit totals before any counter could overflow.
+ */
+namespace ByteHistogram {
+
+enum struct Kernel {
+	Auto,									// -Scalar; see below
+	Scalar,									// -Four sub-histograms, 8-byte loads when contiguous
+	AVX2,									// -Strided access: 8 elements per gather
+	AVX512									// -Strided access: 16 elements per gather
+};
+
+/**
+ * @brief True if 'kernel' can run on this CPU. Auto and Scalar always can.
+ */
+bool supported(Kernel kernel);
+
+/**
+ * @brief Adds the counts of data[0], data[stride], ..., data[(count - 1)*stride] to 'histogram'.
+ *
+ * The SIMD kernels only change how strided elements are loaded; the counting itself stays one increment per element,
+ * and that increment is what bounds every kernel. Measured on AVX-512 hardware (256 MiB of random bytes, strides 3, 4
+ * and 16), gathers ran 10-55% slower than scalar strided loads, so Auto takes the scalar kernel. Contiguous data
+ * (stride 1) always does.
+ * @throws std::invalid_argument for null data with a nonzero count, a zero stride, or a kernel this CPU lacks.
+ */
+void accumulate(const uint8_t* data, size_t count, size_t stride, uint64_t histogram[256], Kernel kernel = Kernel::Auto);
+
+} // namespace ByteHistogram
+
+#endif // BYTE_HISTOGRAM_HPP
@@ -0,0 +1,56 @@
+#ifndef BYTE_MOMENTS_HPP
+#define BYTE_MOMENTS_HPP
+
+#include<cstddef>
+#include<stdint.h>
+#include<vector>
+
+/**
+ * @struct ByteMoments
+ * @brief Exact integer statistics of a byte sequence, gathered in one sweep over the data.
+ *
+ * The sequence is x[m] = data[start + m*stride], m < count. The sweep builds the histogram and, for each requested lag
+ * k, the lag product sum P_k = sum of x[m]*x[(m+k) mod count] (pairs wrap around, as DataRandomness has always done).
+ * Sum and sum of squares follow from the histogram. All sums are 64-bit integers, so the metrics derived at the end
+ * do not depend on the order in which bytes were added.
+ */
+struct ByteMoments {
+	uint64_t histogram[256] = {0};
+	uint64_t count = 0;
+	std::vector<size_t> lags;
+	std::vector<uint64_t> lagProducts;						// -One per lag, same order
+
+	/**
+	 * @brief Single pass over 'data'. Lags are taken modulo the length of the sequence.
+	 *
+	 * With 'threads' other than one, sequences of at least 2 Mi elements are split into one contiguous range per
+	 * worker. Each worker counts its range and every lag pair starting in it, reading up to k elements into the next
+	 * range (or wrapping to the front), so no pair is lost or counted twice at a boundary. The integer partial sums are
+	 * added afterwards and the result equals the serial one exactly.
+	 * @param threads Zero: ThreadPool::shared(). One: serial, on the calling thread. More: a pool of that size, for this
+	 * call. Calls from a pool worker run serially.
+	 * @throws std::invalid_argument if the sequence is empty (null data, start past the end) or stride is zero.
+	 */
+	static ByteMoments measure(const uint8_t* data, size_t size, size_t start, size_t stride, const std::vector<size_t>& lags,
+	                           size_t threads);
+	static ByteMoments measure(const uint8_t* data, size_t size, size_t start, size_t stride, const std::vector<size_t>& lags);
+	static ByteMoments measure(const uint8_t* data, size_t size, const std::vector<size_t>& lags);
+
+	uint64_t sum() const;
+	uint64_t sumSquares() const;
+
+	/**
+	 * @brief Shannon entropy (bits per byte) and chi-square against the uniform distribution, computed from the
+	 * histogram. These are the values DataRandomness reports.
+	 */
+	double entropy() const;
+	double chiSquare() const;
+
+	/**
+	 * @brief Pearson correlation between x[m] and x[m+k] for lags[lagIndex]:
+	 * (n*P_k - S^2) / (n*Q - S^2), evaluated in 128-bit integers. NaN for a constant sequence.
+	 */
+	double correlation(size_t lagIndex) const;
+};
+
+#endif // BYTE_MOMENTS_HPP
@@ -1,6 +1,7 @@
 #include<cstddef>
 #include<stdint.h>
 #include<vector>
+#include"byte_moments.hpp"
 
 class DataRandomness {								// -Specialized to handle data from raw bytes
 private:
@@ -14,29 +15,40 @@ private:
 	size_t byteValueFrequence[256] = {0};
 
 	/**
-	 * Functions include jump_size to be capable of analysing structured data sets. For example, analyse the randomness metrics for the green component of the
-	 * pixels of an image.
+	 * Metrics come from a ByteMoments sweep: histogram and lag products in one pass over the data. A sweep may cover a
+	 * structured subset (start, jump_size), for example the green component of the pixels of an image.
 	 */
-	void get_byteValueFrequence(const std::vector<std::byte>& data, size_t start, size_t jump_size);
-	void calculate_entropy();
-	void calculate_ChiSquare();
-	static double calculateCorrelationSubArray(const std::vector<std::byte>& data, size_t start, size_t jump_size, size_t offset);
+	void set_moments(const ByteMoments& moments);
 
 	DataRandomness() = default;						// -Private constructor, only accessible inside the class
 	DataRandomness& operator = (const DataRandomness&);			// -Not allowing copy assigment
 
 public:
-	explicit DataRandomness(const std::vector<std::byte>& data);
+	/**
+	 * @param threads Workers for the sweep, as in ByteMoments::measure(): zero for ThreadPool::shared(), one for serial.
+	 * Every choice gives the same metrics.
+	 */
+	explicit DataRandomness(const std::vector<std::byte>& data, size_t threads = 0);
+	/**
+	 * @brief Metrics from moments measured elsewhere (ByteMoments::measure(), RandomnessAccumulator). The adjacent byte
+	 * correlation is read from the first lag, which must be 1.
+	 * @throws std::invalid_argument if the moments are empty or their first lag is not 1.
+	 */
+	explicit DataRandomness(const ByteMoments& moments);
 	DataRandomness(const DataRandomness&);
 	~DataRandomness();
 
 	static double calculateCorrelation(const std::vector<std::byte>& data, size_t offset);
 	/**
 	 * @brief Computes the randomness metrics on the bytes holded by the 'data' vector and separated by an specyfied amount.
-	 * @param jump_size The separation of the bytes being analyzed.
+	 * For interleaved pixels, start = c and jump_size = channels analyse channel c alone.
+	 * @param jump_size The separation of the bytes being analyzed; zero is taken as one.
+	 * @param threads Workers for the sweep, as in the constructor.
+	 * @throws std::runtime_error if 'data' is empty; std::out_of_range if 'start' is not an index of 'data'.
 	 * @return DataRandomness class instance containing the result.
 	*/
-	static DataRandomness calculateDataRandomnessSubArray(const std::vector<std::byte>& data, size_t start, size_t jump_size);
+	static DataRandomness calculateDataRandomnessSubArray(const std::vector<std::byte>& data, size_t start, size_t jump_size,
+	                                                      size_t threads = 0);
 
 	double getEntropy() const noexcept;
 	double getChiSquare() const noexcept;
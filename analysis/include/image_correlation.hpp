@@ -0,0 +1,63 @@
+#ifndef IMAGE_CORRELATION_HPP
+#define IMAGE_CORRELATION_HPP
+
+#include<cstddef>
+#include<stdint.h>
+#include<vector>
+
+/**
+ * @class ImageCorrelation
+ * @brief Correlation of neighbouring pixels, per channel, for the three directions image-encryption papers report.
+ *
+ * Pixel (r, c) is paired with (r, c+1) horizontally, (r+1, c) vertically and (r+1, c+1) diagonally; every such pair
+ * inside the image is counted once, nothing wraps around. For each channel and direction the sweep keeps exact integer
+ * moments of the pairs (x, y), and the coefficient is Pearson's
+ *   (N*Sxy - Sx*Sy) / sqrt((N*Sxx - Sx^2) * (N*Syy - Sy^2)).
+ *
+ * One sweep covers all directions: each row is read together with the next one while both are in cache. Row sums and
+ * products are accumulated in uint32_t lanes, a multiple of the channel count wide, so the inner loops are plain
+ * element-wise multiply-adds the compiler vectorizes; lanes are folded into 64-bit channel totals at the end. Per-row
+ * first and last pixels turn the row sums into the sums of each direction's x and y sides.
+ */
+class ImageCorrelation {
+public:
+	enum struct Direction { Horizontal, Vertical, Diagonal, Count };
+	static const char*const DirectionLabels[static_cast<unsigned>(Direction::Count)];
+
+	struct Moments {
+		uint64_t count = 0;							// -Pairs
+		uint64_t sumX = 0, sumY = 0;
+		uint64_t sumXX = 0, sumYY = 0;
+		uint64_t sumXY = 0;
+
+		/**
+		 * @brief Pearson's coefficient; NaN when there are no pairs or one side is constant.
+		 */
+		double correlation() const;
+	};
+
+	/**
+	 * @brief Measures 'pixels': top-down rows of width*channels bytes, no padding, channels interleaved.
+	 *
+	 * With 'threads' other than one, images of at least 2 MiB are split into bands of rows, one per worker. A band
+	 * owns the pairs whose first pixel lies in it, reading the first row of the next band for vertical and diagonal
+	 * ones, so the integer sums add up to the serial ones exactly.
+	 * @param threads Zero: ThreadPool::shared(). One: serial. More: a pool of that size, for this call. Calls from a
+	 * pool worker run serially.
+	 * @throws std::invalid_argument for null pixels, a zero dimension, or a channel count outside 1..4.
+	 */
+	static ImageCorrelation measure(const uint8_t* pixels, size_t width, size_t height, size_t channels, size_t threads = 0);
+
+	size_t channels() const { return this->moments_.size() / static_cast<size_t>(Direction::Count); }
+
+	/**
+	 * @throws std::out_of_range if 'channel' is not below channels().
+	 */
+	const Moments& moments(size_t channel, Direction direction) const;
+	double correlation(size_t channel, Direction direction) const { return this->moments(channel, direction).correlation(); }
+
+private:
+	std::vector<Moments> moments_;						// -channel*3 + direction
+};
+
+#endif // IMAGE_CORRELATION_HPP
@@ -0,0 +1,54 @@
+#ifndef RANDOMNESS_ACCUMULATOR_HPP
+#define RANDOMNESS_ACCUMULATOR_HPP
+
+#include<cstddef>
+#include<stdint.h>
+#include<vector>
+#include"byte_moments.hpp"
+
+/**
+ * @class RandomnessAccumulator
+ * @brief Builds the ByteMoments of a byte stream from chunks, without holding the stream in memory.
+ *
+ * The state is the histogram, the lag products of the pairs seen so far, and the first and last max(lags) bytes of
+ * the stream. The last bytes pair with the start of the next chunk; at finalize() the first bytes close the pairs that
+ * wrap around the end, as in ByteMoments::measure(). The result does not depend on how the stream was cut.
+ *
+ * Accumulators fed with consecutive pieces of a stream (one per thread, for instance) are combined with merge(),
+ * which appends the bytes of the argument after those of the object.
+ */
+class RandomnessAccumulator {
+public:
+	explicit RandomnessAccumulator(const std::vector<size_t>& lags = {1});
+
+	/**
+	 * @brief Appends 'size' bytes to the stream.
+	 */
+	void update(const uint8_t* data, size_t size);
+
+	/**
+	 * @brief Appends the stream of 'next' to this one.
+	 * @throws std::invalid_argument if the two accumulators were built with different lags.
+	 */
+	void merge(const RandomnessAccumulator& next);
+
+	/**
+	 * @brief Moments of the stream so far, equal to ByteMoments::measure() on the whole stream. The accumulator can
+	 * keep receiving bytes afterwards.
+	 * @throws std::logic_error if no bytes were added.
+	 */
+	ByteMoments finalize() const;
+
+	uint64_t count() const { return this->count_; }
+
+private:
+	std::vector<size_t> lags;
+	size_t maxLag = 0;
+	uint64_t histogram[256] = {0};
+	uint64_t count_ = 0;
+	std::vector<uint64_t> lagProducts;						// -Pairs (i, i+k) with both ends in the stream, no wrap
+	std::vector<uint8_t> head;							// -First maxLag bytes (all of them while the stream is shorter)
+	std::vector<uint8_t> tail;							// -Last maxLag bytes, same
+};
+
+#endif // RANDOMNESS_ACCUMULATOR_HPP
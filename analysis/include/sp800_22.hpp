@@ -0,0 +1,70 @@
+#ifndef SP800_22_HPP
+#define SP800_22_HPP
+
+#include<cstddef>
+#include<stdint.h>
+
+/**
+ * @brief Bit-level tests of NIST SP 800-22 rev. 1a over byte buffers: frequency (monobit), frequency within a block,
+ * runs, longest run of ones in a block, serial and approximate entropy.
+ *
+ * Bytes are read most significant bit first, so bit i of the sequence is bit 7 - i%8 of byte i/8. Counting works on
+ * whole words: one pass over big-endian words takes the ones (64-bit popcount), the runs (popcount(w ^ (w << 1))) and
+ * the ones of each frequency block (masked popcounts where a block ends inside a word); longest runs use per-byte tables
+ * of leading, trailing and inner runs, and the serial and approximate entropy tests share a second pass that counts the
+ * overlapping (cyclic) patterns of the widest length needed; shorter patterns follow by marginalizing. The popcount
+ * kernels take the POPCNT instruction when the CPU has it (checked at run time).
+ *
+ * The pattern lengths are upper bounds: SP 800-22 requires m < floor(log2 n) - 2 for the serial test and
+ * m < floor(log2 n) - 5 for approximate entropy, so shorter sequences are tested with the largest m they allow (the
+ * defaults apply from 64 KiB; 1 KiB gets 10 and 7). Results records the lengths used.
+ *
+ * These tests catch structure byte histograms miss: a repeated IV or ECB over repetitive plaintext repeats ciphertext
+ * blocks, which leaves byte frequencies uniform but fails the serial and approximate entropy tests.
+ */
+namespace SP800_22 {
+
+struct Config {
+	size_t blockFrequencyBits = 128;					// -M of the block frequency test
+	size_t serialBits = 16;							// -Largest m of the serial test, 3..20
+	size_t approximateEntropyBits = 10;					// -Largest m of the approximate entropy test, 1..19
+};
+
+struct Outcome {
+	double statistic = 0.0;
+	double pValue = 0.0;
+};
+
+struct Results {
+	uint64_t bits = 0;
+	size_t serialBits = 0;							// -m used, after the bound on n
+	size_t approximateEntropyBits = 0;
+	Outcome monobit;							// -|S_n| / sqrt(n)
+	Outcome blockFrequency;							// -chi^2
+	Outcome runs;								// -V_n, the number of runs; p = 0 when the monobit prerequisite fails
+	Outcome longestRun;							// -chi^2 over the run-length classes
+	Outcome serial1;							// -Delta psi^2_m
+	Outcome serial2;							// -Delta^2 psi^2_m
+	Outcome approximateEntropy;						// -chi^2 = 2n(ln 2 - ApEn)
+
+	/**
+	 * @brief True if every p-value is at least 'alpha'.
+	 */
+	bool passed(double alpha = 0.01) const;
+};
+
+/**
+ * @brief Runs the battery over the 8*size bits of 'data'.
+ * @throws std::invalid_argument for fewer than 128 bits, null data, or a configuration outside the ranges above (or a
+ * block frequency block longer than the sequence).
+ */
+Results run(const uint8_t* data, size_t size, const Config& config = Config());
+
+/**
+ * @brief Regularized upper incomplete gamma function Q(a, x), which gives the p-values: igamc(df/2, chi^2/2).
+ */
+double igamc(double a, double x);
+
+} // namespace SP800_22
+
+#endif // SP800_22_HPP
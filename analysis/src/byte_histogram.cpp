@@ -0,0 +1,144 @@
+#include"../include/byte_histogram.hpp"
+#include<cstring>
+#include<stdexcept>
+#include<string>
+#if defined(__x86_64__) && defined(__GNUC__)
+#include<immintrin.h>
+#endif
+
+namespace {
+
+const size_t FLUSH_ELEMENTS = size_t(1) << 30;                                  // -Keeps every uint32_t counter below 2^32
+
+struct SubHistograms {
+    uint32_t table[4][256];
+
+    void clear() { std::memset(this->table, 0, sizeof(this->table)); }
+    void flush(uint64_t histogram[256]) const {
+        for(size_t v = 0; v < 256; v++) {
+            histogram[v] += static_cast<uint64_t>(this->table[0][v]) + this->table[1][v] + this->table[2][v] + this->table[3][v];
+        }
+    }
+};
+
+void contiguous(const uint8_t* p, size_t n, SubHistograms& s) {
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, p + i, 8);
+        s.table[0][w & 0xFF]++;
+        s.table[1][w >> 8 & 0xFF]++;
+        s.table[2][w >> 16 & 0xFF]++;
+        s.table[3][w >> 24 & 0xFF]++;
+        s.table[0][w >> 32 & 0xFF]++;
+        s.table[1][w >> 40 & 0xFF]++;
+        s.table[2][w >> 48 & 0xFF]++;
+        s.table[3][w >> 56]++;
+    }
+    for(; i < n; i++) s.table[i & 3][p[i]]++;
+}
+
+void strided(const uint8_t* p, size_t n, size_t stride, SubHistograms& s) {
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4) {
+        s.table[0][p[i*stride]]++;
+        s.table[1][p[(i + 1)*stride]]++;
+        s.table[2][p[(i + 2)*stride]]++;
+        s.table[3][p[(i + 3)*stride]]++;
+    }
+    for(; i < n; i++) s.table[i & 3][p[i*stride]]++;
+}
+
+#if defined(__x86_64__) && defined(__GNUC__)
+/*
+ * Gathers load 32 bits per lane, so a lane may read 3 bytes past its element: the SIMD loops stop while the last lane
+ * is still 4 bytes inside the data and return how many elements they counted; the scalar kernel does the rest.
+ * Lane offsets are 32-bit, which bounds the stride.
+ * */
+__attribute__((target("avx2")))
+size_t strided_avx2(const uint8_t* p, size_t n, size_t stride, SubHistograms& s) {
+    if(n < 8 || stride > (size_t(1) << 27)) return 0;
+    const size_t span = (n - 1)*stride + 1;
+    const __m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(static_cast<int>(stride)));
+    const __m256i low = _mm256_set1_epi32(0xFF);
+    alignas(32) uint32_t v[8];
+    size_t i = 0;
+    for(; (i + 7)*stride + 4 <= span; i += 8) {
+        const __m256i g = _mm256_i32gather_epi32(reinterpret_cast<const int*>(p + i*stride), offsets, 1);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(v), _mm256_and_si256(g, low));
+        s.table[0][v[0]]++; s.table[1][v[1]]++; s.table[2][v[2]]++; s.table[3][v[3]]++;
+        s.table[0][v[4]]++; s.table[1][v[5]]++; s.table[2][v[6]]++; s.table[3][v[7]]++;
+    }
+    return i;
+}
+
+__attribute__((target("avx512f")))
+size_t strided_avx512(const uint8_t* p, size_t n, size_t stride, SubHistograms& s) {
+    if(n < 16 || stride > (size_t(1) << 26)) return 0;
+    const size_t span = (n - 1)*stride + 1;
+    const __m512i offsets = _mm512_mullo_epi32(
+        _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(static_cast<int>(stride)));
+    const __m512i low = _mm512_set1_epi32(0xFF);
+    alignas(64) uint32_t v[16];
+    size_t i = 0;
+    for(; (i + 15)*stride + 4 <= span; i += 16) {
+        const __m512i g = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), 0xFFFF, offsets, p + i*stride, 1);
+        _mm512_store_si512(v, _mm512_and_si512(g, low));
+        for(size_t j = 0; j < 16; j += 4) {
+            s.table[0][v[j]]++; s.table[1][v[j + 1]]++; s.table[2][v[j + 2]]++; s.table[3][v[j + 3]]++;
+        }
+    }
+    return i;
+}
+#endif
+
+} // namespace
+
+bool ByteHistogram::supported(Kernel kernel) {
+    switch(kernel) {
+        case Kernel::Auto:
+        case Kernel::Scalar:
+            return true;
+#if defined(__x86_64__) && defined(__GNUC__)
+        case Kernel::AVX2:
+            return __builtin_cpu_supports("avx2");
+        case Kernel::AVX512:
+            return __builtin_cpu_supports("avx512f");
+#else
+        case Kernel::AVX2:
+        case Kernel::AVX512:
+            return false;
+#endif
+    }
+    return false;
+}
+
+void ByteHistogram::accumulate(const uint8_t* data, size_t count, size_t stride, uint64_t histogram[256], Kernel kernel) {
+    if(count == 0) return;
+    if(data == nullptr || stride == 0) {
+        throw std::invalid_argument(
+            "In function ByteHistogram::accumulate(...): null data or zero stride (stride " + std::to_string(stride) + ")"
+        );
+    }
+    if(!supported(kernel)) {
+        throw std::invalid_argument("In function ByteHistogram::accumulate(...): kernel not supported on this CPU");
+    }
+
+    SubHistograms s;
+    for(size_t done = 0; done < count; done += FLUSH_ELEMENTS) {
+        const size_t n = count - done < FLUSH_ELEMENTS ? count - done : FLUSH_ELEMENTS;
+        const uint8_t* p = data + done*stride;
+        s.clear();
+        if(stride == 1) {
+            contiguous(p, n, s);
+        } else {
+            size_t i = 0;
+#if defined(__x86_64__) && defined(__GNUC__)
+            if(kernel == Kernel::AVX512)    i = strided_avx512(p, n, stride, s);
+            else if(kernel == Kernel::AVX2) i = strided_avx2(p, n, stride, s);
+#endif
+            strided(p + i*stride, n - i, stride, s);
+        }
+        s.flush(histogram);
+    }
+}
@@ -0,0 +1,169 @@
+#include"../include/byte_moments.hpp"
+#include"../include/byte_histogram.hpp"
+#include"../../core-crypto/include/thread_pool.hpp"
+#include<cmath>
+#include<future>
+#include<limits>
+#include<memory>
+#include<stdexcept>
+#include<string>
+
+__extension__ typedef __int128 int128_t;
+
+namespace {
+
+const size_t SWEEP_BLOCK = 64*1024;                                             // -Elements per block, kept hot between the two loops
+const size_t PARALLEL_CHUNK = 1024*1024;                                        // -Smallest range given to a worker
+
+/*
+ * Histogram and lag products of the elements first..last-1 of x[m] = base[m*stride], m < n: every pair (i, i+k mod n)
+ * whose first element is in the range, so ranges that tile the sequence count each pair exactly once, whichever range
+ * its second element falls in. Block by block: each block is counted, then multiplied with the elements k positions
+ * ahead while it is still in cache, so memory is swept once. FixedStride 1 lets the contiguous case compile to
+ * unit-stride loops.
+ * */
+template<size_t FixedStride>
+void sweep(const uint8_t* base, size_t runtimeStride, size_t n, size_t first, size_t last, const std::vector<size_t>& lags,
+           uint64_t histogram[256], uint64_t* lagProducts) {
+    const size_t stride = FixedStride != 0 ? FixedStride : runtimeStride;
+    for(size_t b = first; b < last; b += SWEEP_BLOCK) {
+        const size_t e = b + SWEEP_BLOCK < last ? b + SWEEP_BLOCK : last;
+        ByteHistogram::accumulate(base + b*stride, e - b, stride, histogram);
+        for(size_t l = 0; l < lags.size(); l++) {
+            const size_t k = lags[l];
+            const size_t end = e < n - k ? e : n - k;                           // -Pairs that do not wrap
+            uint64_t products = 0;
+            for(size_t i = b; i < end; i++) products += static_cast<uint64_t>(base[i*stride]) * base[(i + k)*stride];
+            lagProducts[l] += products;
+        }
+    }
+    for(size_t l = 0; l < lags.size(); l++) {                                   // -Wrapping pairs: the last k with the first k
+        const size_t k = lags[l];
+        uint64_t products = 0;
+        for(size_t i = first > n - k ? first : n - k; i < last; i++) {
+            products += static_cast<uint64_t>(base[i*stride]) * base[(i + k - n)*stride];
+        }
+        lagProducts[l] += products;
+    }
+}
+
+void sweep(const uint8_t* base, size_t stride, size_t n, size_t first, size_t last, const std::vector<size_t>& lags,
+           uint64_t histogram[256], uint64_t* lagProducts) {
+    if(stride == 1) sweep<1>(base, 1, n, first, last, lags, histogram, lagProducts);
+    else            sweep<0>(base, stride, n, first, last, lags, histogram, lagProducts);
+}
+
+struct Partial {
+    uint64_t histogram[256] = {0};
+    std::vector<uint64_t> lagProducts;
+};
+
+} // namespace
+
+ByteMoments ByteMoments::measure(const uint8_t* data, size_t size, size_t start, size_t stride, const std::vector<size_t>& lags,
+                                 size_t threads) {
+    if(data == nullptr || start >= size || stride == 0) {
+        throw std::invalid_argument(
+            "In static member function ByteMoments::measure(...): empty sequence (size " + std::to_string(size) +
+            ", start " + std::to_string(start) + ", stride " + std::to_string(stride) + ")"
+        );
+    }
+    ByteMoments m;
+    m.count = (size - start + stride - 1) / stride;
+    m.lags.reserve(lags.size());
+    for(size_t k : lags) m.lags.push_back(k % m.count);
+    m.lagProducts.assign(lags.size(), 0);
+    const uint8_t* base = data + start;
+    const size_t n = m.count;
+
+    std::unique_ptr<CipherFortis::ThreadPool> ownPool;
+    CipherFortis::ThreadPool* pool = nullptr;
+    if(threads != 1 && n >= 2*PARALLEL_CHUNK) {
+        if(threads == 0) {
+            pool = &CipherFortis::ThreadPool::shared();
+        } else {
+            CipherFortis::ThreadPool::Config config;
+            config.threadCount = threads;
+            ownPool = std::make_unique<CipherFortis::ThreadPool>(config);
+            pool = ownPool.get();
+        }
+        if(pool->isWorkerThread()) pool = nullptr;                              // -Blocking on our own workers could deadlock
+    }
+    if(pool == nullptr) {
+        sweep(base, stride, n, 0, n, m.lags, m.histogram, m.lagProducts.data());
+        return m;
+    }
+
+    // One range per worker, at least PARALLEL_CHUNK elements each. Each range owns the pairs that start in it, so the
+    // partial sums add up to exactly the serial ones.
+    size_t tasks = pool->getThreadCount();
+    if(tasks > n / PARALLEL_CHUNK) tasks = n / PARALLEL_CHUNK;
+    std::vector<std::future<Partial>> partials;
+    partials.reserve(tasks);
+    for(size_t t = 0; t < tasks; t++) {
+        const size_t first = n / tasks * t, last = t + 1 == tasks ? n : n / tasks * (t + 1);
+        const std::vector<size_t>* lagList = &m.lags;
+        partials.push_back(pool->async([=]() {
+            Partial partial;
+            partial.lagProducts.assign(lagList->size(), 0);
+            sweep(base, stride, n, first, last, *lagList, partial.histogram, partial.lagProducts.data());
+            return partial;
+        }));
+    }
+    for(std::future<Partial>& f : partials) f.wait();                           // -All done before any rethrow
+    for(std::future<Partial>& f : partials) {
+        const Partial partial = f.get();
+        for(size_t v = 0; v < 256; v++) m.histogram[v] += partial.histogram[v];
+        for(size_t l = 0; l < m.lags.size(); l++) m.lagProducts[l] += partial.lagProducts[l];
+    }
+    return m;
+}
+
+ByteMoments ByteMoments::measure(const uint8_t* data, size_t size, size_t start, size_t stride, const std::vector<size_t>& lags) {
+    return measure(data, size, start, stride, lags, 1);
+}
+
+ByteMoments ByteMoments::measure(const uint8_t* data, size_t size, const std::vector<size_t>& lags) {
+    return measure(data, size, 0, 1, lags, 1);
+}
+
+uint64_t ByteMoments::sum() const {
+    uint64_t s = 0;
+    for(uint64_t v = 0; v < 256; v++) s += v * this->histogram[v];
+    return s;
+}
+
+uint64_t ByteMoments::sumSquares() const {
+    uint64_t s = 0;
+    for(uint64_t v = 0; v < 256; v++) s += v * v * this->histogram[v];
+    return s;
+}
+
+double ByteMoments::entropy() const {
+    double entropy = 0.0, probability;
+    for(const uint64_t& freq : this->histogram) {
+        if(freq > 0) {
+            probability = static_cast<double>(freq) / static_cast<double>(this->count);
+            entropy -= probability * std::log2(probability);
+        }
+    }
+    return entropy;
+}
+
+double ByteMoments::chiSquare() const {
+    double chiSquare = 0.0;
+    for(const uint64_t& freq : this->histogram) chiSquare += static_cast<double>(freq*freq);
+    chiSquare *= 256.0/static_cast<double>(this->count);
+    chiSquare -= static_cast<double>(this->count);
+    return chiSquare;
+}
+
+double ByteMoments::correlation(size_t lagIndex) const {
+    if(lagIndex >= this->lagProducts.size()) {
+        throw std::out_of_range("In member function ByteMoments::correlation(size_t) const: no lag " + std::to_string(lagIndex));
+    }
+    const int128_t n = this->count, s = this->sum(), q = this->sumSquares(), p = this->lagProducts[lagIndex];
+    const int128_t denominator = n*q - s*s;
+    if(denominator == 0) return std::numeric_limits<double>::quiet_NaN();
+    return static_cast<double>(n*p - s*s) / static_cast<double>(denominator);
+}
@@ -0,0 +1,212 @@
+#include"../include/image_correlation.hpp"
+#include"../../core-crypto/include/thread_pool.hpp"
+#include<cmath>
+#include<future>
+#include<limits>
+#include<memory>
+#include<stdexcept>
+#include<string>
+
+__extension__ typedef __int128 int128_t;
+
+const char*const ImageCorrelation::DirectionLabels[static_cast<unsigned>(ImageCorrelation::Direction::Count)] = {
+    "Horizontal", "Vertical", "Diagonal"
+};
+
+namespace {
+
+const size_t PARALLEL_BAND = 1024*1024;                                         // -Smallest band given to a worker, in bytes
+const size_t LANE_FLUSH_STEPS = 65536;                                          // -65536*255*255 < 2^32
+
+/*
+ * lanes[j] += sum of x[i]*y[i] over i < n, i = j mod L. Runs of up to LANE_FLUSH_STEPS groups of L go to uint32_t
+ * accumulators first; the fixed-width inner loop is what the compiler vectorizes.
+ * */
+template<size_t L>
+void dot(const uint8_t* x, const uint8_t* y, size_t n, uint64_t lanes[L]) {
+    const size_t whole = n / L * L;
+    size_t i = 0;
+    while(i < whole) {
+        uint32_t acc[L] = {0};
+        const size_t stop = whole - i > LANE_FLUSH_STEPS*L ? i + LANE_FLUSH_STEPS*L : whole;
+        for(; i < stop; i += L) {
+            for(size_t j = 0; j < L; j++) acc[j] += static_cast<uint32_t>(x[i + j]) * y[i + j];
+        }
+        for(size_t j = 0; j < L; j++) lanes[j] += acc[j];
+    }
+    for(; i < n; i++) lanes[i - whole] += static_cast<uint32_t>(x[i]) * y[i];
+}
+
+template<size_t L>
+void sum(const uint8_t* x, size_t n, uint64_t lanes[L]) {
+    const size_t whole = n / L * L;
+    size_t i = 0;
+    while(i < whole) {
+        uint32_t acc[L] = {0};
+        const size_t stop = whole - i > LANE_FLUSH_STEPS*L ? i + LANE_FLUSH_STEPS*L : whole;
+        for(; i < stop; i += L) {
+            for(size_t j = 0; j < L; j++) acc[j] += x[i + j];
+        }
+        for(size_t j = 0; j < L; j++) lanes[j] += acc[j];
+    }
+    for(; i < n; i++) lanes[i - whole] += x[i];
+}
+
+/*
+ * Integer totals of one channel over a band of rows. 'first' and 'last' are the first and last pixels of each row;
+ * vertical and diagonal products pair each row with the next one.
+ * */
+struct ChannelTotals {
+    uint64_t sum = 0, squares = 0;
+    uint64_t firstSum = 0, firstSquares = 0;
+    uint64_t lastSum = 0, lastSquares = 0;
+    uint64_t horizontal = 0, vertical = 0, diagonal = 0;
+
+    ChannelTotals& operator += (const ChannelTotals& other) {
+        this->sum += other.sum;               this->squares += other.squares;
+        this->firstSum += other.firstSum;     this->firstSquares += other.firstSquares;
+        this->lastSum += other.lastSum;       this->lastSquares += other.lastSquares;
+        this->horizontal += other.horizontal; this->vertical += other.vertical; this->diagonal += other.diagonal;
+        return *this;
+    }
+};
+
+/*
+ * Rows first..last-1 and the pairs they own. L is a multiple of the channel count, so lane j belongs to channel
+ * j mod channels in every row.
+ * */
+template<size_t L>
+std::vector<ChannelTotals> band(const uint8_t* pixels, size_t width, size_t height, size_t channels, size_t first, size_t last) {
+    uint64_t s[L] = {0}, q[L] = {0}, hz[L] = {0}, vt[L] = {0}, dg[L] = {0};
+    std::vector<ChannelTotals> totals(channels);
+    const size_t rowBytes = width*channels;
+    for(size_t r = first; r < last; r++) {
+        const uint8_t* row = pixels + r*rowBytes;
+        sum<L>(row, rowBytes, s);
+        dot<L>(row, row, rowBytes, q);
+        dot<L>(row, row + channels, rowBytes - channels, hz);
+        if(r + 1 < height) {                                                    // -Next row is still in cache for the next r
+            const uint8_t* next = row + rowBytes;
+            dot<L>(row, next, rowBytes, vt);
+            dot<L>(row, next + channels, rowBytes - channels, dg);
+        }
+        for(size_t c = 0; c < channels; c++) {
+            const uint64_t f = row[c], l = row[rowBytes - channels + c];
+            totals[c].firstSum += f; totals[c].firstSquares += f*f;
+            totals[c].lastSum += l;  totals[c].lastSquares += l*l;
+        }
+    }
+    for(size_t j = 0; j < L; j++) {
+        ChannelTotals& t = totals[j % channels];
+        t.sum += s[j]; t.squares += q[j];
+        t.horizontal += hz[j]; t.vertical += vt[j]; t.diagonal += dg[j];
+    }
+    return totals;
+}
+
+std::vector<ChannelTotals> band(const uint8_t* pixels, size_t width, size_t height, size_t channels, size_t first, size_t last) {
+    if(channels == 3) return band<48>(pixels, width, height, channels, first, last);
+    return band<64>(pixels, width, height, channels, first, last);              // -1, 2 and 4 channels
+}
+
+} // namespace
+
+ImageCorrelation ImageCorrelation::measure(const uint8_t* pixels, size_t width, size_t height, size_t channels, size_t threads) {
+    if(pixels == nullptr || width == 0 || height == 0 || channels == 0 || channels > 4) {
+        throw std::invalid_argument(
+            "In static member function ImageCorrelation::measure(...): invalid image (" + std::to_string(width) + "x" +
+            std::to_string(height) + ", " + std::to_string(channels) + " channels)"
+        );
+    }
+    const size_t rowBytes = width*channels;
+
+    std::unique_ptr<CipherFortis::ThreadPool> ownPool;
+    CipherFortis::ThreadPool* pool = nullptr;
+    if(threads != 1 && rowBytes*height >= 2*PARALLEL_BAND && height > 1) {
+        if(threads == 0) {
+            pool = &CipherFortis::ThreadPool::shared();
+        } else {
+            CipherFortis::ThreadPool::Config config;
+            config.threadCount = threads;
+            ownPool = std::make_unique<CipherFortis::ThreadPool>(config);
+            pool = ownPool.get();
+        }
+        if(pool->isWorkerThread()) pool = nullptr;                              // -Blocking on our own workers could deadlock
+    }
+
+    std::vector<ChannelTotals> totals;
+    if(pool == nullptr) {
+        totals = band(pixels, width, height, channels, 0, height);
+    } else {
+        size_t tasks = pool->getThreadCount();
+        if(tasks > rowBytes*height / PARALLEL_BAND) tasks = rowBytes*height / PARALLEL_BAND;
+        if(tasks > height) tasks = height;
+        std::vector<std::future<std::vector<ChannelTotals>>> bands;
+        bands.reserve(tasks);
+        for(size_t t = 0; t < tasks; t++) {
+            const size_t first = height / tasks * t, last = t + 1 == tasks ? height : height / tasks * (t + 1);
+            bands.push_back(pool->async([=]() { return band(pixels, width, height, channels, first, last); }));
+        }
+        for(std::future<std::vector<ChannelTotals>>& f : bands) f.wait();     // -All done before any rethrow
+        totals.assign(channels, ChannelTotals());
+        for(std::future<std::vector<ChannelTotals>>& f : bands) {
+            const std::vector<ChannelTotals> partial = f.get();
+            for(size_t c = 0; c < channels; c++) totals[c] += partial[c];
+        }
+    }
+
+    // The x side of a pair drops the last column (horizontal), the last row (vertical) or both (diagonal); the y side
+    // drops the first ones. Sums over the first and last rows are taken here, two rows against the whole image.
+    ImageCorrelation result;
+    result.moments_.resize(channels * static_cast<size_t>(Direction::Count));
+    const uint8_t* top = pixels;
+    const uint8_t* bottom = pixels + (height - 1)*rowBytes;
+    for(size_t c = 0; c < channels; c++) {
+        const ChannelTotals& t = totals[c];
+        uint64_t topSum = 0, topSquares = 0, bottomSum = 0, bottomSquares = 0;
+        for(size_t i = c; i < rowBytes; i += channels) {
+            topSum += top[i];    topSquares += static_cast<uint64_t>(top[i])*top[i];
+            bottomSum += bottom[i]; bottomSquares += static_cast<uint64_t>(bottom[i])*bottom[i];
+        }
+        const uint64_t topFirst = top[c], bottomLast = bottom[rowBytes - channels + c];
+
+        Moments& h = result.moments_[c*3 + static_cast<size_t>(Direction::Horizontal)];
+        h.count = height*(width - 1);
+        h.sumX = t.sum - t.lastSum;   h.sumXX = t.squares - t.lastSquares;
+        h.sumY = t.sum - t.firstSum;  h.sumYY = t.squares - t.firstSquares;
+        h.sumXY = t.horizontal;
+
+        Moments& v = result.moments_[c*3 + static_cast<size_t>(Direction::Vertical)];
+        v.count = (height - 1)*width;
+        v.sumX = t.sum - bottomSum;   v.sumXX = t.squares - bottomSquares;
+        v.sumY = t.sum - topSum;      v.sumYY = t.squares - topSquares;
+        v.sumXY = t.vertical;
+
+        Moments& d = result.moments_[c*3 + static_cast<size_t>(Direction::Diagonal)];
+        d.count = (height - 1)*(width - 1);
+        d.sumX = h.sumX - (bottomSum - bottomLast);
+        d.sumXX = h.sumXX - (bottomSquares - bottomLast*bottomLast);
+        d.sumY = h.sumY - (topSum - topFirst);
+        d.sumYY = h.sumYY - (topSquares - topFirst*topFirst);
+        d.sumXY = t.diagonal;
+    }
+    return result;
+}
+
+const ImageCorrelation::Moments& ImageCorrelation::moments(size_t channel, Direction direction) const {
+    if(channel >= this->channels() || direction == Direction::Count) {
+        throw std::out_of_range(
+            "In member function ImageCorrelation::moments(size_t, Direction) const: no channel " + std::to_string(channel)
+        );
+    }
+    return this->moments_[channel*3 + static_cast<size_t>(direction)];
+}
+
+double ImageCorrelation::Moments::correlation() const {
+    const int128_t n = this->count, sx = this->sumX, sy = this->sumY;
+    const int128_t vx = n*static_cast<int128_t>(this->sumXX) - sx*sx;
+    const int128_t vy = n*static_cast<int128_t>(this->sumYY) - sy*sy;
+    if(n == 0 || vx == 0 || vy == 0) return std::numeric_limits<double>::quiet_NaN();
+    return static_cast<double>(n*static_cast<int128_t>(this->sumXY) - sx*sy) /
+           std::sqrt(static_cast<double>(vx) * static_cast<double>(vy));
+}
@@ -0,0 +1,99 @@
+#include"../include/randomness_accumulator.hpp"
+#include"../include/byte_histogram.hpp"
+#include<stdexcept>
+
+RandomnessAccumulator::RandomnessAccumulator(const std::vector<size_t>& lags_) : lags(lags_), lagProducts(lags_.size(), 0) {
+    for(size_t k : lags_) if(k > this->maxLag) this->maxLag = k;
+    this->head.reserve(this->maxLag);
+    this->tail.reserve(this->maxLag);
+}
+
+void RandomnessAccumulator::update(const uint8_t* data, size_t size) {
+    if(size == 0) return;
+    if(data == nullptr) {
+        throw std::invalid_argument("In member function void RandomnessAccumulator::update(const uint8_t*, size_t): null data");
+    }
+    ByteHistogram::accumulate(data, size, 1, this->histogram);
+
+    const size_t T = this->tail.size();                                         // -min(count, maxLag)
+    for(size_t l = 0; l < this->lags.size(); l++) {
+        const size_t k = this->lags[l];
+        uint64_t products = 0;
+        const size_t carried = k < size ? k : size;
+        for(size_t j = 0; j < carried; j++) {                                   // -First element still in the previous chunks
+            if(j + T >= k) products += static_cast<uint64_t>(this->tail[T + j - k]) * data[j];
+        }
+        for(size_t j = k; j < size; j++) products += static_cast<uint64_t>(data[j - k]) * data[j];
+        this->lagProducts[l] += products;
+    }
+
+    if(this->head.size() < this->maxLag) {
+        const size_t missing = this->maxLag - this->head.size();
+        this->head.insert(this->head.end(), data, data + (missing < size ? missing : size));
+    }
+    if(size >= this->maxLag) {
+        this->tail.assign(data + size - this->maxLag, data + size);
+    } else {
+        this->tail.insert(this->tail.end(), data, data + size);
+        if(this->tail.size() > this->maxLag) {
+            this->tail.erase(this->tail.begin(), this->tail.begin() + static_cast<std::ptrdiff_t>(this->tail.size() - this->maxLag));
+        }
+    }
+    this->count_ += size;
+}
+
+void RandomnessAccumulator::merge(const RandomnessAccumulator& next) {
+    if(next.lags != this->lags) {
+        throw std::invalid_argument(
+            "In member function void RandomnessAccumulator::merge(const RandomnessAccumulator&): different lags"
+        );
+    }
+    if(next.count_ == 0) return;
+    if(this->count_ == 0) {
+        *this = next;
+        return;
+    }
+    const size_t T = this->tail.size();
+    for(size_t l = 0; l < this->lags.size(); l++) {                             // -Pairs from the end of this stream into 'next'
+        const size_t k = this->lags[l];
+        uint64_t products = 0;
+        for(size_t t = T >= k ? T - k : 0; t < T; t++) {
+            const size_t partner = t + k - T;
+            if(partner < next.head.size()) products += static_cast<uint64_t>(this->tail[t]) * next.head[partner];
+        }
+        this->lagProducts[l] += products + next.lagProducts[l];
+    }
+    for(size_t v = 0; v < 256; v++) this->histogram[v] += next.histogram[v];
+
+    if(this->head.size() < this->maxLag) {
+        const size_t missing = this->maxLag - this->head.size();
+        this->head.insert(this->head.end(), next.head.begin(),
+                          next.head.begin() + static_cast<std::ptrdiff_t>(missing < next.head.size() ? missing : next.head.size()));
+    }
+    this->tail.insert(this->tail.end(), next.tail.begin(), next.tail.end());
+    if(this->tail.size() > this->maxLag) {
+        this->tail.erase(this->tail.begin(), this->tail.begin() + static_cast<std::ptrdiff_t>(this->tail.size() - this->maxLag));
+    }
+    this->count_ += next.count_;
+}
+
+ByteMoments RandomnessAccumulator::finalize() const {
+    if(this->count_ == 0) {
+        throw std::logic_error("In member function ByteMoments RandomnessAccumulator::finalize() const: no bytes added");
+    }
+    if(this->count_ <= this->maxLag) {                                          // -The whole stream is in 'head'
+        return ByteMoments::measure(this->head.data(), this->head.size(), this->lags);
+    }
+    ByteMoments m;
+    for(size_t v = 0; v < 256; v++) m.histogram[v] = this->histogram[v];
+    m.count = this->count_;
+    m.lags = this->lags;                                                        // -All below count, nothing to reduce
+    m.lagProducts = this->lagProducts;
+    for(size_t l = 0; l < this->lags.size(); l++) {                             // -Wrapping pairs: the last k with the first k
+        const size_t k = this->lags[l];
+        uint64_t products = 0;
+        for(size_t j = 0; j < k; j++) products += static_cast<uint64_t>(this->tail[this->maxLag - k + j]) * this->head[j];
+        m.lagProducts[l] += products;
+    }
+    return m;
+}
@@ -0,0 +1,356 @@
+#include"../include/sp800_22.hpp"
+#include<cmath>
+#include<cstring>
+#include<stdexcept>
+#include<string>
+#include<vector>
+
+__extension__ typedef __int128 int128_t;
+
+namespace {
+
+const uint64_t MIN_BITS = 128;
+const double MACHEP = 1.11022302462515654042e-16;
+const double MAXLOG = 7.09782712893383996843e2;
+const double BIG = 4.503599627370496e15;
+const double BIGINV = 2.22044604925031308085e-16;
+
+inline uint64_t load_big_endian(const uint8_t* p) {
+    uint64_t w;
+    std::memcpy(&w, p, 8);
+    return __builtin_bswap64(w);
+}
+
+struct WordScan {
+    uint64_t ones = 0;
+    uint64_t transitions = 0;                                                   // -Adjacent bits that differ: V_n - 1
+    int128_t blockSquares = 0;                                                  // -Sum over blocks of (2*ones - M)^2
+};
+
+// Block frequency bookkeeping: the block being filled, where it ends, and the ones seen in it so far.
+struct BlockCursor {
+    size_t blockBits;
+    size_t blocks;
+    size_t block = 0;
+    uint64_t end;
+    uint64_t ones = 0;
+
+    BlockCursor(size_t blockBits_, size_t blocks_) : blockBits(blockBits_), blocks(blocks_), end(blockBits_) {}
+
+    /*
+     * Adds the 'width' bits that start at bit 'position' of the sequence, held in the top of 'v' (the rest zero). Blocks
+     * that end inside them are closed; bits past the last whole block are dropped.
+     * */
+    __attribute__((always_inline)) inline void add(uint64_t v, unsigned width, uint64_t position, int128_t& squares) {
+        unsigned taken = 0;
+        while(this->block < this->blocks && this->end <= position + width) {
+            const unsigned length = static_cast<unsigned>(this->end - position) - taken;
+            this->ones += static_cast<uint64_t>(__builtin_popcountll(v << taken >> (64 - length)));
+            const int128_t d = 2*static_cast<int128_t>(this->ones) - static_cast<int128_t>(this->blockBits);
+            squares += d*d;
+            this->block++;
+            this->end += this->blockBits;
+            this->ones = 0;
+            taken += length;
+            if(taken == width) return;
+        }
+        if(this->block < this->blocks) this->ones += static_cast<uint64_t>(__builtin_popcountll(v << taken));
+    }
+};
+
+/*
+ * One pass over big-endian words counts the ones, the runs and the ones of every block. In a word, w ^ (w << 1) has bit
+ * 63-j set when sequence bits j and j+1 differ, for j < 63; bit 0 compares the last bit with a zero shifted in and is
+ * masked off. The pair across two words is checked separately.
+ * */
+__attribute__((always_inline)) inline WordScan scan_words_impl(const uint8_t* data, size_t size, size_t blockBits) {
+    WordScan s;
+    BlockCursor cursor(blockBits, size*8 / blockBits);
+    uint64_t previous = data[0] >> 7;                                           // -First bit: no pair before it
+    size_t i = 0;
+    for(; i + 8 <= size; i += 8) {
+        const uint64_t w = load_big_endian(data + i);
+        s.ones += static_cast<uint64_t>(__builtin_popcountll(w));
+        s.transitions += static_cast<uint64_t>(__builtin_popcountll((w ^ (w << 1)) & ~uint64_t(1))) + ((previous ^ (w >> 63)) & 1);
+        cursor.add(w, 64, static_cast<uint64_t>(i)*8, s.blockSquares);
+        previous = w & 1;
+    }
+    for(; i < size; i++) {
+        const unsigned b = data[i];
+        s.ones += static_cast<uint64_t>(__builtin_popcount(b));
+        s.transitions += static_cast<uint64_t>(__builtin_popcount((b ^ (b << 1)) & 0xFEu)) + ((previous ^ (b >> 7)) & 1);
+        cursor.add(static_cast<uint64_t>(b) << 56, 8, static_cast<uint64_t>(i)*8, s.blockSquares);
+        previous = b & 1;
+    }
+    return s;
+}
+
+WordScan scan_words_generic(const uint8_t* data, size_t size, size_t blockBits) {
+    return scan_words_impl(data, size, blockBits);
+}
+
+#if defined(__x86_64__) && defined(__GNUC__)
+__attribute__((target("popcnt")))
+WordScan scan_words_popcnt(const uint8_t* data, size_t size, size_t blockBits) {
+    return scan_words_impl(data, size, blockBits);
+}
+#endif
+
+WordScan scan_words(const uint8_t* data, size_t size, size_t blockBits) {
+#if defined(__x86_64__) && defined(__GNUC__)
+    if(__builtin_cpu_supports("popcnt")) return scan_words_popcnt(data, size, blockBits);
+#endif
+    return scan_words_generic(data, size, blockBits);
+}
+
+/*
+ * Per byte value: ones before the first zero (from the most significant bit), ones after the last zero, and the
+ * longest run anywhere in the byte.
+ * */
+struct ByteRuns {
+    uint8_t leading[256];
+    uint8_t trailing[256];
+    uint8_t longest[256];
+
+    ByteRuns() {
+        for(unsigned v = 0; v < 256; v++) {
+            unsigned lead = 0, trail = 0, run = 0, best = 0;
+            while(lead < 8 && (v >> (7 - lead) & 1)) lead++;
+            while(trail < 8 && (v >> trail & 1)) trail++;
+            for(unsigned bit = 0; bit < 8; bit++) {
+                run = (v >> bit & 1) ? run + 1 : 0;
+                if(run > best) best = run;
+            }
+            this->leading[v] = static_cast<uint8_t>(lead);
+            this->trailing[v] = static_cast<uint8_t>(trail);
+            this->longest[v] = static_cast<uint8_t>(best);
+        }
+    }
+};
+
+size_t longest_run(const uint8_t* block, size_t bytes) {
+    static const ByteRuns table;
+    size_t run = 0, best = 0;
+    for(size_t i = 0; i < bytes; i++) {
+        const uint8_t b = block[i];
+        if(b == 0xFF) {
+            run += 8;
+            continue;
+        }
+        if(run + table.leading[b] > best) best = run + table.leading[b];
+        if(table.longest[b] > best) best = table.longest[b];
+        run = table.trailing[b];
+    }
+    return run > best ? run : best;
+}
+
+/*
+ * Section 2.4.4 of SP 800-22: block length, smallest class (runs of at most that length), number of classes and their
+ * probabilities, by sequence length.
+ * */
+struct LongestRunParameters {
+    uint64_t minBits;
+    size_t blockBits;
+    size_t firstClass;
+    size_t classes;
+    double probabilities[7];
+};
+
+const LongestRunParameters LONGEST_RUN[3] = {
+    {750000, 10000, 10, 7, {0.0882, 0.2092, 0.2483, 0.1933, 0.1208, 0.0675, 0.0727}},
+    {6272,   128,   4,  6, {0.1174, 0.2430, 0.2493, 0.1752, 0.1027, 0.1124}},
+    {128,    8,     1,  4, {0.2148, 0.3672, 0.2305, 0.1875}}
+};
+
+/*
+ * Counts of the overlapping W-bit patterns of the sequence read cyclically: the window starts with the last W-1 bits,
+ * so the first patterns wrap around the end as SP 800-22 prescribes. W is at most 20, so three bytes hold the prefix.
+ * */
+std::vector<uint64_t> pattern_counts(const uint8_t* data, size_t size, size_t width) {
+    std::vector<uint64_t> counts(size_t(1) << width, 0);
+    const uint64_t mask = (uint64_t(1) << width) - 1;
+    uint64_t window = static_cast<uint64_t>(data[size - 3]) << 16 | static_cast<uint64_t>(data[size - 2]) << 8 | data[size - 1];
+    for(size_t i = 0; i < size; i++) {
+        window = window << 8 | data[i];
+        counts[window >> 7 & mask]++;
+        counts[window >> 6 & mask]++;
+        counts[window >> 5 & mask]++;
+        counts[window >> 4 & mask]++;
+        counts[window >> 3 & mask]++;
+        counts[window >> 2 & mask]++;
+        counts[window >> 1 & mask]++;
+        counts[window & mask]++;
+    }
+    return counts;
+}
+
+// Counts of the patterns one bit shorter: for a cyclic sequence, the sum over the possible last bit.
+std::vector<uint64_t> marginalize(const std::vector<uint64_t>& counts) {
+    std::vector<uint64_t> shorter(counts.size() / 2, 0);
+    for(size_t p = 0; p < counts.size(); p++) shorter[p >> 1] += counts[p];
+    return shorter;
+}
+
+// psi^2_m = (2^m / n) * sum of squared counts - n, with an exact integer numerator
+double psi_squared(const std::vector<uint64_t>& counts, uint64_t n) {
+    int128_t squares = 0;
+    for(uint64_t c : counts) squares += static_cast<int128_t>(c) * c;
+    const int128_t numerator = squares * static_cast<int128_t>(counts.size()) - static_cast<int128_t>(n) * n;
+    return static_cast<double>(numerator) / static_cast<double>(n);
+}
+
+double phi(const std::vector<uint64_t>& counts, uint64_t n) {
+    double sum = 0.0;
+    for(uint64_t c : counts) {
+        if(c == 0) continue;
+        const double p = static_cast<double>(c) / static_cast<double>(n);
+        sum += p * std::log(p);
+    }
+    return sum;
+}
+
+// Regularized lower incomplete gamma by its power series; valid for x < a + 1 (Cephes igam)
+double igam(double a, double x) {
+    if(x <= 0.0 || a <= 0.0) return 0.0;
+    if(x > 1.0 && x > a) return 1.0 - SP800_22::igamc(a, x);
+    double ax = a*std::log(x) - x - std::lgamma(a);
+    if(ax < -MAXLOG) return 0.0;
+    ax = std::exp(ax);
+    double r = a, c = 1.0, sum = 1.0;
+    do {
+        r += 1.0;
+        c *= x / r;
+        sum += c;
+    } while(c / sum > MACHEP);
+    return sum * ax / a;
+}
+
+} // namespace
+
+double SP800_22::igamc(double a, double x) {
+    if(x <= 0.0 || a <= 0.0) return 1.0;
+    if(x < 1.0 || x < a) return 1.0 - igam(a, x);
+    double ax = a*std::log(x) - x - std::lgamma(a);
+    if(ax < -MAXLOG) return 0.0;
+    ax = std::exp(ax);
+
+    // Continued fraction (Cephes igamc)
+    double y = 1.0 - a, z = x + y + 1.0, c = 0.0;
+    double pkm2 = 1.0, qkm2 = x, pkm1 = x + 1.0, qkm1 = z * x;
+    double ans = pkm1 / qkm1, t;
+    do {
+        c += 1.0;
+        y += 1.0;
+        z += 2.0;
+        const double yc = y * c;
+        const double pk = pkm1 * z - pkm2 * yc;
+        const double qk = qkm1 * z - qkm2 * yc;
+        if(qk != 0.0) {
+            const double r = pk / qk;
+            t = std::fabs((ans - r) / r);
+            ans = r;
+        } else {
+            t = 1.0;
+        }
+        pkm2 = pkm1; pkm1 = pk;
+        qkm2 = qkm1; qkm1 = qk;
+        if(std::fabs(pk) > BIG) {
+            pkm2 *= BIGINV; pkm1 *= BIGINV;
+            qkm2 *= BIGINV; qkm1 *= BIGINV;
+        }
+    } while(t > MACHEP);
+    return ans * ax;
+}
+
+bool SP800_22::Results::passed(double alpha) const {
+    for(const Outcome* o : {&this->monobit, &this->blockFrequency, &this->runs, &this->longestRun, &this->serial1,
+                            &this->serial2, &this->approximateEntropy}) {
+        if(!(o->pValue >= alpha)) return false;                                 // -NaN fails too
+    }
+    return true;
+}
+
+SP800_22::Results SP800_22::run(const uint8_t* data, size_t size, const Config& config) {
+    const uint64_t n = static_cast<uint64_t>(size) * 8;
+    if(data == nullptr || n < MIN_BITS) {
+        throw std::invalid_argument(
+            "In function SP800_22::run(...): need at least " + std::to_string(MIN_BITS) + " bits, got " + std::to_string(n)
+        );
+    }
+    if(config.blockFrequencyBits == 0 || config.blockFrequencyBits > n || config.serialBits < 3 || config.serialBits > 20 ||
+       config.approximateEntropyBits < 1 || config.approximateEntropyBits > 19) {
+        throw std::invalid_argument(
+            "In function SP800_22::run(...): invalid configuration (M = " + std::to_string(config.blockFrequencyBits) +
+            ", serial m = " + std::to_string(config.serialBits) + ", approximate entropy m = " +
+            std::to_string(config.approximateEntropyBits) + ")"
+        );
+    }
+    const double nd = static_cast<double>(n);
+    Results r;
+    r.bits = n;
+    // Section 2.11.7 and 2.12.7: m < floor(log2 n) - 2 (serial), m < floor(log2 n) - 5 (approximate entropy). With
+    // n >= 128 both limits leave at least the smallest allowed m.
+    const size_t log2n = static_cast<size_t>(63 - __builtin_clzll(n));
+    r.serialBits = config.serialBits < log2n - 2 ? config.serialBits : log2n - 3;
+    r.approximateEntropyBits = config.approximateEntropyBits < log2n - 5 ? config.approximateEntropyBits : log2n - 6;
+
+    const WordScan words = scan_words(data, size, config.blockFrequencyBits);
+
+    // Frequency (monobit)
+    const double sum = 2.0*static_cast<double>(words.ones) - nd;
+    r.monobit.statistic = std::fabs(sum) / std::sqrt(nd);
+    r.monobit.pValue = std::erfc(r.monobit.statistic / std::sqrt(2.0));
+
+    // Frequency within a block
+    const double blocks = static_cast<double>(n / config.blockFrequencyBits);
+    r.blockFrequency.statistic = static_cast<double>(words.blockSquares) / static_cast<double>(config.blockFrequencyBits);
+    r.blockFrequency.pValue = igamc(blocks / 2.0, r.blockFrequency.statistic / 2.0);
+
+    // Runs
+    const double pi = static_cast<double>(words.ones) / nd;
+    r.runs.statistic = static_cast<double>(words.transitions + 1);
+    if(std::fabs(pi - 0.5) >= 2.0 / std::sqrt(nd)) {
+        r.runs.pValue = 0.0;                                                    // -Frequency prerequisite not met
+    } else {
+        r.runs.pValue = std::erfc(std::fabs(r.runs.statistic - 2.0*nd*pi*(1.0 - pi)) / (2.0*std::sqrt(2.0*nd)*pi*(1.0 - pi)));
+    }
+
+    // Longest run of ones in a block
+    const LongestRunParameters* lr = LONGEST_RUN;
+    while(n < lr->minBits) lr++;
+    const size_t lrBlocks = n / lr->blockBits, blockBytes = lr->blockBits / 8;
+    uint64_t frequencies[7] = {0};
+    for(size_t k = 0; k < lrBlocks; k++) {
+        size_t run = longest_run(data + k*blockBytes, blockBytes);
+        if(run < lr->firstClass) run = lr->firstClass;
+        if(run > lr->firstClass + lr->classes - 1) run = lr->firstClass + lr->classes - 1;
+        frequencies[run - lr->firstClass]++;
+    }
+    double chi = 0.0;
+    for(size_t c = 0; c < lr->classes; c++) {
+        const double expected = static_cast<double>(lrBlocks) * lr->probabilities[c];
+        const double d = static_cast<double>(frequencies[c]) - expected;
+        chi += d*d / expected;
+    }
+    r.longestRun.statistic = chi;
+    r.longestRun.pValue = igamc(static_cast<double>(lr->classes - 1) / 2.0, chi / 2.0);
+
+    // Serial and approximate entropy, from one count of the widest patterns
+    const size_t m = r.serialBits, a = r.approximateEntropyBits;
+    const size_t widest = m > a + 1 ? m : a + 1;
+    std::vector<std::vector<uint64_t>> counts(widest + 1);
+    counts[widest] = pattern_counts(data, size, widest);
+    const size_t narrowest = m - 2 < a ? m - 2 : a;
+    for(size_t w = widest; w > narrowest; w--) counts[w - 1] = marginalize(counts[w]);
+
+    const double psiM = psi_squared(counts[m], n), psiM1 = psi_squared(counts[m - 1], n), psiM2 = psi_squared(counts[m - 2], n);
+    r.serial1.statistic = psiM - psiM1;
+    r.serial2.statistic = psiM - 2.0*psiM1 + psiM2;
+    r.serial1.pValue = igamc(std::ldexp(1.0, static_cast<int>(m) - 2), r.serial1.statistic / 2.0);
+    r.serial2.pValue = igamc(std::ldexp(1.0, static_cast<int>(m) - 3), r.serial2.statistic / 2.0);
+
+    const double apEn = phi(counts[a], n) - phi(counts[a + 1], n);
+    r.approximateEntropy.statistic = 2.0*nd*(std::log(2.0) - apEn);
+    r.approximateEntropy.pValue = igamc(std::ldexp(1.0, static_cast<int>(a) - 1), r.approximateEntropy.statistic / 2.0);
+    return r;
+}
@@ -10,21 +10,35 @@
  *   BMP  — lossless container; encrypt → decrypt restores the original exactly.
  *   PNG  — lossless compression (DEFLATE); round-trip is exact.
  *   JPEG — lossy codec; decrypted output will NOT match the original.
- *          The program warns the user before proceeding.
+ *          The program warns the user before proceeding. With --jpeg-dct,
+ *          baseline JPEGs are instead encrypted in the DCT coefficient
+ *          domain: the output stays a JPEG of about the same size and
+ *          decryption (also with --jpeg-dct) restores the original exactly.
+ *
+ * With --tiles WxH the pixels are encrypted as independent tiles (see
+ * RasterImage::apply_tiled_encryption); the grid is recorded in the metadata
+ * and --region X,Y,W,H decrypts only the tiles a region needs.
  *
  * Usage:
  *   Encryption:     image_encryptor --key <file> --input <img> --output <img>
- *                       [--mode ECB|CBC|OFB|CTR] [--iv <32 hex chars>]
+ *                       [--mode ECB|CBC|OFB|CTR] [--iv <32 hex chars>] [--jpeg-dct]
+ *                       [--tiles WxH]
  *   Decryption:     image_encryptor --decrypt --key <file> --input <img>
- *                       --output <img> --iv <32 hex chars>
+ *                       --output <img> --iv <32 hex chars> [--tiles WxH]
+ *                       [--region X,Y,W,H]
  *   Key generation: image_encryptor --generate-key --key-length <bits>
  *                       --output <file>
  */
 
 #include "../../core-crypto/include/cipher.hpp"
 #include "../../file-handlers/include/image_factory.hpp"
+#include "../../file-handlers/include/bitmap.hpp"
+#include "../../file-handlers/include/jpeg_image.hpp"
+#include "../../file-handlers/include/tile_grid.hpp"
 #include "../../cli-tools/include/cli_config.hpp"
 
+#include <cctype>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
@@ -61,6 +75,22 @@ static std::string bytes_to_hex(const uint8_t* data, size_t len) {
     return oss.str();
 }
 
+// "X,Y,W,H" with W and H positive.
+static bool parse_region(const std::string& text, TileGrid::Rect& region) {
+    size_t values[4];
+    size_t pos = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        const size_t end = i < 3 ? text.find(',', pos) : text.size();
+        if (end == std::string::npos || end == pos
+            || text.find_first_not_of("0123456789", pos) < end) return false;
+        try { values[i] = std::stoul(text.substr(pos, end - pos)); }
+        catch (const std::exception&) { return false; }
+        pos = end + 1;
+    }
+    region = TileGrid::Rect{values[0], values[1], values[2], values[3]};
+    return region.width > 0 && region.height > 0;
+}
+
 static bool mode_needs_iv(Cipher::OperationMode::Identifier m) {
     return m != Cipher::OperationMode::Identifier::ECB;
 }
@@ -74,7 +104,11 @@ public:
 
     bool        decrypt      = false;
     bool        generate_key = false;
-    std::string key_file, input_file, output_file, iv_hex, metadata_file;
+    bool        jpeg_dct     = false;
+    std::string key_file, input_file, output_file, iv_hex, metadata_file, tiles;
+    size_t          tile_width  = 0, tile_height = 0;   // Zero: not tiled
+    bool            has_region  = false;
+    TileGrid::Rect  region;
     Key::LengthBits                   key_length     = Key::LengthBits::_128;
     Cipher::OperationMode::Identifier operation_mode = Cipher::OperationMode::Identifier::CBC;
 };
@@ -88,8 +122,24 @@ bool ImageCryptoConfig::validate(const CLIConfig::ArgumentParser& parser) {
 
     generate_key  = parser.has("--generate-key");
     decrypt       = parser.has("--decrypt");
+    jpeg_dct      = parser.has("--jpeg-dct");
     iv_hex        = parser.getOr("--iv", "");
     metadata_file = parser.getOr("--metadata", "");
+    tiles         = parser.getOr("--tiles", "");
+
+    if (!tiles.empty() && !TileGrid::parse(tiles, tile_width, tile_height)) {
+        error_message = "Invalid tile size: " + tiles + ". Use <width>x<height>, e.g. 256x256.";
+        is_valid = false;
+        return false;
+    }
+    if (parser.has("--region")) {
+        if (!parse_region(parser.getOr("--region", ""), region)) {
+            error_message = "Invalid region: " + parser.getOr("--region", "") + ". Use X,Y,W,H.";
+            is_valid = false;
+            return false;
+        }
+        has_region = true;
+    }
 
     // Key length
     std::string kl_str = parser.getOr("--key-length", "128");
@@ -138,6 +188,15 @@ bool ImageCryptoConfig::validate(const CLIConfig::ArgumentParser& parser) {
             return false;
         }
     }
+    if (has_region) {
+        std::string ext = std::filesystem::path(output_file).extension().string();
+        for (char& c : ext) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        if (ext != ".png") {
+            error_message = "--region writes a PNG: the output must end in .png, got " + output_file;
+            is_valid = false;
+            return false;
+        }
+    }
 
     is_valid = true;
     return true;
@@ -165,27 +224,36 @@ void ImageCryptoConfig::print_help(const CLIConfig::ArgumentParser& parser) cons
         << "                             and printed to stdout\n"
         << "  --metadata <file>          JSON file to save IV+mode on encrypt,\n"
         << "                             or load IV+mode on decrypt (replaces --iv)\n"
+        << "  --jpeg-dct                 Process baseline JPEGs as DCT coefficients: the\n"
+        << "                             output stays a JPEG and decrypts exactly\n"
+        << "                             (CBC, OFB or CTR mode)\n"
+        << "  --tiles <W>x<H>            Encrypt the pixels as independent W x H tiles\n"
+        << "                             (recorded in the metadata file)\n"
+        << "  --region <X>,<Y>,<W>,<H>   With --decrypt on a tiled image: decrypt only\n"
+        << "                             this region and save it as PNG (.png output)\n"
         << "  --help                     Show this help message\n\n"
         << "Notes:\n"
         << "  BMP and PNG support lossless round-trips (encrypt then decrypt\n"
         << "  recovers the original). JPEG will be saved as PNG (lossless)\n"
-        << "  to preserve encrypted pixels.\n";
+        << "  to preserve encrypted pixels, unless --jpeg-dct is given.\n";
 }
 
 // ── Metadata helpers ──────────────────────────────────────────────────────────
 
-static void write_metadata(const std::string& path,
-                            const std::string& mode, const std::string& iv_hex) {
+static void write_metadata(const std::string& path, const std::string& mode,
+                            const std::string& iv_hex, const std::string& tiles) {
     std::ofstream f(path);
     if (!f) throw std::runtime_error("Cannot open metadata file for writing: " + path);
     f << "{\n  \"mode\": \"" << mode << "\"";
     if (!iv_hex.empty())
         f << ",\n  \"iv\": \"" << iv_hex << "\"";
+    if (!tiles.empty())
+        f << ",\n  \"tiles\": \"" << tiles << "\"";
     f << "\n}\n";
 }
 
-static void read_metadata(const std::string& path,
-                           std::string& mode, std::string& iv_hex) {
+static void read_metadata(const std::string& path, std::string& mode,
+                           std::string& iv_hex, std::string& tiles) {
     std::ifstream f(path);
     if (!f) throw std::runtime_error("Cannot open metadata file: " + path);
     std::string content((std::istreambuf_iterator<char>(f)),
@@ -200,6 +268,7 @@ static void read_metadata(const std::string& path,
     };
     mode   = extract("mode");
     iv_hex = extract("iv");
+    tiles  = extract("tiles");
 }
 
 // ── main ──────────────────────────────────────────────────────────────────────
@@ -234,13 +303,23 @@ int main(int argc, const char* argv[]) {
 
         // Load metadata before optmode creation so mode/IV override takes effect
         if (config.decrypt && !config.metadata_file.empty()) {
-            std::string mode_str, iv_from_meta;
-            read_metadata(config.metadata_file, mode_str, iv_from_meta);
+            std::string mode_str, iv_from_meta, tiles_from_meta;
+            read_metadata(config.metadata_file, mode_str, iv_from_meta, tiles_from_meta);
             if (!mode_str.empty())
                 config.operation_mode = Cipher::OperationMode::string_to_identifier(mode_str);
             if (config.iv_hex.empty())
                 config.iv_hex = iv_from_meta;
+            if (config.tiles.empty() && !tiles_from_meta.empty()) {
+                if (!TileGrid::parse(tiles_from_meta, config.tile_width, config.tile_height))
+                    throw std::invalid_argument("Invalid tile size in metadata: " + tiles_from_meta);
+                config.tiles = tiles_from_meta;
+            }
         }
+        const bool tiled = config.tile_width != 0;
+        if (config.has_region && !(config.decrypt && tiled))
+            throw std::invalid_argument("--region needs --decrypt and a tiled image (--tiles or metadata)");
+        if (tiled && config.jpeg_dct)
+            throw std::invalid_argument("--tiles and --jpeg-dct cannot be combined");
 
         Key key(config.key_file.c_str());
         Cipher::OperationMode optmode(config.operation_mode);
@@ -254,7 +333,14 @@ int main(int argc, const char* argv[]) {
                       << bytes_to_hex(iv_ptr, 16) << "\n";
         }
 
-        if (!config.decrypt && image_is_lossy(config.input_file)) {
+        // --jpeg-dct: the JPEG is processed as quantized DCT coefficients and stays a JPEG.
+        const bool jpeg_native = config.jpeg_dct && image_is_lossy(config.input_file);
+        if (jpeg_native && config.operation_mode == Cipher::OperationMode::Identifier::ECB)
+            throw std::invalid_argument("--jpeg-dct needs CBC, OFB or CTR mode");
+        if (jpeg_native && !JPEG::native_supported(config.input_file))
+            throw std::invalid_argument("--jpeg-dct needs a baseline JPEG: " + config.input_file);
+
+        if (!config.decrypt && image_is_lossy(config.input_file) && !jpeg_native) {
             config.output_file = std::filesystem::path(config.output_file)
                                      .replace_extension(".png").string();
             std::cout << "Note: JPEG input will be saved as PNG to preserve encrypted pixels.\n"
@@ -263,19 +349,42 @@ int main(int argc, const char* argv[]) {
 
         std::unique_ptr<FileBase> image = make_image(config.input_file);
         Cipher cipher(key, optmode);
-        image->load();
 
-        if (config.decrypt) {
-            image->apply_decryption(cipher);
-            std::cout << "Decrypted: " << config.input_file
-                      << " -> "        << config.output_file << "\n";
+        // Uncompressed BMPs are encrypted in the file layout: no decode, no re-encode, header kept verbatim.
+        Bitmap::PixelLayout layout;
+        const Bitmap* bmp = dynamic_cast<const Bitmap*>(image.get());
+        const JPEG* jpeg = dynamic_cast<const JPEG*>(image.get());
+        RasterImage* raster = dynamic_cast<RasterImage*>(image.get());
+        if (tiled && raster == nullptr)
+            throw std::invalid_argument("--tiles needs a raster image: " + config.input_file);
+        if (tiled) {
+            // Tiles are laid out on the decoded pixels, so the native BMP path is skipped.
+            raster->load();
+            if (config.has_region) {
+                const TileGrid::Rect& r = config.region;
+                std::vector<uint8_t> pixels = raster->decrypt_region(
+                    cipher, config.tile_width, config.tile_height, r.x, r.y, r.width, r.height);
+                PngWriter::write(config.output_file, pixels.data(), static_cast<int>(r.width),
+                                 static_cast<int>(r.height), raster->channels());
+            } else {
+                if (config.decrypt) raster->apply_tiled_decryption(cipher, config.tile_width, config.tile_height);
+                else                raster->apply_tiled_encryption(cipher, config.tile_width, config.tile_height);
+                raster->save(config.output_file);
+            }
+        } else if (bmp != nullptr && Bitmap::native_layout(config.input_file, layout)) {
+            if (config.decrypt) bmp->decrypt_native_to(cipher, config.output_file);
+            else                bmp->encrypt_native_to(cipher, config.output_file);
+        } else if (jpeg != nullptr && jpeg_native) {
+            if (config.decrypt) jpeg->decrypt_native_to(cipher, config.output_file);
+            else                jpeg->encrypt_native_to(cipher, config.output_file);
         } else {
-            image->apply_encryption(cipher);
-            std::cout << "Encrypted: " << config.input_file
-                      << " -> "        << config.output_file << "\n";
+            image->load();
+            if (config.decrypt) image->apply_decryption(cipher);
+            else                image->apply_encryption(cipher);
+            image->save(config.output_file);
         }
-
-        image->save(config.output_file);
+        std::cout << (config.decrypt ? "Decrypted: " : "Encrypted: ") << config.input_file
+                  << " -> " << config.output_file << "\n";
 
         if (!config.decrypt && !config.metadata_file.empty()) {
             std::string iv_hex_out;
@@ -283,7 +392,7 @@ int main(int argc, const char* argv[]) {
                 iv_hex_out = bytes_to_hex(optmode.getIVpointerData(), 16);
             write_metadata(config.metadata_file,
                            Cipher::OperationMode::identifier_to_string(config.operation_mode),
-                           iv_hex_out);
+                           iv_hex_out, config.tiles);
         }
 
     } catch (const std::invalid_argument& e) {
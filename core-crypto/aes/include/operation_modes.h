@@ -21,6 +21,7 @@ extern "C" {
 #include "exception_code.h"
 #include <stdint.h>
 #include <stddef.h>
+#include <sys/uio.h>
 
 /**
 * @brief Encrypts data using AES-ECB (Electronic Codebook) operation mode
@@ -311,6 +312,75 @@ enum ExceptionCode encryptCTR(const uint8_t*const input, size_t size, const uint
 */
 enum ExceptionCode decryptCTR(const uint8_t*const input, size_t size, const uint8_t* keyexpansion, size_t keylenbits, const uint8_t* counter00, uint8_t*const output);
 
+/*
+ * Scatter-gather variants
+ *
+ * The functions below take the message as arrays of struct iovec instead of one contiguous buffer. The message is the
+ * concatenation of the input segments, in order, and the result is written over the concatenation of the output
+ * segments; both may be split anywhere, independently of each other and of block boundaries. The result is the same
+ * as the contiguous function on the concatenated message. Blocks that lie inside one segment are processed where
+ * they are; only a block straddling a segment boundary is gathered into (or scattered from) a 16-byte local block.
+ * Chaining values and counters carry across segments. Input and output may be the same segments (in-place).
+ */
+
+/**
+* @brief Scatter-gather AES-ECB encryption
+*
+* @param[in] input Array of 'inputCount' segments holding the message
+* @param[in] inputCount Number of input segments
+* @param[in] keyexpansion Pointer to the expanded AES key schedule
+* @param[in] keylenbits AES key length in bits (128, 192, or 256)
+* @param[in] output Array of 'outputCount' segments receiving the result
+* @param[in] outputCount Number of output segments
+*
+* @return ExceptionCode indicating success or failure
+* @retval NoException Operation completed successfully
+* @retval NullInput 'input' is NULL, or a non-empty input segment has a NULL base
+* @retval NullOutput 'output' is NULL, or a non-empty output segment has a NULL base
+* @retval NullKeyExpansion The keyexpansion pointer is NULL
+* @retval ZeroLength The input segments hold no bytes
+* @retval InvalidInputSize The total input size is not a multiple of 16 bytes or differs from the total output size
+* @retval InvalidKeyLength The keylenbits is not 128, 192, or 256
+*
+* @see encryptECB()
+*/
+enum ExceptionCode encryptECBv(const struct iovec* input, size_t inputCount, const uint8_t* keyexpansion, size_t keylenbits, const struct iovec* output, size_t outputCount);
+
+/**
+* @brief Scatter-gather AES-ECB decryption. Same contract as encryptECBv().
+* @see decryptECB()
+*/
+enum ExceptionCode decryptECBv(const struct iovec* input, size_t inputCount, const uint8_t* keyexpansion, size_t keylenbits, const struct iovec* output, size_t outputCount);
+
+/**
+* @brief Scatter-gather AES-CBC encryption. Same contract as encryptECBv(), plus the 16-byte 'IV'.
+* @retval NullInitialVector The IV pointer is NULL
+* @see encryptCBC()
+*/
+enum ExceptionCode encryptCBCv(const struct iovec* input, size_t inputCount, const uint8_t* keyexpansion, size_t keylenbits, const uint8_t* IV, const struct iovec* output, size_t outputCount);
+
+/**
+* @brief Scatter-gather AES-CBC decryption. Same contract as encryptCBCv().
+*
+* @note Unlike decryptCBC(), which walks the message backwards, the segments are processed front to back; the previous
+*       cipher block is kept aside so in-place decryption stays correct.
+* @see decryptCBC()
+*/
+enum ExceptionCode decryptCBCv(const struct iovec* input, size_t inputCount, const uint8_t* keyexpansion, size_t keylenbits, const uint8_t* IV, const struct iovec* output, size_t outputCount);
+
+/**
+* @brief Scatter-gather AES-CTR encryption. Same contract as encryptECBv(), plus the 16-byte initial counter block.
+* @retval NullInitialVector The counter00 pointer is NULL
+* @see encryptCTR()
+*/
+enum ExceptionCode encryptCTRv(const struct iovec* input, size_t inputCount, const uint8_t* keyexpansion, size_t keylenbits, const uint8_t* counter00, const struct iovec* output, size_t outputCount);
+
+/**
+* @brief Scatter-gather AES-CTR decryption; identical to encryptCTRv().
+* @see decryptCTR()
+*/
+enum ExceptionCode decryptCTRv(const struct iovec* input, size_t inputCount, const uint8_t* keyexpansion, size_t keylenbits, const uint8_t* counter00, const struct iovec* output, size_t outputCount);
+
 #ifdef __cplusplus
 }
 #endif
@@ -499,3 +499,247 @@ enum ExceptionCode decryptCTR(const uint8_t*const input, size_t size, const uint
   KeyExpansionDestroy(&ke_p);
   return NoException;
 }
+
+/**
+ * @struct VectoredStream
+ * @brief Position inside a message split over an array of struct iovec segments.
+ *
+ * Counterpart of InputStream/OutputStream for the scatter-gather entry points. A block that lies inside the current
+ * segment is accessed where it is; a block that straddles segments goes through a 16-byte boundary block.
+ */
+struct VectoredStream {
+  const struct iovec* segments;     ///< Segment array
+  size_t count;                     ///< Number of segments
+  size_t index;                     ///< Current segment
+  size_t offset;                    ///< Position inside the current segment
+};
+
+static struct VectoredStream VectoredStreamInitialize(const struct iovec* segments, size_t count){
+  struct VectoredStream vs = { segments, count, 0, 0 };
+  return vs;
+}
+
+/**
+ * @brief Total size of the segments; 'nullBase' is set if a non-empty segment has a NULL base.
+ */
+static size_t VectoredStreamTotalSize(const struct iovec* segments, size_t count, bool* nullBase){
+  size_t total = 0;
+  for(size_t i = 0; i < count; i++){
+    if(segments[i].iov_len > 0 && segments[i].iov_base == NULL) *nullBase = true;
+    total += segments[i].iov_len;
+  }
+  return total;
+}
+
+/**
+ * @brief Pointer to the next BLOCK_SIZE bytes if they are contiguous in the current segment, NULL otherwise.
+ */
+static uint8_t* VectoredStreamContiguousBlock(struct VectoredStream* vs){
+  while(vs->index < vs->count && vs->offset == vs->segments[vs->index].iov_len){    // -Skipping exhausted and empty segments
+    vs->index++;
+    vs->offset = 0;
+  }
+  if(vs->index < vs->count && vs->segments[vs->index].iov_len - vs->offset >= BLOCK_SIZE)
+    return (uint8_t*)vs->segments[vs->index].iov_base + vs->offset;
+  return NULL;
+}
+
+/**
+ * @brief Copies BLOCK_SIZE bytes between the stream and 'block', crossing segment boundaries. 'gather' reads from the
+ * stream, otherwise the stream is written.
+ */
+static void VectoredStreamTransferBoundaryBlock(struct VectoredStream* vs, uint8_t block[BLOCK_SIZE], bool gather){
+  size_t done = 0;
+  while(done < BLOCK_SIZE){
+    const size_t available = vs->segments[vs->index].iov_len - vs->offset;
+    const size_t n = available < BLOCK_SIZE - done ? available : BLOCK_SIZE - done;
+    uint8_t* p = (uint8_t*)vs->segments[vs->index].iov_base + vs->offset;
+    if(gather) memcpy(block + done, p, n);
+    else       memcpy(p, block + done, n);
+    done += n;
+    vs->offset += n;
+    if(vs->offset == vs->segments[vs->index].iov_len){
+      vs->index++;
+      vs->offset = 0;
+    }
+  }
+}
+
+/**
+ * @brief Returns the next input block: in place when contiguous, else gathered into 'boundary'. Moves one block forward.
+ */
+static const uint8_t* VectoredStreamReadBlockMoveForward(struct VectoredStream* vs, uint8_t boundary[BLOCK_SIZE]){
+  const uint8_t* p = VectoredStreamContiguousBlock(vs);
+  if(p != NULL){
+    vs->offset += BLOCK_SIZE;
+    return p;
+  }
+  VectoredStreamTransferBoundaryBlock(vs, boundary, true);
+  return boundary;
+}
+
+/**
+ * @brief Where the next output block should be written: in place when contiguous, else 'boundary'. Does not move;
+ * VectoredStreamCommitBlockMoveForward() does once the block is written.
+ */
+static uint8_t* VectoredStreamWriteTarget(struct VectoredStream* vs, uint8_t boundary[BLOCK_SIZE]){
+  uint8_t* p = VectoredStreamContiguousBlock(vs);
+  return p != NULL ? p : boundary;
+}
+
+static void VectoredStreamCommitBlockMoveForward(struct VectoredStream* vs, uint8_t* target, uint8_t boundary[BLOCK_SIZE]){
+  if(target == boundary) VectoredStreamTransferBoundaryBlock(vs, boundary, false);
+  else vs->offset += BLOCK_SIZE;
+}
+
+#define VALIDATE_VECTORED_INPUT_OUTPUT_SOURCES(input,inputCount,keyexpansion,output,outputCount,sizeInBlocks) \
+  if(input == NULL) return NullInput; \
+  if(output == NULL) return NullOutput; \
+  if(keyexpansion == NULL) return NullSource; \
+  bool inputNullBase = false, outputNullBase = false; \
+  const size_t inputSize = VectoredStreamTotalSize(input, inputCount, &inputNullBase); \
+  const size_t outputSize = VectoredStreamTotalSize(output, outputCount, &outputNullBase); \
+  if(inputNullBase) return NullInput; \
+  if(outputNullBase) return NullOutput; \
+  if(inputSize == 0) return ZeroLength; \
+  if(inputSize % BLOCK_SIZE != 0 || inputSize != outputSize) return InvalidInputSize; \
+  const size_t sizeInBlocks = inputSize / BLOCK_SIZE;
+
+#define BUILD_VECTORED_STREAMS(is,os) \
+  struct VectoredStream is = VectoredStreamInitialize(input, inputCount); \
+  struct VectoredStream os = VectoredStreamInitialize(output, outputCount);
+
+/**
+ * @brief ECB over vectored streams, 'decrypt' selecting the direction.
+ * @warning Supposes the input parameters are already validated.
+ */
+static void ECBv__(const KeyExpansion_t* ke_p, struct VectoredStream* is, struct VectoredStream* os, size_t sizeInBlocks, bool decrypt){
+  Block_t* buffer = BlockCreateZero();
+  uint8_t inBoundary[BLOCK_SIZE], outBoundary[BLOCK_SIZE];
+  for(size_t i = 0; i < sizeInBlocks; i++){
+    BlockFromBytes(buffer, VectoredStreamReadBlockMoveForward(is, inBoundary));
+    if(decrypt) decryptBlock(buffer, ke_p, buffer, false);
+    else        encryptBlock(buffer, ke_p, buffer, false);
+    uint8_t* target = VectoredStreamWriteTarget(os, outBoundary);
+    BytesFromBlock(buffer, target);
+    VectoredStreamCommitBlockMoveForward(os, target, outBoundary);
+  }
+  BlockDestroy(&buffer);
+}
+
+enum ExceptionCode encryptECBv(const struct iovec* input, size_t inputCount, const uint8_t* keyexpansion, size_t keylenbits, const struct iovec* output, size_t outputCount){
+  VALIDATE_VECTORED_INPUT_OUTPUT_SOURCES(input,inputCount,keyexpansion,output,outputCount,sizeInBlocks)
+  BUILD_KEYEXPANSION_FROMBYTES(ke_p,keyexpansion,keylenbits)
+  BUILD_VECTORED_STREAMS(is,os)
+  ECBv__(ke_p, &is, &os, sizeInBlocks, false);
+  KeyExpansionDestroy(&ke_p);
+  return NoException;
+}
+
+enum ExceptionCode decryptECBv(const struct iovec* input, size_t inputCount, const uint8_t* keyexpansion, size_t keylenbits, const struct iovec* output, size_t outputCount){
+  VALIDATE_VECTORED_INPUT_OUTPUT_SOURCES(input,inputCount,keyexpansion,output,outputCount,sizeInBlocks)
+  BUILD_KEYEXPANSION_FROMBYTES(ke_p,keyexpansion,keylenbits)
+  BUILD_VECTORED_STREAMS(is,os)
+  ECBv__(ke_p, &is, &os, sizeInBlocks, true);
+  KeyExpansionDestroy(&ke_p);
+  return NoException;
+}
+
+/**
+ * @brief CBC encryption over vectored streams. The previous cipher block is kept in 'previous', since it may have been
+ * written to a boundary block or over the input.
+ * @warning Supposes the input parameters are already validated.
+ */
+static void encryptCBCv__(const KeyExpansion_t* ke_p, const uint8_t*const IV, struct VectoredStream* is, struct VectoredStream* os, size_t sizeInBlocks){
+  Block_t* buffer = BlockCreateZero();
+  uint8_t inBoundary[BLOCK_SIZE], outBoundary[BLOCK_SIZE], previous[BLOCK_SIZE];
+  memcpy(previous, IV, BLOCK_SIZE);
+  for(size_t i = 0; i < sizeInBlocks; i++){
+    BlockFromBytes(buffer, VectoredStreamReadBlockMoveForward(is, inBoundary));
+    BlockXORBytes(buffer, previous);
+    encryptBlock(buffer, ke_p, buffer, false);
+    BytesFromBlock(buffer, previous);
+    uint8_t* target = VectoredStreamWriteTarget(os, outBoundary);
+    memcpy(target, previous, BLOCK_SIZE);
+    VectoredStreamCommitBlockMoveForward(os, target, outBoundary);
+  }
+  BlockDestroy(&buffer);
+}
+
+enum ExceptionCode encryptCBCv(const struct iovec* input, size_t inputCount, const uint8_t* keyexpansion, size_t keylenbits, const uint8_t* IV, const struct iovec* output, size_t outputCount){
+  VALIDATE_VECTORED_INPUT_OUTPUT_SOURCES(input,inputCount,keyexpansion,output,outputCount,sizeInBlocks)
+  if(IV == NULL) return NullInitialVector;
+  BUILD_KEYEXPANSION_FROMBYTES(ke_p,keyexpansion,keylenbits)
+  BUILD_VECTORED_STREAMS(is,os)
+  encryptCBCv__(ke_p, IV, &is, &os, sizeInBlocks);
+  KeyExpansionDestroy(&ke_p);
+  return NoException;
+}
+
+/**
+ * @brief CBC decryption over vectored streams, front to back. Each cipher block is saved before its plain text is
+ * written, since in-place the write overwrites it.
+ * @warning Supposes the input parameters are already validated.
+ */
+static void decryptCBCv__(const KeyExpansion_t* ke_p, const uint8_t*const IV, struct VectoredStream* is, struct VectoredStream* os, size_t sizeInBlocks){
+  Block_t* buffer = BlockCreateZero();
+  uint8_t inBoundary[BLOCK_SIZE], outBoundary[BLOCK_SIZE], previous[BLOCK_SIZE], current[BLOCK_SIZE];
+  memcpy(previous, IV, BLOCK_SIZE);
+  for(size_t i = 0; i < sizeInBlocks; i++){
+    const uint8_t* cipherBlock = VectoredStreamReadBlockMoveForward(is, inBoundary);
+    memcpy(current, cipherBlock, BLOCK_SIZE);
+    BlockFromBytes(buffer, current);
+    decryptBlock(buffer, ke_p, buffer, false);
+    BlockXORBytes(buffer, previous);
+    uint8_t* target = VectoredStreamWriteTarget(os, outBoundary);
+    BytesFromBlock(buffer, target);
+    VectoredStreamCommitBlockMoveForward(os, target, outBoundary);
+    memcpy(previous, current, BLOCK_SIZE);
+  }
+  BlockDestroy(&buffer);
+}
+
+enum ExceptionCode decryptCBCv(const struct iovec* input, size_t inputCount, const uint8_t* keyexpansion, size_t keylenbits, const uint8_t* IV, const struct iovec* output, size_t outputCount){
+  VALIDATE_VECTORED_INPUT_OUTPUT_SOURCES(input,inputCount,keyexpansion,output,outputCount,sizeInBlocks)
+  if(IV == NULL) return NullInitialVector;
+  BUILD_KEYEXPANSION_FROMBYTES(ke_p,keyexpansion,keylenbits)
+  BUILD_VECTORED_STREAMS(is,os)
+  decryptCBCv__(ke_p, IV, &is, &os, sizeInBlocks);
+  KeyExpansionDestroy(&ke_p);
+  return NoException;
+}
+
+/**
+ * @brief CTR over vectored streams; the counter is increased as in encryptCTR__().
+ * @warning Supposes the input parameters are already validated.
+ */
+static void encryptCTRv__(const KeyExpansion_t* ke_p, const uint8_t* counter00, struct VectoredStream* is, struct VectoredStream* os, size_t sizeInBlocks){
+  Block_t* buffer = BlockCreateZero();
+  uint8_t inBoundary[BLOCK_SIZE], outBoundary[BLOCK_SIZE];
+  struct Counter counter;
+  CounterWriteFromBytes(&counter, counter00);
+  for(size_t i = 0; i < sizeInBlocks; i++){
+    BlockFromBytes(buffer, counter.uint08_);
+    encryptBlock(buffer, ke_p, buffer, false);
+    const uint8_t* in = VectoredStreamReadBlockMoveForward(is, inBoundary);
+    uint8_t* target = VectoredStreamWriteTarget(os, outBoundary);
+    BytesXORBlockTo(in, buffer, target);
+    VectoredStreamCommitBlockMoveForward(os, target, outBoundary);
+    CounterIncrease(&counter);
+  }
+  BlockDestroy(&buffer);
+}
+
+enum ExceptionCode encryptCTRv(const struct iovec* input, size_t inputCount, const uint8_t* keyexpansion, size_t keylenbits, const uint8_t* counter00, const struct iovec* output, size_t outputCount){
+  VALIDATE_VECTORED_INPUT_OUTPUT_SOURCES(input,inputCount,keyexpansion,output,outputCount,sizeInBlocks)
+  if(counter00 == NULL) return NullInitialVector;
+  BUILD_KEYEXPANSION_FROMBYTES(ke_p,keyexpansion,keylenbits)
+  BUILD_VECTORED_STREAMS(is,os)
+  encryptCTRv__(ke_p, counter00, &is, &os, sizeInBlocks);
+  KeyExpansionDestroy(&ke_p);
+  return NoException;
+}
+
+enum ExceptionCode decryptCTRv(const struct iovec* input, size_t inputCount, const uint8_t* keyexpansion, size_t keylenbits, const uint8_t* counter00, const struct iovec* output, size_t outputCount){
+  return encryptCTRv(input, inputCount, keyexpansion, keylenbits, counter00, output, outputCount);
+}
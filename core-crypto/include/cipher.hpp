@@ -3,6 +3,8 @@
 
 #include"key.hpp"
 #include"encryptor.hpp"
+#include"thread_pool.hpp"
+#include<future>
 
 namespace CipherFortis {
 
@@ -64,6 +66,14 @@ public:
 		bool setInitialVector(const std::vector<uint8_t>& source);
 		void saveOperationMode(const std::string& filepath) const;
 	};
+	/**
+	 * @brief One input/output pair of a batch submission. Each item is processed as an independent message.
+	 */
+	struct BatchItem {
+		const uint8_t* input;
+		size_t size;
+		uint8_t* output;
+	};
 private:
 	Key key = Key();
 	uint8_t* keyExpansion = nullptr;
@@ -99,6 +109,19 @@ public:
 	 * */
 	void decryption(const std::vector<uint8_t>& input, std::vector<uint8_t>& output) const override;
 
+	/**
+	 * @brief Encryptor interface over raw buffers; forwards to encrypt() without intermediate copies.
+	 */
+	void encryptBytes(const uint8_t* input, size_t size, uint8_t* output) const override;
+	void decryptBytes(const uint8_t* input, size_t size, uint8_t* output) const override;
+
+	/**
+	 * @brief Encrypts in segments of OBSERVED_SEGMENT_SIZE bytes (sized to stay in L2) and reports each one to
+	 * 'observer' right after writing it. The output is byte-identical to encrypt().
+	 */
+	void encryptBytesObserved(const uint8_t* input, size_t size, uint8_t* output, const OutputObserver& observer) const override;
+	static constexpr size_t OBSERVED_SEGMENT_SIZE = 64*1024;
+
 		/*
 	 * Encrypts using operation mode stored in Cipher object
 	 * Consider: Comunicates with AES.h
@@ -115,6 +138,78 @@ public:
 	 * */
 	void decrypt(const uint8_t*const data, size_t size, uint8_t*const output)const;
 
+	/**
+	 * @brief Encrypts on 'pool' and returns immediately. ECB and CTR jobs bigger than the minimum chunk size of the pool
+	 * are split into chunks encrypted in parallel; CBC, OFB and small jobs run as a single task.
+	 * The result is byte-identical to encrypt(). Input and output must stay valid until the future is ready; the Cipher
+	 * object itself may be destroyed earlier.
+	 * @throws std::invalid_argument (synchronously) for null buffers or sizes smaller than one block. Errors raised while
+	 * encrypting are stored in the returned future.
+	 */
+	std::future<void> encryptAsync(const uint8_t*const data, size_t size, uint8_t*const output, ThreadPool& pool = ThreadPool::shared()) const;
+
+	/**
+	 * @brief Asynchronous counterpart of decrypt(). ECB, CBC and CTR jobs are split into parallel chunks.
+	 * @throws Same contract as encryptAsync()
+	 */
+	std::future<void> decryptAsync(const uint8_t*const data, size_t size, uint8_t*const output, ThreadPool& pool = ThreadPool::shared()) const;
+
+	/**
+	 * @brief Submits several independent messages at once. The future is ready when every item is done and holds the
+	 * first error raised, if any; it is ready at once for an empty batch.
+	 * Item i does NOT start from the configured initial vector but from tileChainingBlock(i), so that items never
+	 * share a CTR/OFB keystream: a single item gives the bytes of encryptFrom() with that chaining block, not those of
+	 * encrypt(). Decrypt a batch with decryptBatchAsync() over the items in the same order.
+	 * @throws Same contract as encryptAsync(); tileChainingBlock() errors (more than 2^32 CTR items) synchronously.
+	 */
+	std::future<void> encryptBatchAsync(const std::vector<BatchItem>& items, ThreadPool& pool = ThreadPool::shared()) const;
+	std::future<void> decryptBatchAsync(const std::vector<BatchItem>& items, ThreadPool& pool = ThreadPool::shared()) const;
+
+	static constexpr size_t CHAINING_BLOCK_SIZE = 16;
+
+	/**
+	 * @brief Writes the chaining value a segmented message starts from: the initial vector (or counter) of the
+	 * configuration, zeros in ECB mode.
+	 */
+	void initChainingBlock(uint8_t chainingBlock[CHAINING_BLOCK_SIZE]) const;
+
+	/**
+	 * @brief Encrypts one segment of a message processed in consecutive pieces. 'chainingBlock' holds the chaining value
+	 * the segment starts from and is updated so the next call continues the same message; encrypting a message in
+	 * segments gives the same bytes as one call to encrypt(). Input and output may be the same buffer.
+	 * @throws std::invalid_argument if size is zero or not a multiple of the block size, plus the errors of encrypt()
+	 */
+	void encryptSegment(const uint8_t*const data, size_t size, uint8_t*const output, uint8_t chainingBlock[CHAINING_BLOCK_SIZE]) const;
+
+	/**
+	 * @brief Segmented counterpart of decrypt(). Same contract as encryptSegment().
+	 */
+	void decryptSegment(const uint8_t*const data, size_t size, uint8_t*const output, uint8_t chainingBlock[CHAINING_BLOCK_SIZE]) const;
+
+	/**
+	 * @brief Adds 'blocks' to a CTR counter read as a 128-bit big-endian integer: the counter 'blocks' blocks further
+	 * into the message.
+	 */
+	static void advanceCounter(uint8_t counter[CHAINING_BLOCK_SIZE], uint64_t blocks);
+
+	/**
+	 * @brief Chaining value tile 'index' of a tiled layout starts from, so that tiles are encrypted and decrypted
+	 * independently without sharing keystream: CTR tiles start 2^32 blocks apart (the configured counter advanced by
+	 * index * 2^32), CBC and OFB tiles start from AES_K(IV xor index). Zeros in ECB mode.
+	 */
+	void tileChainingBlock(uint64_t index, uint8_t chainingBlock[CHAINING_BLOCK_SIZE]) const;
+
+	/**
+	 * @brief Encrypts a whole message starting from 'chainingBlock' instead of the configured initial vector, which
+	 * is left untouched. Same contract as encrypt().
+	 */
+	void encryptFrom(const uint8_t*const data, size_t size, uint8_t*const output, const uint8_t chainingBlock[CHAINING_BLOCK_SIZE]) const;
+
+	/**
+	 * @brief Decryption counterpart of encryptFrom().
+	 */
+	void decryptFrom(const uint8_t*const data, size_t size, uint8_t*const output, const uint8_t chainingBlock[CHAINING_BLOCK_SIZE]) const;
+
 
 	void saveKey(const std::string& filepath) const;
 	void saveOperationMode(const std::string& filepath) const;
@@ -134,6 +229,16 @@ public:
 	 * Consider: Trows KeyExpansionException
 	 * */
 	void buildKeyExpansion();
+
+	/*
+	 * Encryption/decryption with an explicit IV (or counter) instead of the one stored in the configuration.
+	 * Consider: No validation of data, size and output; callers are expected to do it.
+	 * */
+	void encryptWithIV(const uint8_t*const data, size_t size, uint8_t*const output, const uint8_t* iv) const;
+	void decryptWithIV(const uint8_t*const data, size_t size, uint8_t*const output, const uint8_t* iv) const;
+
+	std::future<void> submitAsync(const std::vector<BatchItem>& items, bool decrypt, bool batch, ThreadPool& pool) const;
+	void processSegment(const uint8_t*const data, size_t size, uint8_t*const output, uint8_t chainingBlock[CHAINING_BLOCK_SIZE], bool decrypt) const;
 	//void formInitialVector();						// -Creates initial vector and writes it on destination array
 };
 };
@@ -0,0 +1,112 @@
+#ifndef CIPHER_STREAM_HPP
+#define CIPHER_STREAM_HPP
+
+#include"cipher.hpp"
+#include<istream>
+#include<memory>
+#include<ostream>
+#include<streambuf>
+
+namespace CipherFortis {
+
+/**
+ * @class CipherStreamBuf
+ * @brief Stream buffer that encrypts or decrypts the bytes flowing through a wrapped std::istream or std::ostream.
+ *
+ * Data passes through one fixed-size internal buffer that is transformed in place, so memory use does not depend on
+ * the size of the message. The chaining value (CBC block, OFB feedback, CTR counter) is carried between refills with
+ * Cipher::encryptSegment()/decryptSegment(), which makes the output byte-identical to a single Cipher::encrypt() or
+ * Cipher::decrypt() call over the whole message.
+ *
+ * As with the rest of the library no padding is applied: the total length must be a multiple of 16 bytes. A trailing
+ * partial block is reported as an error, on the read side by an exception that the istream turns into badbit, on the
+ * write side by close().
+ */
+class CipherStreamBuf : public std::streambuf {
+public:
+	enum struct Operation { Encrypt, Decrypt };
+	static constexpr size_t DEFAULT_BUFFER_SIZE = 64*1024;			// -Fits comfortably in L2
+
+	/**
+	 * @brief Read side: bytes read from this buffer are the transformed bytes of 'source'.
+	 * @param bufferSize Rounded down to a multiple of 16; must hold at least one block.
+	 * @throws std::invalid_argument if bufferSize is smaller than one block
+	 */
+	CipherStreamBuf(std::istream& source, const Cipher& cipher, Operation op, size_t bufferSize = DEFAULT_BUFFER_SIZE);
+
+	/**
+	 * @brief Write side: bytes written to this buffer are transformed and forwarded to 'sink'.
+	 * @throws std::invalid_argument if bufferSize is smaller than one block
+	 */
+	CipherStreamBuf(std::ostream& sink, const Cipher& cipher, Operation op, size_t bufferSize = DEFAULT_BUFFER_SIZE);
+
+	/**
+	 * @brief Calls close() on the write side, swallowing its errors.
+	 */
+	~CipherStreamBuf() override;
+
+	CipherStreamBuf(const CipherStreamBuf&) = delete;
+	CipherStreamBuf& operator = (const CipherStreamBuf&) = delete;
+
+	/**
+	 * @brief Write side: transforms and forwards every buffered byte, then flushes the sink. Further writes fail.
+	 * Does nothing on the read side or when already closed.
+	 * @throws std::runtime_error if the data written is not a whole number of blocks or the sink fails
+	 */
+	void close();
+
+	size_t getBufferSize() const;
+
+protected:
+	int_type underflow() override;
+	int_type overflow(int_type ch) override;
+	int sync() override;
+
+private:
+	std::istream* source_ = nullptr;
+	std::ostream* sink_ = nullptr;
+	Cipher cipher_;
+	Operation operation_;
+	size_t bufferSize_;
+	std::unique_ptr<uint8_t[]> buffer_;
+	uint8_t chainingBlock_[Cipher::CHAINING_BLOCK_SIZE];
+	bool closed_ = false;
+
+	void transform(uint8_t* data, size_t size);
+	/*
+	 * Transforms and writes the whole blocks of the put area; a trailing partial block is moved to the front.
+	 * */
+	bool flushBlocks();
+	char* bufferBegin();
+};
+
+/**
+ * @brief Input stream reading the encryption (or decryption) of another input stream.
+ */
+class icipherstream : public std::istream {
+public:
+	icipherstream(std::istream& source, const Cipher& cipher, CipherStreamBuf::Operation op,
+	              size_t bufferSize = CipherStreamBuf::DEFAULT_BUFFER_SIZE);
+	CipherStreamBuf* rdbuf();
+private:
+	CipherStreamBuf buf_;
+};
+
+/**
+ * @brief Output stream encrypting (or decrypting) whatever is written to it into another output stream.
+ * Call close() to learn whether the final block was complete; the destructor closes silently.
+ */
+class ocipherstream : public std::ostream {
+public:
+	ocipherstream(std::ostream& sink, const Cipher& cipher, CipherStreamBuf::Operation op,
+	              size_t bufferSize = CipherStreamBuf::DEFAULT_BUFFER_SIZE);
+	CipherStreamBuf* rdbuf();
+	/**
+	 * @brief Flushes the remaining data. Sets failbit and rethrows if the message length is not a multiple of 16.
+	 */
+	void close();
+private:
+	CipherStreamBuf buf_;
+};
+};
+#endif
@@ -0,0 +1,81 @@
+#ifndef CTR_DRBG_HPP
+#define CTR_DRBG_HPP
+
+#include<cstddef>
+#include<cstdint>
+#include<vector>
+
+namespace CipherFortis {
+
+/**
+ * @class CtrDrbg
+ * @brief CTR_DRBG of NIST SP800-90A with AES-256 and no derivation function.
+ *
+ * Seeded from the operating system (getrandom(), then RDSEED, then /dev/urandom) and reseeded automatically after
+ * RESEED_INTERVAL requests or when the process forks. Key and OperationMode draw keys and IVs from the per-thread
+ * instance returned by threadLocal(), so concurrent generation needs no locking.
+ */
+class CtrDrbg {
+public:
+	static constexpr size_t KEY_LENGTH = 32;
+	static constexpr size_t SEED_LENGTH = 48;					// -seedlen = keylen + blocklen
+	static constexpr size_t MAX_REQUEST_BYTES = 1 << 16;				// -Bytes per generate call; fill() loops over larger requests
+	static constexpr uint64_t RESEED_INTERVAL = uint64_t(1) << 32;
+
+	/**
+	 * @brief Instantiates from system entropy.
+	 * @throws std::runtime_error if no entropy source is available
+	 */
+	CtrDrbg();
+
+	/**
+	 * @brief Deterministic instantiation from caller-provided seed material (entropy input XOR personalization).
+	 * Such an instance never reseeds on its own; meant for known-answer tests.
+	 */
+	explicit CtrDrbg(const uint8_t seedMaterial[SEED_LENGTH]);
+
+	/**
+	 * @brief Wipes the internal state.
+	 */
+	~CtrDrbg();
+
+	CtrDrbg(const CtrDrbg&) = delete;
+	CtrDrbg& operator = (const CtrDrbg&) = delete;
+
+	/**
+	 * @brief Writes 'size' pseudo-random bytes at 'output'.
+	 */
+	void fill(uint8_t* output, size_t size);
+	void fill(std::vector<uint8_t>& output);
+
+	/**
+	 * @brief Mixes fresh system entropy into the state.
+	 * @throws std::runtime_error if no entropy source is available
+	 */
+	void reseed();
+	void reseed(const uint8_t seedMaterial[SEED_LENGTH]);
+
+	/**
+	 * @brief Generator of the calling thread, instantiated on first use.
+	 */
+	static CtrDrbg& threadLocal();
+
+	/**
+	 * @brief Reads 'size' bytes of system entropy.
+	 * @throws std::runtime_error if no entropy source is available
+	 */
+	static void systemEntropy(uint8_t* output, size_t size);
+
+private:
+	uint8_t key_[KEY_LENGTH];
+	uint8_t V_[16];
+	uint8_t keyExpansion_[240];							// -Expanded key_ (AES-256: 240 bytes), rebuilt by every update
+	uint64_t reseedCounter_ = 1;
+	bool selfSeeded_;
+	long pid_ = 0;									// -Process that seeded the state; a forked child reseeds
+
+	void update(const uint8_t providedData[SEED_LENGTH]);
+	void generate(uint8_t* output, size_t size);
+};
+};
+#endif
@@ -3,6 +3,10 @@
 
 #include <vector>
 #include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
 
 /**
  * @class Encryptor
@@ -11,6 +15,11 @@
  */
 class Encryptor {
 public:
+    /**
+     * @brief Receives a piece of freshly written output: its address and size.
+     */
+    using OutputObserver = std::function<void(const uint8_t*, size_t)>;
+
     virtual ~Encryptor() = default;
 
     /**
@@ -30,6 +39,57 @@ public:
      * but the data it points to is.
      */
     virtual void decryption(const std::vector<uint8_t>& input, std::vector<uint8_t>& output) const = 0; // Pure virtual function
+
+    /**
+     * @brief False when encryption() may return more or fewer bytes than it is given (a padding mode, for instance).
+     * The raw-buffer functions below keep the length, so callers holding such data in a vector should stay with
+     * encryption() and decryption() for these encryptors.
+     */
+    virtual bool preservesLength() const { return true; }
+
+    /**
+     * @brief Encrypts 'size' bytes at 'input' into 'output' (which may equal 'input').
+     * Used for data that does not live in a vector, such as memory-mapped files. The default implementation copies
+     * through temporary vectors; implementations able to work on raw buffers should override it.
+     * @throws std::length_error (default implementation) if encryption() changes the length.
+     */
+    virtual void encryptBytes(const uint8_t* input, size_t size, uint8_t* output) const {
+        std::vector<uint8_t> in(input, input + size), out(size);
+        this->encryption(in, out);
+        checkLength(out.size(), size, "encryptBytes");
+        std::memcpy(output, out.data(), size);
+    }
+
+    /**
+     * @brief encryptBytes() that hands the ciphertext to 'observer' as consecutive pieces, in order, covering the whole
+     * output. Meant for work on the ciphertext (statistics, checksums) that should read it while it is still in cache.
+     * The default implementation encrypts everything and reports the output as one piece; implementations that
+     * encrypt in segments should override it.
+     */
+    virtual void encryptBytesObserved(const uint8_t* input, size_t size, uint8_t* output, const OutputObserver& observer) const {
+        this->encryptBytes(input, size, output);
+        observer(output, size);
+    }
+
+    /**
+     * @brief Raw-buffer counterpart of decryption(). Same contract as encryptBytes().
+     */
+    virtual void decryptBytes(const uint8_t* input, size_t size, uint8_t* output) const {
+        std::vector<uint8_t> in(input, input + size), out(size);
+        this->decryption(in, out);
+        checkLength(out.size(), size, "decryptBytes");
+        std::memcpy(output, out.data(), size);
+    }
+
+private:
+    static void checkLength(size_t produced, size_t size, const char* function) {
+        if(produced != size) {
+            throw std::length_error(
+                std::string("In member function Encryptor::") + function + "(...): the transformation returned " +
+                std::to_string(produced) + " bytes for " + std::to_string(size) + "; see preservesLength()"
+            );
+        }
+    }
 };
 
 #endif // ENCRYPTOR_HPP
\ No newline at end of file
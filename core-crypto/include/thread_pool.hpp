@@ -0,0 +1,101 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include<atomic>
+#include<condition_variable>
+#include<deque>
+#include<functional>
+#include<future>
+#include<memory>
+#include<mutex>
+#include<thread>
+#include<type_traits>
+#include<vector>
+
+namespace CipherFortis {
+
+/**
+ * @class ThreadPool
+ * @brief Work-stealing pool of worker threads owned by the library.
+ *
+ * Every worker owns a task deque. A worker pops tasks from the back of its own deque and, once it is empty, steals
+ * from the front of the deques of the other workers. Tasks submitted from outside the pool are distributed round
+ * robin; tasks submitted from inside a worker go to that worker's deque.
+ */
+class ThreadPool {
+public:
+	struct Config {
+		size_t threadCount = 0;						// -Zero selects std::thread::hardware_concurrency()
+		std::vector<unsigned> cpuAffinity;				// -Worker i is pinned to cpuAffinity[i % size]. Empty: no pinning
+		size_t minChunkBytes = 256*1024;				// -Smallest piece a parallelizable cipher job is split into
+	};
+
+	ThreadPool();
+	explicit ThreadPool(const Config& config);
+	/**
+	 * @brief Runs every pending task, then joins the workers.
+	 */
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator = (const ThreadPool&) = delete;
+
+	/**
+	 * @brief Queues a task. Exceptions escaping the task are swallowed; use async() to observe them.
+	 */
+	void submit(std::function<void()> task);
+
+	/**
+	 * @brief Queues a callable and returns a future holding its result (or the exception it threw).
+	 */
+	template<typename F> std::future<typename std::invoke_result<F>::type> async(F&& f) {
+		using Result = typename std::invoke_result<F>::type;
+		auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(f));
+		std::future<Result> result = task->get_future();
+		this->submit([task]() { (*task)(); });
+		return result;
+	}
+
+	size_t getThreadCount() const;
+	const std::vector<unsigned>& getCpuAffinity() const;
+	size_t getMinChunkBytes() const;
+
+	/**
+	 * @brief True when called from one of this pool's worker threads.
+	 */
+	bool isWorkerThread() const;
+
+	/**
+	 * @brief Pool used by the asynchronous Cipher API when no pool is passed explicitly. Created on first use.
+	 */
+	static ThreadPool& shared();
+
+	/**
+	 * @brief Replaces the shared pool by a new one built with 'config'.
+	 * @warning Pending tasks of the previous pool are completed first; references to it become dangling.
+	 */
+	static void configureShared(const Config& config);
+
+private:
+	struct WorkerQueue {
+		std::mutex mutex;
+		std::deque<std::function<void()>> tasks;
+	};
+
+	Config config_;
+	std::vector<std::unique_ptr<WorkerQueue>> queues_;
+	std::vector<std::thread> workers_;
+	std::atomic<size_t> nextQueue_{0};
+
+	std::mutex sleepMutex_;						// -Guards pending_ and stop_ for the sleeping workers
+	std::condition_variable wakeUp_;
+	size_t pending_ = 0;
+	bool stop_ = false;
+
+	void workerLoop(size_t index);
+	bool popOwn(size_t index, std::function<void()>& task);
+	bool steal(size_t thief, std::function<void()>& task);
+	void pinWorker(size_t index);
+};
+};
+#endif
@@ -2,10 +2,12 @@
 #include"../../aes/include/AES.h"
 #include"../../aes/include/operation_modes.h"
 #include"../../include/cipher.hpp"
+#include"../../include/ctr_drbg.hpp"
 #include"../utils/print_bytes.hpp"
+#include<atomic>
 #include<cstring>
-#include<chrono>
 #include<fstream>
+#include<mutex>
 
 struct CipherFortis::InitVector{
     uint8_t data[BLOCK_SIZE];
@@ -83,32 +85,16 @@ static size_t getKeyExpansionByteLenFromNr(size_t Nr){
 
 Cipher::OperationMode::OperationMode(){}
 
-// Key expansion length in words of 64 bits
-static constexpr uint64_t KEY_EXPANSION_LENGTH_128_UINT64 = KEY_EXPANSION_LENGTH_128_BYTES / 8;
 Cipher::OperationMode::OperationMode(Identifier ID) : ID_(ID){
     switch(ID){
         case Identifier::ECB:
             break;
         case Identifier::CBC:
         case Identifier::OFB:
-        case Identifier::CTR: {     // Initialize initial vector/counter with encrypted block
-            union {
-                uint8_t  data08[KEY_EXPANSION_LENGTH_128_BYTES];
-                uint64_t data64[KEY_EXPANSION_LENGTH_128_UINT64];
-            } dummyKeyExpansion;
-
-            uint64_t initialValue = std::chrono::high_resolution_clock::now().time_since_epoch().count();
-            for(size_t i = 0; i < KEY_EXPANSION_LENGTH_128_UINT64; i++) dummyKeyExpansion.data64[i] = initialValue++;
-            union {
-                uint8_t  data08[BLOCK_SIZE];
-                uint64_t data64[2];
-            } dummyBlock;
-            dummyBlock.data64[0] = initialValue++;
-            dummyBlock.data64[1] = initialValue;
+        case Identifier::CTR:       // Initialize initial vector/counter with random bytes
             this->IV_ = new InitVector;
-            encryptECB(dummyBlock.data08, BLOCK_SIZE, dummyKeyExpansion.data08, 128, this->IV_->data);
+            CtrDrbg::threadLocal().fill(this->IV_->data, BLOCK_SIZE);
             break;
-        }
         case Identifier::Unknown:
             break;
     }
@@ -139,7 +125,7 @@ Cipher::OperationMode::Identifier Cipher::OperationMode::getOperationModeID() co
 }
 
 const uint8_t* Cipher::OperationMode::getIVpointerData() const{
-    return this->IV_->data;
+    return this->IV_ != nullptr ? this->IV_->data : nullptr;
 }
 
 bool Cipher::OperationMode::setInitialVector(const std::vector<uint8_t>& source){
@@ -312,7 +298,7 @@ Cipher::Cipher(): config(OperationMode(OperationMode::Identifier::ECB), Key::Len
 }
 
 Cipher::Cipher(const Key::LengthBits lenBits, const OperationMode::Identifier optModeID):
-    config(OperationMode(optModeID), lenBits) {
+    key(lenBits), config(OperationMode(optModeID), lenBits) {
     this->buildKeyExpansion();
 }
 
@@ -431,30 +417,39 @@ void Cipher::buildKeyExpansion() {
     }
 }
 
-void Cipher::encrypt(const uint8_t*const data, size_t size, uint8_t*const output) const{
-    // Validate inputs at C++ level for immediate feedback
+// Validation shared by the raw-pointer encryption/decryption entry points. 'operation' is "Encryption" or "Decryption".
+static void validateBuffers(const uint8_t*const data, size_t size, const uint8_t*const output, const std::string& operation) {
     if (data == nullptr) {
-        throw std::invalid_argument("Encryption failed: Input data cannot be null");
+        throw std::invalid_argument(operation + " failed: Input data cannot be null");
     }
 
     if (output == nullptr) {
-        throw std::invalid_argument("Encryption failed: Output buffer cannot be null");
+        throw std::invalid_argument(operation + " failed: Output buffer cannot be null");
     }
 
     if (size == 0) {
-        throw std::invalid_argument("Encryption failed: Data size cannot be zero");
+        throw std::invalid_argument(operation + " failed: Data size cannot be zero");
     }
 
     // Check block alignment for block cipher modes
     if (size < BLOCK_SIZE) {
-        throw std::invalid_argument("Encryption failed: Data size (" + std::to_string(size) +
+        throw std::invalid_argument(operation + " failed: Data size (" + std::to_string(size) +
                                    ") must be at least (" + std::to_string(BLOCK_SIZE) + " bytes)");
     }
+}
+
+void Cipher::encrypt(const uint8_t*const data, size_t size, uint8_t*const output) const{
+    // Validate inputs at C++ level for immediate feedback
+    validateBuffers(data, size, output, "Encryption");
 
     if (this->keyExpansion == nullptr) {
         throw EncryptionException("Key expansion not initialized - call buildKeyExpansion() first");
     }
 
+    this->encryptWithIV(data, size, output, this->config.getIVpointerData());
+}
+
+void Cipher::encryptWithIV(const uint8_t*const data, size_t size, uint8_t*const output, const uint8_t* iv) const{
     // Perform encryption
     size_t keylenBits = static_cast<size_t>(this->key.getLenBits());
     OperationMode::Identifier opt_mode = this->config.getOperationModeID();
@@ -466,34 +461,25 @@ void Cipher::encrypt(const uint8_t*const data, size_t size, uint8_t*const output
             handleExceptionCode(result, "ECB encryption");
             break;
         case OperationMode::Identifier::CBC:
-            {   // New scope, avoiding "cannot jump" error
-                const uint8_t* iv = this->config.getIVpointerData();
-                if (iv == nullptr) {
-                    throw EncryptionException("IV is required for CBC mode but not set");
-                }
-                result = encryptCBC(data, size, this->keyExpansion, keylenBits, iv, output);
-                handleExceptionCode(result, "CBC encryption");
+            if (iv == nullptr) {
+                throw EncryptionException("IV is required for CBC mode but not set");
             }
+            result = encryptCBC(data, size, this->keyExpansion, keylenBits, iv, output);
+            handleExceptionCode(result, "CBC encryption");
             break;
         case OperationMode::Identifier::OFB:
-            {
-                const uint8_t* iv = this->config.getIVpointerData();
-                if (iv == nullptr) {
-                    throw EncryptionException("IV is required for OFB mode but not set");
-                }
-                result = encryptOFB(data, size, this->keyExpansion, keylenBits, iv, output);
-                handleExceptionCode(result, "OFB encryption");
+            if (iv == nullptr) {
+                throw EncryptionException("IV is required for OFB mode but not set");
             }
+            result = encryptOFB(data, size, this->keyExpansion, keylenBits, iv, output);
+            handleExceptionCode(result, "OFB encryption");
             break;
         case OperationMode::Identifier::CTR:
-            {
-                const uint8_t* iv = this->config.getIVpointerData();
-                if (iv == nullptr) {
-                    throw EncryptionException("Counter is required for CTR mode but not set");
-                }
-                result = encryptCTR(data, size, this->keyExpansion, keylenBits, iv, output);
-                handleExceptionCode(result, "CTR encryption");
+            if (iv == nullptr) {
+                throw EncryptionException("Counter is required for CTR mode but not set");
             }
+            result = encryptCTR(data, size, this->keyExpansion, keylenBits, iv, output);
+            handleExceptionCode(result, "CTR encryption");
             break;
         default:
             throw EncryptionException("Unsupported operation mode: " + std::to_string(static_cast<int>(opt_mode)));
@@ -502,27 +488,16 @@ void Cipher::encrypt(const uint8_t*const data, size_t size, uint8_t*const output
 
 void Cipher::decrypt(const uint8_t*const data, size_t size, uint8_t*const output) const{
     // Validate inputs (same validation as encrypt)
-    if (data == nullptr) {
-        throw std::invalid_argument("Decryption failed: Input data cannot be null");
-    }
-
-    if (output == nullptr) {
-        throw std::invalid_argument("Decryption failed: Output buffer cannot be null");
-    }
-
-    if (size == 0) {
-        throw std::invalid_argument("Decryption failed: Data size cannot be zero");
-    }
-
-    if (size < BLOCK_SIZE) {
-        throw std::invalid_argument("Decryption failed: Data size (" + std::to_string(size) +
-                                   ") must be at least (" + std::to_string(BLOCK_SIZE) + " bytes)");
-    }
+    validateBuffers(data, size, output, "Decryption");
 
     if (this->keyExpansion == nullptr) {
         throw DecryptionException("Key expansion not initialized - call buildKeyExpansion() first");
     }
 
+    this->decryptWithIV(data, size, output, this->config.getIVpointerData());
+}
+
+void Cipher::decryptWithIV(const uint8_t*const data, size_t size, uint8_t*const output, const uint8_t* iv) const{
     // Perform decryption
     size_t key_len_bits = static_cast<size_t>(this->key.getLenBits());
     OperationMode::Identifier opt_mode = this->config.getOperationModeID();
@@ -534,40 +509,297 @@ void Cipher::decrypt(const uint8_t*const data, size_t size, uint8_t*const output
             handleExceptionCode(result, "ECB decryption");
             break;
         case OperationMode::Identifier::CBC:
-            {   // New scope, avoiding "cannot jump" error
-                const uint8_t* iv = this->config.getIVpointerData();
-                if (iv == nullptr) {
-                    throw DecryptionException("IV is required for CBC mode but not set");
-                }
-                result = decryptCBC(data, size, this->keyExpansion, key_len_bits, iv, output);
-                handleExceptionCode(result, "CBC decryption");
+            if (iv == nullptr) {
+                throw DecryptionException("IV is required for CBC mode but not set");
             }
+            result = decryptCBC(data, size, this->keyExpansion, key_len_bits, iv, output);
+            handleExceptionCode(result, "CBC decryption");
             break;
         case OperationMode::Identifier::OFB:
-            {
-                const uint8_t* iv = this->config.getIVpointerData();
-                if (iv == nullptr) {
-                    throw DecryptionException("IV is required for OFB mode but not set");
-                }
-                result = decryptOFB(data, size, this->keyExpansion, key_len_bits, iv, output);
-                handleExceptionCode(result, "OFB decryption");
+            if (iv == nullptr) {
+                throw DecryptionException("IV is required for OFB mode but not set");
             }
+            result = decryptOFB(data, size, this->keyExpansion, key_len_bits, iv, output);
+            handleExceptionCode(result, "OFB decryption");
             break;
         case OperationMode::Identifier::CTR:
-            {
-                const uint8_t* iv = this->config.getIVpointerData();
-                if (iv == nullptr) {
-                    throw DecryptionException("Counter is required for CTR mode but not set");
-                }
-                result = decryptCTR(data, size, this->keyExpansion, key_len_bits, iv, output);
-                handleExceptionCode(result, "CTR decryption");
+            if (iv == nullptr) {
+                throw DecryptionException("Counter is required for CTR mode but not set");
             }
+            result = decryptCTR(data, size, this->keyExpansion, key_len_bits, iv, output);
+            handleExceptionCode(result, "CTR decryption");
             break;
         default:
             throw DecryptionException("Unsupported operation mode: " + std::to_string(static_cast<int>(opt_mode)));
     }
 }
 
+// Same arithmetic CounterIncrease applies block by block in operation_modes.c.
+void Cipher::advanceCounter(uint8_t counter[CHAINING_BLOCK_SIZE], uint64_t blocks) {
+    unsigned carry = 0;
+    for(int i = BLOCK_SIZE - 1; i >= 0 && (blocks != 0 || carry != 0); i--) {
+        unsigned sum = counter[i] + static_cast<unsigned>(blocks & 0xFF) + carry;
+        counter[i] = static_cast<uint8_t>(sum);
+        carry = sum >> 8;
+        blocks >>= 8;
+    }
+}
+
+void Cipher::tileChainingBlock(uint64_t index, uint8_t chainingBlock[CHAINING_BLOCK_SIZE]) const{
+    this->initChainingBlock(chainingBlock);
+    switch(this->config.getOperationModeID()) {
+        case OperationMode::Identifier::CTR:
+            if(index >> 32 != 0) {
+                throw std::invalid_argument("Tile index " + std::to_string(index) + " exceeds the 2^32 tiles of a CTR layout");
+            }
+            advanceCounter(chainingBlock, index << 32);
+            break;
+        case OperationMode::Identifier::CBC:
+        case OperationMode::Identifier::OFB: {
+            if (this->keyExpansion == nullptr) {
+                throw AESException("Key expansion not initialized - call buildKeyExpansion() first");
+            }
+            for(int i = BLOCK_SIZE - 1; i >= BLOCK_SIZE - 8; i--, index >>= 8) chainingBlock[i] ^= static_cast<uint8_t>(index);
+            enum ExceptionCode result = encryptECB(chainingBlock, BLOCK_SIZE, this->keyExpansion,
+                                                   static_cast<size_t>(this->key.getLenBits()), chainingBlock);
+            handleExceptionCode(result, "Tile chaining block derivation");
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void Cipher::encryptFrom(const uint8_t*const data, size_t size, uint8_t*const output, const uint8_t chainingBlock[CHAINING_BLOCK_SIZE]) const{
+    validateBuffers(data, size, output, "Encryption");
+    if (this->keyExpansion == nullptr) {
+        throw EncryptionException("Key expansion not initialized - call buildKeyExpansion() first");
+    }
+    this->encryptWithIV(data, size, output, chainingBlock);
+}
+
+void Cipher::decryptFrom(const uint8_t*const data, size_t size, uint8_t*const output, const uint8_t chainingBlock[CHAINING_BLOCK_SIZE]) const{
+    validateBuffers(data, size, output, "Decryption");
+    if (this->keyExpansion == nullptr) {
+        throw DecryptionException("Key expansion not initialized - call buildKeyExpansion() first");
+    }
+    this->decryptWithIV(data, size, output, chainingBlock);
+}
+
+namespace {
+/*
+ * Completion state shared by the chunks of one asynchronous job. The chunk finishing last fulfils the promise, with
+ * the first exception raised by any chunk if there was one.
+ * */
+struct AsyncJob {
+    std::shared_ptr<const Cipher> cipher;                                       // -Snapshot, so the caller's Cipher may die first
+    std::promise<void> done;
+    std::atomic<size_t> remaining{0};
+    std::mutex errorMutex;
+    std::exception_ptr error;
+
+    void finishChunk(std::exception_ptr e) {
+        if(e) {
+            std::lock_guard<std::mutex> lock(this->errorMutex);
+            if(!this->error) this->error = e;
+        }
+        if(this->remaining.fetch_sub(1) == 1) {
+            if(this->error) this->done.set_exception(this->error);
+            else this->done.set_value();
+        }
+    }
+};
+
+struct AsyncChunk {
+    const uint8_t* input;
+    size_t size;
+    uint8_t* output;
+    bool hasIV;
+    uint8_t iv[BLOCK_SIZE];                                                     // -Chaining value this chunk starts from
+};
+}
+
+std::future<void> Cipher::submitAsync(const std::vector<BatchItem>& items, bool decrypt, bool batch, ThreadPool& pool) const{
+    const std::string operation = decrypt ? "Decryption" : "Encryption";
+    for(const BatchItem& item : items) validateBuffers(item.input, item.size, item.output, operation);
+
+    auto job = std::make_shared<AsyncJob>();
+    job->cipher = std::make_shared<const Cipher>(*this);
+    std::future<void> result = job->done.get_future();
+
+    // Which jobs can be split: every chunk must be computable from the input alone and the chunk offset.
+    OperationMode::Identifier opt_mode = this->config.getOperationModeID();
+    bool splittable = opt_mode == OperationMode::Identifier::ECB ||
+                      opt_mode == OperationMode::Identifier::CTR ||
+                      (opt_mode == OperationMode::Identifier::CBC && decrypt);
+    const uint8_t* iv = this->config.getIVpointerData();
+    size_t minChunk = (pool.getMinChunkBytes() + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE;
+    size_t chunksPerItem = 4*pool.getThreadCount();                            // -Some slack so stealing can even out the load
+
+    std::vector<AsyncChunk> chunks;
+    uint8_t itemIV[BLOCK_SIZE];
+    for(size_t index = 0; index < items.size(); index++) {
+        const BatchItem& item = items[index];
+        if(iv != nullptr) {                                                     // -Batch items never share a keystream
+            if(batch) this->tileChainingBlock(index, itemIV);
+            else std::memcpy(itemIV, iv, BLOCK_SIZE);
+        }
+        size_t chunkSize = item.size;
+        if(splittable && item.size % BLOCK_SIZE == 0 && item.size > minChunk) {
+            size_t target = (item.size + chunksPerItem - 1) / chunksPerItem;
+            target = (target + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE;
+            chunkSize = target > minChunk ? target : minChunk;
+        }
+        for(size_t offset = 0; offset < item.size; offset += chunkSize) {
+            AsyncChunk chunk;
+            chunk.input = item.input + offset;
+            chunk.size = item.size - offset < chunkSize ? item.size - offset : chunkSize;
+            chunk.output = item.output + offset;
+            chunk.hasIV = iv != nullptr;
+            if(chunk.hasIV) {
+                if(offset == 0) {
+                    std::memcpy(chunk.iv, itemIV, BLOCK_SIZE);
+                } else if(opt_mode == OperationMode::Identifier::CTR) {
+                    std::memcpy(chunk.iv, itemIV, BLOCK_SIZE);
+                    advanceCounter(chunk.iv, offset / BLOCK_SIZE);
+                } else {                                                        // -CBC decryption: previous ciphertext block. Copied
+                    std::memcpy(chunk.iv, item.input + offset - BLOCK_SIZE, BLOCK_SIZE); // now, in-place jobs overwrite it.
+                }
+            }
+            chunks.push_back(chunk);
+        }
+    }
+
+    if(chunks.empty()) {                                                        // -Empty batch: nothing will fulfil the promise
+        job->done.set_value();
+        return result;
+    }
+    job->remaining = chunks.size();
+    for(const AsyncChunk& chunk : chunks) {
+        pool.submit([job, chunk, decrypt]() {
+            std::exception_ptr e;
+            try {
+                const uint8_t* chunkIV = chunk.hasIV ? chunk.iv : nullptr;
+                if(decrypt) job->cipher->decryptWithIV(chunk.input, chunk.size, chunk.output, chunkIV);
+                else        job->cipher->encryptWithIV(chunk.input, chunk.size, chunk.output, chunkIV);
+            } catch(...) {
+                e = std::current_exception();
+            }
+            job->finishChunk(e);
+        });
+    }
+    return result;
+}
+
+std::future<void> Cipher::encryptAsync(const uint8_t*const data, size_t size, uint8_t*const output, ThreadPool& pool) const{
+    return this->submitAsync({BatchItem{data, size, output}}, false, false, pool);
+}
+
+std::future<void> Cipher::decryptAsync(const uint8_t*const data, size_t size, uint8_t*const output, ThreadPool& pool) const{
+    return this->submitAsync({BatchItem{data, size, output}}, true, false, pool);
+}
+
+std::future<void> Cipher::encryptBatchAsync(const std::vector<BatchItem>& items, ThreadPool& pool) const{
+    return this->submitAsync(items, false, true, pool);
+}
+
+std::future<void> Cipher::decryptBatchAsync(const std::vector<BatchItem>& items, ThreadPool& pool) const{
+    return this->submitAsync(items, true, true, pool);
+}
+
+static_assert(Cipher::CHAINING_BLOCK_SIZE == BLOCK_SIZE, "Chaining block must have the size of an AES block");
+
+void Cipher::initChainingBlock(uint8_t chainingBlock[CHAINING_BLOCK_SIZE]) const{
+    const uint8_t* iv = this->config.getIVpointerData();
+    if(iv != nullptr) std::memcpy(chainingBlock, iv, BLOCK_SIZE);
+    else std::memset(chainingBlock, 0, BLOCK_SIZE);
+}
+
+void Cipher::encryptSegment(const uint8_t*const data, size_t size, uint8_t*const output, uint8_t chainingBlock[CHAINING_BLOCK_SIZE]) const{
+    this->processSegment(data, size, output, chainingBlock, false);
+}
+
+void Cipher::decryptSegment(const uint8_t*const data, size_t size, uint8_t*const output, uint8_t chainingBlock[CHAINING_BLOCK_SIZE]) const{
+    this->processSegment(data, size, output, chainingBlock, true);
+}
+
+/*
+ * Value the next segment chains from, per mode:
+ *   CBC encryption -> last ciphertext block (output)
+ *   CBC decryption -> last ciphertext block (input, saved before an in-place call overwrites it)
+ *   OFB            -> last keystream block, that is last input XOR last output
+ *   CTR            -> counter advanced by the number of blocks processed
+ * */
+void Cipher::processSegment(const uint8_t*const data, size_t size, uint8_t*const output, uint8_t chainingBlock[CHAINING_BLOCK_SIZE], bool decrypt) const{
+    const std::string operation = decrypt ? "Decryption" : "Encryption";
+    validateBuffers(data, size, output, operation);
+    if(chainingBlock == nullptr) {
+        throw std::invalid_argument(operation + " failed: Chaining block cannot be null");
+    }
+    if(size % BLOCK_SIZE != 0) {
+        throw std::invalid_argument(operation + " failed: Segment size (" + std::to_string(size) +
+                                   ") must be a multiple of " + std::to_string(BLOCK_SIZE) + " bytes");
+    }
+    if (this->keyExpansion == nullptr) {
+        throw AESException("Key expansion not initialized - call buildKeyExpansion() first");
+    }
+
+    OperationMode::Identifier opt_mode = this->config.getOperationModeID();
+    const uint8_t* iv = opt_mode == OperationMode::Identifier::ECB ? nullptr : chainingBlock;
+    uint8_t lastInput[BLOCK_SIZE];
+    std::memcpy(lastInput, data + size - BLOCK_SIZE, BLOCK_SIZE);
+
+    if(decrypt) this->decryptWithIV(data, size, output, iv);
+    else        this->encryptWithIV(data, size, output, iv);
+
+    switch(opt_mode) {
+        case OperationMode::Identifier::CBC:
+            std::memcpy(chainingBlock, decrypt ? lastInput : output + size - BLOCK_SIZE, BLOCK_SIZE);
+            break;
+        case OperationMode::Identifier::OFB:
+            for(size_t i = 0; i < BLOCK_SIZE; i++) chainingBlock[i] = lastInput[i] ^ output[size - BLOCK_SIZE + i];
+            break;
+        case OperationMode::Identifier::CTR:
+            advanceCounter(chainingBlock, size / BLOCK_SIZE);
+            break;
+        default:
+            break;
+    }
+}
+
+void Cipher::encryptBytes(const uint8_t* input, size_t size, uint8_t* output) const{
+    this->encrypt(input, size, output);
+}
+
+void Cipher::decryptBytes(const uint8_t* input, size_t size, uint8_t* output) const{
+    this->decrypt(input, size, output);
+}
+
+/*
+ * Segments go through encryptSegment(); the last one, at most OBSERVED_SEGMENT_SIZE bytes, is encrypted from the
+ * chaining value the others leave behind. Everything encrypt() would reject is rejected before the first segment, so a
+ * failed call leaves the output untouched (every mode of the C layer takes whole blocks only).
+ * */
+void Cipher::encryptBytesObserved(const uint8_t* input, size_t size, uint8_t* output, const OutputObserver& observer) const{
+    validateBuffers(input, size, output, "Encryption");
+    if(size % BLOCK_SIZE != 0) {
+        throw std::invalid_argument("Encryption failed: Data size (" + std::to_string(size) +
+                                    ") must be a multiple of " + std::to_string(BLOCK_SIZE) + " bytes");
+    }
+    if (this->keyExpansion == nullptr) {
+        throw EncryptionException("Key expansion not initialized - call buildKeyExpansion() first");
+    }
+    uint8_t chainingBlock[CHAINING_BLOCK_SIZE];
+    this->initChainingBlock(chainingBlock);
+    size_t offset = 0;
+    for(; size - offset > OBSERVED_SEGMENT_SIZE; offset += OBSERVED_SEGMENT_SIZE) {
+        this->encryptSegment(input + offset, OBSERVED_SEGMENT_SIZE, output + offset, chainingBlock);
+        observer(output + offset, OBSERVED_SEGMENT_SIZE);
+    }
+    this->encryptFrom(input + offset, size - offset, output + offset, chainingBlock);
+    observer(output + offset, size - offset);
+}
+
 void Cipher::encryption(const std::vector<uint8_t>& input, std::vector<uint8_t>& output) const{
     if (input.empty()) {
         throw std::invalid_argument("Input data vector cannot be empty");
@@ -0,0 +1,147 @@
+#include"../../include/cipher_stream.hpp"
+#include<cstring>
+#include<stdexcept>
+#include<string>
+
+using namespace CipherFortis;
+
+static constexpr size_t STREAM_BLOCK_SIZE = Cipher::CHAINING_BLOCK_SIZE;
+
+static size_t validateBufferSize(size_t bufferSize) {
+    size_t rounded = bufferSize - bufferSize % STREAM_BLOCK_SIZE;
+    if(rounded == 0) {
+        throw std::invalid_argument(
+            "In constructor CipherStreamBuf::CipherStreamBuf(...): buffer size (" + std::to_string(bufferSize) +
+            ") must hold at least one block of " + std::to_string(STREAM_BLOCK_SIZE) + " bytes"
+        );
+    }
+    return rounded;
+}
+
+CipherStreamBuf::CipherStreamBuf(std::istream& source, const Cipher& cipher, Operation op, size_t bufferSize):
+    source_(&source), cipher_(cipher), operation_(op), bufferSize_(validateBufferSize(bufferSize)),
+    buffer_(new uint8_t[bufferSize_]) {
+    this->cipher_.initChainingBlock(this->chainingBlock_);
+    this->setg(this->bufferBegin(), this->bufferBegin(), this->bufferBegin());  // -Empty get area: first read refills
+}
+
+CipherStreamBuf::CipherStreamBuf(std::ostream& sink, const Cipher& cipher, Operation op, size_t bufferSize):
+    sink_(&sink), cipher_(cipher), operation_(op), bufferSize_(validateBufferSize(bufferSize)),
+    buffer_(new uint8_t[bufferSize_]) {
+    this->cipher_.initChainingBlock(this->chainingBlock_);
+    this->setp(this->bufferBegin(), this->bufferBegin() + this->bufferSize_);
+}
+
+CipherStreamBuf::~CipherStreamBuf() {
+    try {
+        this->close();
+    } catch(...) {}
+}
+
+size_t CipherStreamBuf::getBufferSize() const {
+    return this->bufferSize_;
+}
+
+char* CipherStreamBuf::bufferBegin() {
+    return reinterpret_cast<char*>(this->buffer_.get());
+}
+
+void CipherStreamBuf::transform(uint8_t* data, size_t size) {
+    if(size == 0) return;
+    if(this->operation_ == Operation::Encrypt) this->cipher_.encryptSegment(data, size, data, this->chainingBlock_);
+    else this->cipher_.decryptSegment(data, size, data, this->chainingBlock_);
+}
+
+CipherStreamBuf::int_type CipherStreamBuf::underflow() {
+    if(this->source_ == nullptr) return traits_type::eof();
+    if(this->gptr() < this->egptr()) return traits_type::to_int_type(*this->gptr());
+
+    // istream::read only stops short at end of input, so a partial block here is the end of the message.
+    this->source_->read(this->bufferBegin(), static_cast<std::streamsize>(this->bufferSize_));
+    size_t got = static_cast<size_t>(this->source_->gcount());
+    if(got == 0) return traits_type::eof();
+    if(got % STREAM_BLOCK_SIZE != 0) {
+        throw std::runtime_error(
+            "In function CipherStreamBuf::underflow(): input ends with a partial block of " +
+            std::to_string(got % STREAM_BLOCK_SIZE) + " bytes; data size must be a multiple of " +
+            std::to_string(STREAM_BLOCK_SIZE)
+        );
+    }
+    this->transform(this->buffer_.get(), got);
+    this->setg(this->bufferBegin(), this->bufferBegin(), this->bufferBegin() + got);
+    return traits_type::to_int_type(*this->gptr());
+}
+
+bool CipherStreamBuf::flushBlocks() {
+    size_t pending = static_cast<size_t>(this->pptr() - this->pbase());
+    size_t remainder = pending % STREAM_BLOCK_SIZE;
+    size_t whole = pending - remainder;
+
+    this->transform(this->buffer_.get(), whole);
+    if(whole > 0) this->sink_->write(this->bufferBegin(), static_cast<std::streamsize>(whole));
+    if(remainder > 0) std::memmove(this->buffer_.get(), this->buffer_.get() + whole, remainder);
+    this->setp(this->bufferBegin(), this->bufferBegin() + this->bufferSize_);
+    this->pbump(static_cast<int>(remainder));
+    return this->sink_->good();
+}
+
+CipherStreamBuf::int_type CipherStreamBuf::overflow(int_type ch) {
+    if(this->sink_ == nullptr || this->closed_) return traits_type::eof();
+    if(!this->flushBlocks()) return traits_type::eof();
+    if(traits_type::eq_int_type(ch, traits_type::eof())) return traits_type::not_eof(ch);
+    *this->pptr() = traits_type::to_char_type(ch);
+    this->pbump(1);
+    return ch;
+}
+
+int CipherStreamBuf::sync() {
+    if(this->sink_ == nullptr || this->closed_) return 0;
+    if(!this->flushBlocks()) return -1;
+    this->sink_->flush();
+    return this->sink_->good() ? 0 : -1;
+}
+
+void CipherStreamBuf::close() {
+    if(this->sink_ == nullptr || this->closed_) return;
+    bool written = this->flushBlocks();
+    size_t remainder = static_cast<size_t>(this->pptr() - this->pbase());
+    this->closed_ = true;
+    this->setp(nullptr, nullptr);
+    if(remainder != 0) {
+        throw std::runtime_error(
+            "In function CipherStreamBuf::close(): output ends with a partial block of " + std::to_string(remainder) +
+            " bytes; data size must be a multiple of " + std::to_string(STREAM_BLOCK_SIZE)
+        );
+    }
+    this->sink_->flush();
+    if(!written || !this->sink_->good()) {
+        throw std::runtime_error("In function CipherStreamBuf::close(): could not write to the underlying stream");
+    }
+}
+
+icipherstream::icipherstream(std::istream& source, const Cipher& cipher, CipherStreamBuf::Operation op, size_t bufferSize):
+    std::istream(nullptr), buf_(source, cipher, op, bufferSize) {
+    this->init(&this->buf_);
+}
+
+CipherStreamBuf* icipherstream::rdbuf() {
+    return &this->buf_;
+}
+
+ocipherstream::ocipherstream(std::ostream& sink, const Cipher& cipher, CipherStreamBuf::Operation op, size_t bufferSize):
+    std::ostream(nullptr), buf_(sink, cipher, op, bufferSize) {
+    this->init(&this->buf_);
+}
+
+CipherStreamBuf* ocipherstream::rdbuf() {
+    return &this->buf_;
+}
+
+void ocipherstream::close() {
+    try {
+        this->buf_.close();
+    } catch(...) {
+        this->setstate(std::ios_base::failbit);
+        throw;
+    }
+}
@@ -0,0 +1,175 @@
+#include"../../aes/include/constants.h"
+#include"../../aes/include/key_expansion.h"
+#include"../../aes/include/operation_modes.h"
+#include"../../include/ctr_drbg.hpp"
+#include"../../include/cipher.hpp"
+#include<cerrno>
+#include<cstdio>
+#include<cstring>
+#include<stdexcept>
+#include<string>
+#include<unistd.h>
+#ifdef __linux__
+#include<sys/random.h>
+#endif
+#if defined(__x86_64__) && defined(__GNUC__)
+#include<immintrin.h>
+#endif
+
+using namespace CipherFortis;
+
+// Plain memset may be dropped by the optimizer when the buffer dies right after.
+static void secureWipe(void* p, size_t size) {
+    volatile uint8_t* bytes = static_cast<volatile uint8_t*>(p);
+    for(size_t i = 0; i < size; i++) bytes[i] = 0;
+}
+
+static void checkCode(enum ExceptionCode code, const char* where) {
+    if(code != NoException) {
+        throw std::runtime_error(std::string("In function ") + where + ": AES primitive failed with code " + std::to_string(static_cast<int>(code)));
+    }
+}
+
+#if defined(__x86_64__) && defined(__GNUC__)
+__attribute__((target("rdseed")))
+static bool rdseedEntropy(uint8_t* output, size_t size) {
+    if(!__builtin_cpu_supports("rdseed")) return false;
+    for(size_t offset = 0; offset < size; offset += 8) {
+        unsigned long long word;
+        int tries = 0;
+        while(_rdseed64_step(&word) == 0) {                                    // -RDSEED may underflow transiently
+            if(++tries == 1024) return false;
+            _mm_pause();
+        }
+        size_t n = size - offset < 8 ? size - offset : 8;
+        std::memcpy(output + offset, &word, n);
+    }
+    return true;
+}
+#endif
+
+void CtrDrbg::systemEntropy(uint8_t* output, size_t size) {
+#ifdef __linux__
+    size_t got = 0;
+    while(got < size) {
+        ssize_t r = getrandom(output + got, size - got, 0);
+        if(r < 0) {
+            if(errno == EINTR) continue;
+            break;                                                              // -Kernel without getrandom: try the next source
+        }
+        got += static_cast<size_t>(r);
+    }
+    if(got == size) return;
+#endif
+#if defined(__x86_64__) && defined(__GNUC__)
+    if(rdseedEntropy(output, size)) return;
+#endif
+    FILE* urandom = std::fopen("/dev/urandom", "rb");
+    if(urandom != nullptr) {
+        size_t got_ = std::fread(output, 1, size, urandom);
+        std::fclose(urandom);
+        if(got_ == size) return;
+    }
+    throw std::runtime_error("In function CtrDrbg::systemEntropy(uint8_t*, size_t): no entropy source available");
+}
+
+CtrDrbg::CtrDrbg(): selfSeeded_(true) {
+    uint8_t seedMaterial[SEED_LENGTH];
+    systemEntropy(seedMaterial, SEED_LENGTH);
+    std::memset(this->key_, 0, KEY_LENGTH);
+    std::memset(this->V_, 0, BLOCK_SIZE);
+    checkCode(KeyExpansionInitWrite(this->key_, KEY_LENGTH_BITS_256, this->keyExpansion_, false), "CtrDrbg::CtrDrbg()");
+    this->update(seedMaterial);
+    secureWipe(seedMaterial, SEED_LENGTH);
+    this->pid_ = static_cast<long>(getpid());
+}
+
+CtrDrbg::CtrDrbg(const uint8_t seedMaterial[SEED_LENGTH]): selfSeeded_(false) {
+    std::memset(this->key_, 0, KEY_LENGTH);
+    std::memset(this->V_, 0, BLOCK_SIZE);
+    checkCode(KeyExpansionInitWrite(this->key_, KEY_LENGTH_BITS_256, this->keyExpansion_, false), "CtrDrbg::CtrDrbg(const uint8_t*)");
+    this->update(seedMaterial);
+}
+
+CtrDrbg::~CtrDrbg() {
+    secureWipe(this->key_, KEY_LENGTH);
+    secureWipe(this->V_, BLOCK_SIZE);
+    secureWipe(this->keyExpansion_, sizeof(this->keyExpansion_));
+}
+
+/*
+ * CTR_DRBG_Update: (Key, V) <- leftmost 48 bytes of E(Key, V+1) || E(Key, V+2) || E(Key, V+3), XOR providedData.
+ * That is the CTR-mode encryption of providedData with counter V+1.
+ * */
+void CtrDrbg::update(const uint8_t providedData[SEED_LENGTH]) {
+    uint8_t temp[SEED_LENGTH];
+    uint8_t counter[BLOCK_SIZE];
+    std::memcpy(counter, this->V_, BLOCK_SIZE);
+    Cipher::advanceCounter(counter, 1);
+    checkCode(encryptCTR(providedData, SEED_LENGTH, this->keyExpansion_, KEY_LENGTH_BITS_256, counter, temp), "CtrDrbg::update()");
+    std::memcpy(this->key_, temp, KEY_LENGTH);
+    std::memcpy(this->V_, temp + KEY_LENGTH, BLOCK_SIZE);
+    checkCode(KeyExpansionInitWrite(this->key_, KEY_LENGTH_BITS_256, this->keyExpansion_, false), "CtrDrbg::update()");
+    secureWipe(temp, SEED_LENGTH);
+}
+
+/*
+ * CTR_DRBG_Generate without additional input; size <= MAX_REQUEST_BYTES. The output is the keystream E(Key, V+1),
+ * E(Key, V+2), ..., obtained by encrypting zeros in CTR mode directly into the caller's buffer.
+ * */
+void CtrDrbg::generate(uint8_t* output, size_t size) {
+    static const uint8_t zeros[SEED_LENGTH] = {0};
+    size_t whole = size - size % BLOCK_SIZE;
+    uint8_t counter[BLOCK_SIZE];
+    std::memcpy(counter, this->V_, BLOCK_SIZE);
+    Cipher::advanceCounter(counter, 1);
+
+    if(whole > 0) {
+        std::memset(output, 0, whole);
+        checkCode(encryptCTR(output, whole, this->keyExpansion_, KEY_LENGTH_BITS_256, counter, output), "CtrDrbg::generate()");
+        Cipher::advanceCounter(counter, whole / BLOCK_SIZE);
+    }
+    if(whole < size) {
+        uint8_t last[BLOCK_SIZE];
+        checkCode(encryptCTR(zeros, BLOCK_SIZE, this->keyExpansion_, KEY_LENGTH_BITS_256, counter, last), "CtrDrbg::generate()");
+        std::memcpy(output + whole, last, size - whole);
+        secureWipe(last, BLOCK_SIZE);
+    }
+    Cipher::advanceCounter(this->V_, (size + BLOCK_SIZE - 1) / BLOCK_SIZE);
+    this->update(zeros);
+    this->reseedCounter_++;
+}
+
+void CtrDrbg::fill(uint8_t* output, size_t size) {
+    if(output == nullptr && size > 0) {
+        throw std::invalid_argument("In function CtrDrbg::fill(uint8_t* output, size_t size): output cannot be null");
+    }
+    if(this->selfSeeded_ && (this->reseedCounter_ > RESEED_INTERVAL || static_cast<long>(getpid()) != this->pid_)) {
+        this->reseed();
+    }
+    for(size_t offset = 0; offset < size; offset += MAX_REQUEST_BYTES) {
+        this->generate(output + offset, size - offset < MAX_REQUEST_BYTES ? size - offset : MAX_REQUEST_BYTES);
+    }
+}
+
+void CtrDrbg::fill(std::vector<uint8_t>& output) {
+    this->fill(output.data(), output.size());
+}
+
+void CtrDrbg::reseed() {
+    uint8_t seedMaterial[SEED_LENGTH];
+    systemEntropy(seedMaterial, SEED_LENGTH);
+    this->reseed(seedMaterial);
+    secureWipe(seedMaterial, SEED_LENGTH);
+    this->pid_ = static_cast<long>(getpid());
+}
+
+void CtrDrbg::reseed(const uint8_t seedMaterial[SEED_LENGTH]) {
+    this->update(seedMaterial);
+    this->reseedCounter_ = 1;
+}
+
+CtrDrbg& CtrDrbg::threadLocal() {
+    thread_local CtrDrbg instance;
+    return instance;
+}
@@ -1,9 +1,10 @@
 #include<fstream>
+#include<memory>
 #include<string>
 #include<cstring>
-#include<random>
 #include"../../aes/include/constants.h"
 #include"../../include/key.hpp"
+#include"../../include/ctr_drbg.hpp"
 #include"../utils/print_bytes.hpp"
 
 using namespace CipherFortis;
@@ -18,15 +19,9 @@ Key::Key(): lenBits(LengthBits::_256), lenBytes(fromLenBitsToLenBytes(lenBits))
 }
 
 Key::Key(LengthBits lenbits): lenBits(lenbits), lenBytes(fromLenBitsToLenBytes(lenbits)){
-    size_t i;
-    union { int integer; char chars[4]; } buff;                                 // -Anonymous union. Casting from 32 bits integer to four chars
-    std::random_device dev; std::mt19937 seed(dev());
-    std::uniform_int_distribution<std::mt19937::result_type> distribution;      // -Random number with uniform distribution
-    this->data = new uint8_t[this->lenBytes];
-    for(i = 0; i < this->lenBytes; i += 4) {                                    // -I am supposing everything is fine and lenBytes is a multiple of four
-        buff.integer = distribution(seed);                                      // -Taking a random 32 bits integer to divide it into four bytes
-        memcpy(reinterpret_cast<char*>(this->data + i), buff.chars, 4);
-    }
+    std::unique_ptr<uint8_t[]> bytes(new uint8_t[this->lenBytes]);
+    CtrDrbg::threadLocal().fill(bytes.get(), this->lenBytes);                  // -Per-thread AES-256 CTR_DRBG, seeded once
+    this->data = bytes.release();                                               // -Not leaked if fill() throws
 }
 
 Key::Key(const std::vector<uint8_t>& key_, LengthBits lenbits)
@@ -0,0 +1,162 @@
+#include"../../include/thread_pool.hpp"
+#include<stdexcept>
+#include<string>
+#ifdef __linux__
+#include<pthread.h>
+#include<sched.h>
+#endif
+
+using namespace CipherFortis;
+
+// Pool and queue index of the calling thread, set only inside worker threads.
+static thread_local const ThreadPool* currentPool = nullptr;
+static thread_local size_t currentQueue = 0;
+
+#ifdef __linux__
+static void validateAffinity(const std::vector<unsigned>& cpus) {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if(sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return;           // -Nothing to validate against
+    for(unsigned cpu : cpus) {
+        if(cpu >= CPU_SETSIZE || !CPU_ISSET(cpu, &allowed)) {
+            throw std::invalid_argument(
+                "In constructor ThreadPool::ThreadPool(const Config& config): CPU " + std::to_string(cpu) +
+                " is not available to this process"
+            );
+        }
+    }
+}
+#endif
+
+ThreadPool::ThreadPool(): ThreadPool(Config()) {}
+
+ThreadPool::ThreadPool(const Config& config): config_(config) {
+    if(this->config_.threadCount == 0) {
+        this->config_.threadCount = std::thread::hardware_concurrency();
+        if(this->config_.threadCount == 0) this->config_.threadCount = 1;
+    }
+    if(this->config_.minChunkBytes == 0) {
+        throw std::invalid_argument("In constructor ThreadPool::ThreadPool(const Config& config): minChunkBytes cannot be zero");
+    }
+#ifdef __linux__
+    validateAffinity(this->config_.cpuAffinity);
+#endif
+    for(size_t i = 0; i < this->config_.threadCount; i++) this->queues_.push_back(std::make_unique<WorkerQueue>());
+    for(size_t i = 0; i < this->config_.threadCount; i++) {
+        this->workers_.emplace_back(&ThreadPool::workerLoop, this, i);
+        this->pinWorker(i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(this->sleepMutex_);
+        this->stop_ = true;
+    }
+    this->wakeUp_.notify_all();
+    for(std::thread& worker : this->workers_) worker.join();
+}
+
+void ThreadPool::pinWorker(size_t index) {
+    if(this->config_.cpuAffinity.empty()) return;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(this->config_.cpuAffinity[index % this->config_.cpuAffinity.size()], &set);
+    pthread_setaffinity_np(this->workers_[index].native_handle(), sizeof(set), &set);
+#endif
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    size_t index = this->isWorkerThread()
+        ? currentQueue
+        : this->nextQueue_.fetch_add(1, std::memory_order_relaxed) % this->queues_.size();
+    // Counted before it is queued: a worker may take and finish the task before this thread gets the lock again.
+    {
+        std::lock_guard<std::mutex> lock(this->sleepMutex_);
+        this->pending_++;
+    }
+    try {
+        std::lock_guard<std::mutex> lock(this->queues_[index]->mutex);
+        this->queues_[index]->tasks.push_back(std::move(task));
+    } catch(...) {
+        std::lock_guard<std::mutex> lock(this->sleepMutex_);
+        this->pending_--;
+        throw;
+    }
+    this->wakeUp_.notify_one();
+}
+
+bool ThreadPool::popOwn(size_t index, std::function<void()>& task) {
+    WorkerQueue& queue = *this->queues_[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if(queue.tasks.empty()) return false;
+    task = std::move(queue.tasks.back());                                       // -Newest task first: its data is likely still cached
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::steal(size_t thief, std::function<void()>& task) {
+    size_t n = this->queues_.size();
+    for(size_t k = 1; k < n; k++) {
+        WorkerQueue& victim = *this->queues_[(thief + k) % n];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if(victim.tasks.empty()) continue;
+        task = std::move(victim.tasks.front());                                 // -Oldest task: the one its owner reaches last
+        victim.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    currentPool = this;
+    currentQueue = index;
+    for(;;) {
+        std::function<void()> task;
+        if(this->popOwn(index, task) || this->steal(index, task)) {
+            {
+                std::lock_guard<std::mutex> lock(this->sleepMutex_);
+                this->pending_--;
+            }
+            try {
+                task();
+            } catch(...) {}                                                     // -A throwing task must not take the worker down
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(this->sleepMutex_);
+        this->wakeUp_.wait(lock, [this]() { return this->stop_ || this->pending_ > 0; });
+        if(this->stop_ && this->pending_ == 0) return;
+    }
+}
+
+size_t ThreadPool::getThreadCount() const {
+    return this->config_.threadCount;
+}
+
+const std::vector<unsigned>& ThreadPool::getCpuAffinity() const {
+    return this->config_.cpuAffinity;
+}
+
+size_t ThreadPool::getMinChunkBytes() const {
+    return this->config_.minChunkBytes;
+}
+
+bool ThreadPool::isWorkerThread() const {
+    return currentPool == this;
+}
+
+static std::mutex sharedPoolMutex;
+static std::unique_ptr<ThreadPool> sharedPool;
+
+ThreadPool& ThreadPool::shared() {
+    std::lock_guard<std::mutex> lock(sharedPoolMutex);
+    if(sharedPool == nullptr) sharedPool = std::make_unique<ThreadPool>();
+    return *sharedPool;
+}
+
+void ThreadPool::configureShared(const Config& config) {
+    std::unique_ptr<ThreadPool> replacement = std::make_unique<ThreadPool>(config);
+    std::lock_guard<std::mutex> lock(sharedPoolMutex);
+    sharedPool.swap(replacement);                                               // -Previous pool drains and joins when 'replacement' dies
+}
@@ -0,0 +1,69 @@
+#ifndef ASYNC_FILE_ENCRYPTOR_HPP
+#define ASYNC_FILE_ENCRYPTOR_HPP
+
+#include<filesystem>
+#include"io_engine.hpp"
+#include"../../core-crypto/include/cipher.hpp"
+
+namespace File {
+
+/**
+ * @class AsyncFileEncryptor
+ * @brief Chunked file encryption that overlaps disk I/O with the cipher.
+ *
+ * Up to 'queueDepth' chunk buffers cycle through read -> encrypt -> write on an IOEngine (io_uring on Linux when
+ * available, a pread/pwrite thread pool otherwise). Reads run ahead while earlier chunks are encrypted and written;
+ * chunks are encrypted strictly in file order so the mode's chaining value can be carried forward, which keeps the
+ * output byte-identical to Cipher::encrypt() over the whole file.
+ *
+ * With directIO the files are opened with O_DIRECT: buffers and chunk sizes are page aligned, the final chunk is
+ * written padded and the output truncated to its real size. File systems without O_DIRECT support fall back to
+ * buffered I/O, which Stats::directIO reports.
+ */
+class AsyncFileEncryptor {
+public:
+	struct Config {
+		size_t chunkBytes = 1024*1024;						// -Multiple of 16; rounded up to 4096 with directIO. At most MAX_CHUNK_BYTES
+		size_t queueDepth = 8;							// -Chunk buffers in circulation
+		bool directIO = false;
+		IOEngine::Backend backend = IOEngine::Backend::Auto;
+	};
+
+	// Largest chunk: one request per chunk, and io_uring moves at most 2^31 - 4096 bytes per request.
+	static constexpr size_t MAX_CHUNK_BYTES = size_t(1) << 30;
+
+	struct Stats {
+		IOEngine::Backend backend = IOEngine::Backend::Auto;			// -Engine actually used
+		bool directIO = false;							// -O_DIRECT actually in effect
+		size_t chunks = 0;
+		size_t reads = 0;							// -Requests, including resubmitted short transfers
+		size_t writes = 0;
+		size_t maxInFlight = 0;
+		double meanInFlight = 0;						// -Queue depth seen each time the engine was waited on
+		size_t stalls = 0;							// -Waits during which the next chunk to encrypt was not read yet
+	};
+
+	/**
+	 * @throws std::invalid_argument for a zero queue depth, a chunk smaller than one block or larger than MAX_CHUNK_BYTES
+	 */
+	explicit AsyncFileEncryptor(const CipherFortis::Cipher& cipher);
+	AsyncFileEncryptor(const CipherFortis::Cipher& cipher, const Config& config);
+
+	/**
+	 * @throws std::invalid_argument if the input size is not a multiple of 16 bytes; runtime_error on I/O failures.
+	 */
+	Stats encrypt_file(const std::filesystem::path& input_path, const std::filesystem::path& output_path) const;
+	Stats decrypt_file(const std::filesystem::path& input_path, const std::filesystem::path& output_path) const;
+
+	const Config& get_config() const;
+
+private:
+	CipherFortis::Cipher cipher;
+	Config config;
+
+	Stats process(const std::filesystem::path& input_path, const std::filesystem::path& output_path, bool decrypt) const;
+};
+
+} //namespace File
+
+#endif // ASYNC_FILE_ENCRYPTOR_HPP
@@ -5,6 +5,8 @@
 
 #include "raster_image.hpp"
 
+class Encryptor;
+
 namespace File {
 
 class Bitmap;									// -Forward declaration. Intention is to use Bitmap name in output stream function
@@ -23,12 +25,46 @@ public:
 		uint8_t blue;
 	};
 
+	/**
+	 * @brief Where the pixels of an uncompressed 24 or 32-bit BMP sit in the file.
+	 */
+	struct PixelLayout {
+		size_t offset = 0;							// -bfOffBits: start of the pixel array
+		size_t width = 0;
+		size_t height = 0;
+		size_t bytesPerPixel = 0;						// -3 or 4
+		size_t stride = 0;							// -Bytes per stored row, padded to a multiple of 4
+		bool bottomUp = true;							// -Positive biHeight: last row first
+	};
+
 public:
 	explicit Bitmap(const std::filesystem::path& path);
 	Bitmap(const Bitmap& bmp);
 
 	void save(const std::filesystem::path& output_path = "") const override;
 
+	/**
+	 * @brief Parses BITMAPFILEHEADER and BITMAPINFOHEADER of 'path'.
+	 * @return false unless the file is an uncompressed (BI_RGB) 24 or 32-bit BMP whose pixel array fits in the file.
+	 */
+	static bool native_layout(const std::filesystem::path& path, PixelLayout& layout);
+
+	/**
+	 * @brief Encrypts the pixels of the file straight into 'output_path' without decoding or re-encoding the image.
+	 * Headers, row padding and any trailing data are copied verbatim; only the pixel bytes change. Pixels are
+	 * encrypted in the order load() presents them (top-down rows, RGB), so the result decodes to the same pixels as
+	 * load(), apply_encryption() and save() produce, and either path decrypts the other's output (for 32-bit images,
+	 * as long as the alpha channel is not all zero, which stb replaces with opaque alpha). 'output_path' may be the
+	 * file itself, which is then encrypted in place. Does not need load().
+	 * @throws std::invalid_argument if native_layout() rejects the file; runtime_error on I/O failures.
+	 */
+	void encrypt_native_to(const Encryptor& algorithm, const std::filesystem::path& output_path) const;
+
+	/**
+	 * @brief Decryption counterpart of encrypt_native_to().
+	 */
+	void decrypt_native_to(const Encryptor& algorithm, const std::filesystem::path& output_path) const;
+
 	Bitmap& operator = (const Bitmap& bmp);
 	friend std::ostream& operator << (std::ostream& st, const Bitmap& bmp);
 
@@ -39,6 +75,7 @@ public:
 	size_t dataSize() const { return this->data.size(); }
 private:
 	uint8_t getPixelComponentValue(size_t i, size_t j, RGB c) const;
+	void process_native(const Encryptor& algorithm, const std::filesystem::path& output_path, bool decrypt) const;
 };
 
 } // namespace File
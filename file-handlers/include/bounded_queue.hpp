@@ -0,0 +1,107 @@
+#ifndef BOUNDED_QUEUE_HPP
+#define BOUNDED_QUEUE_HPP
+
+#include<atomic>
+#include<cstddef>
+#include<cstdint>
+#include<memory>
+#include<stdexcept>
+
+namespace File {
+
+/**
+ * @class BoundedQueue
+ * @brief Lock-free bounded multi-producer multi-consumer ring (D. Vyukov's sequence-number design).
+ *
+ * Every cell carries a sequence number telling producers and consumers whose turn it is, so a push or pop is one
+ * compare-and-swap on a shared index plus one store to the cell. try_push() fails when the ring is full and try_pop()
+ * when it is empty; callers decide how to wait, which is where back-pressure comes from. Also correct, and cheaper in
+ * practice, with a single producer and a single consumer.
+ */
+template<typename T>
+class BoundedQueue {
+public:
+	/**
+	 * @param capacity Rounded up to a power of two.
+	 */
+	explicit BoundedQueue(size_t capacity) {
+		if(capacity == 0) throw std::invalid_argument("In constructor BoundedQueue::BoundedQueue(size_t): capacity cannot be zero");
+		size_t rounded = 1;
+		while(rounded < capacity) rounded <<= 1;
+		this->mask_ = rounded - 1;
+		this->cells_.reset(new Cell[rounded]);
+		for(size_t i = 0; i < rounded; i++) this->cells_[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	BoundedQueue(const BoundedQueue&) = delete;
+	BoundedQueue& operator = (const BoundedQueue&) = delete;
+
+	bool try_push(const T& value) {
+		size_t pos = this->tail_.load(std::memory_order_relaxed);
+		for(;;) {
+			Cell& cell = this->cells_[pos & this->mask_];
+			size_t seq = cell.sequence.load(std::memory_order_acquire);
+			intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+			if(diff == 0) {
+				if(this->tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					cell.value = value;
+					cell.sequence.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			} else if(diff < 0) {
+				return false;						// -Full
+			} else {
+				pos = this->tail_.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	bool try_pop(T& value) {
+		size_t pos = this->head_.load(std::memory_order_relaxed);
+		for(;;) {
+			Cell& cell = this->cells_[pos & this->mask_];
+			size_t seq = cell.sequence.load(std::memory_order_acquire);
+			intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+			if(diff == 0) {
+				if(this->head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					value = cell.value;
+					cell.sequence.store(pos + this->mask_ + 1, std::memory_order_release);
+					return true;
+				}
+			} else if(diff < 0) {
+				return false;						// -Empty
+			} else {
+				pos = this->head_.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	/**
+	 * @brief Number of elements at some recent instant; exact only when no other thread is active.
+	 */
+	size_t size_approx() const {
+		size_t tail = this->tail_.load(std::memory_order_relaxed);
+		size_t head = this->head_.load(std::memory_order_relaxed);
+		return tail > head ? tail - head : 0;
+	}
+
+	size_t capacity() const {
+		return this->mask_ + 1;
+	}
+
+private:
+	struct Cell {
+		std::atomic<size_t> sequence;
+		T value;
+	};
+	static constexpr size_t CACHE_LINE = 64;
+
+	std::unique_ptr<Cell[]> cells_;
+	size_t mask_ = 0;
+	alignas(CACHE_LINE) std::atomic<size_t> tail_{0};				// -Producers and consumers on separate lines
+	alignas(CACHE_LINE) std::atomic<size_t> head_{0};
+};
+
+} //namespace File
+
+#endif // BOUNDED_QUEUE_HPP
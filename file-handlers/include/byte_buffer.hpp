@@ -0,0 +1,160 @@
+#ifndef BYTE_BUFFER_HPP
+#define BYTE_BUFFER_HPP
+
+#include<cstddef>
+#include<cstdint>
+#include<mutex>
+#include<unordered_map>
+#include<vector>
+
+namespace File {
+
+/**
+ * @class BufferPool
+ * @brief Process-wide cache of aligned allocations, grouped by size class.
+ *
+ * Requests are rounded up to a size class (powers of two up to one page, then four classes per doubling, so at most
+ * 25% is wasted) and served from the blocks released earlier for that class. A batch of similar files therefore reuses
+ * the same few buffers instead of faulting in and freeing fresh memory for every file. Blocks of one page or more are
+ * page aligned, smaller ones cache-line aligned; blocks of HUGE_PAGE bytes or more are aligned to, and advised for,
+ * transparent huge pages. Thread safe.
+ */
+class BufferPool {
+public:
+	static constexpr size_t CACHE_LINE = 64;
+	static constexpr size_t PAGE = 4096;
+	static constexpr size_t HUGE_PAGE = 2*1024*1024;
+
+	struct Config {
+		size_t maxCachedBytes = 512*1024*1024;					// -Released blocks beyond this are freed
+		bool hugePages = true;
+	};
+
+	struct Stats {
+		size_t hits = 0;							// -Requests served from the cache
+		size_t misses = 0;							// -Requests that allocated
+		size_t cachedBytes = 0;
+	};
+
+	BufferPool();
+	explicit BufferPool(const Config& config);
+	~BufferPool();
+
+	BufferPool(const BufferPool&) = delete;
+	BufferPool& operator = (const BufferPool&) = delete;
+
+	/**
+	 * @brief Returns a block of at least 'size' bytes, whose real capacity is written to 'capacity'. Content is
+	 * indeterminate.
+	 * @throws std::bad_alloc
+	 */
+	uint8_t* acquire(size_t size, size_t& capacity);
+
+	/**
+	 * @brief Gives back a block obtained from acquire() with the capacity acquire() reported.
+	 */
+	void release(uint8_t* block, size_t capacity) noexcept;
+
+	/**
+	 * @brief Frees every cached block.
+	 */
+	void trim() noexcept;
+
+	Stats stats() const;
+
+	static size_t size_class(size_t size);
+
+	static BufferPool& shared();
+
+private:
+	Config config;
+	mutable std::mutex mutex;
+	std::unordered_map<size_t, std::vector<uint8_t*>> cache;			// -Size class -> free blocks
+	Stats counters;
+
+	uint8_t* allocate(size_t capacity) const;
+};
+
+/**
+ * @class ByteBuffer
+ * @brief Contiguous byte container backed by BufferPool, used for FileBase content.
+ *
+ * Unlike std::vector<uint8_t>, growing the buffer leaves the new bytes uninitialized: load() reads straight into
+ * memory nobody zeroed first. The usual container interface (data, size, resize, iterators, indexing) is provided and
+ * the buffer compares equal to std::vector<uint8_t>; to_vector() makes a copy as one. A buffer may also adopt memory allocated
+ * elsewhere (a decoder's output, for instance) together with the function that frees it.
+ */
+class ByteBuffer {
+public:
+	using value_type = uint8_t;
+	using size_type = size_t;
+	using iterator = uint8_t*;
+	using const_iterator = const uint8_t*;
+
+	ByteBuffer() noexcept;
+	/**
+	 * @brief Buffer of 'size' uninitialized bytes.
+	 */
+	explicit ByteBuffer(size_t size, BufferPool& pool = BufferPool::shared());
+	ByteBuffer(const uint8_t* first, const uint8_t* last, BufferPool& pool = BufferPool::shared());
+	explicit ByteBuffer(const std::vector<uint8_t>& bytes);
+	ByteBuffer(const ByteBuffer& other);
+	ByteBuffer(ByteBuffer&& other) noexcept;
+	ByteBuffer& operator = (const ByteBuffer& other);
+	ByteBuffer& operator = (ByteBuffer&& other) noexcept;
+	~ByteBuffer();
+
+	/**
+	 * @brief Changes the size keeping the first min(size(), size) bytes; bytes past the old size are uninitialized.
+	 */
+	void resize(size_t size);
+	void reserve(size_t capacity);
+	void assign(const uint8_t* first, const uint8_t* last);
+	/**
+	 * @brief Sets the size to zero, keeping the memory for reuse.
+	 */
+	void clear() noexcept;
+	/**
+	 * @brief Empties the buffer and returns its memory to the pool.
+	 */
+	void reset() noexcept;
+	/**
+	 * @brief Takes ownership of 'size' bytes at 'block', released with 'release' once the buffer no longer needs
+	 * them. No copy is made; growing past 'size' later moves the content to pooled memory.
+	 */
+	void adopt(uint8_t* block, size_t size, void (*release)(void*)) noexcept;
+
+	uint8_t* data() noexcept { return this->data_; }
+	const uint8_t* data() const noexcept { return this->data_; }
+	size_t size() const noexcept { return this->size_; }
+	size_t capacity() const noexcept { return this->capacity_; }
+	bool empty() const noexcept { return this->size_ == 0; }
+
+	uint8_t& operator [] (size_t i) noexcept { return this->data_[i]; }
+	const uint8_t& operator [] (size_t i) const noexcept { return this->data_[i]; }
+
+	iterator begin() noexcept { return this->data_; }
+	iterator end() noexcept { return this->data_ + this->size_; }
+	const_iterator begin() const noexcept { return this->data_; }
+	const_iterator end() const noexcept { return this->data_ + this->size_; }
+
+	std::vector<uint8_t> to_vector() const { return std::vector<uint8_t>(this->begin(), this->end()); }
+
+	friend bool operator == (const ByteBuffer& a, const ByteBuffer& b);
+	friend bool operator == (const ByteBuffer& a, const std::vector<uint8_t>& b);
+	friend bool operator == (const std::vector<uint8_t>& a, const ByteBuffer& b) { return b == a; }
+	friend bool operator != (const ByteBuffer& a, const ByteBuffer& b) { return !(a == b); }
+	friend bool operator != (const ByteBuffer& a, const std::vector<uint8_t>& b) { return !(a == b); }
+	friend bool operator != (const std::vector<uint8_t>& a, const ByteBuffer& b) { return !(b == a); }
+
+private:
+	uint8_t* data_ = nullptr;
+	size_t size_ = 0;
+	size_t capacity_ = 0;
+	BufferPool* pool_ = nullptr;
+	void (*release_)(void*) = nullptr;						// -Set for adopted memory
+};
+
+} //namespace File
+
+#endif // BYTE_BUFFER_HPP
@@ -0,0 +1,51 @@
+#ifndef CHUNKED_FILE_ENCRYPTOR_HPP
+#define CHUNKED_FILE_ENCRYPTOR_HPP
+
+#include<filesystem>
+#include"../../core-crypto/include/cipher.hpp"
+
+namespace File {
+
+/**
+ * @class ChunkedFileEncryptor
+ * @brief Encrypts or decrypts files of any size with memory bounded by one chunk.
+ *
+ * The input is read in fixed-size chunks, each chunk is transformed in place carrying the chaining value of the mode
+ * into the next one (Cipher::encryptSegment()), and written sequentially. The result is byte-identical to loading the
+ * whole file and calling Cipher::encrypt() once. The kernel is told to read ahead and to drop pages already processed,
+ * so the page cache does not grow with the file either.
+ *
+ * When input and output are the same file it is rewritten in place.
+ */
+class ChunkedFileEncryptor {
+public:
+	struct Config {
+		size_t chunkBytes = 4*1024*1024;					// -Rounded down to a multiple of 16 bytes
+		bool dropBehind = true;							// -Evict processed pages from the page cache
+	};
+
+	/**
+	 * @throws std::invalid_argument if the chunk size is smaller than one block
+	 */
+	explicit ChunkedFileEncryptor(const CipherFortis::Cipher& cipher);
+	ChunkedFileEncryptor(const CipherFortis::Cipher& cipher, const Config& config);
+
+	/**
+	 * @throws std::invalid_argument if the input size is not a multiple of 16 bytes (there is no padding);
+	 * runtime_error on I/O failures; the errors of Cipher::encrypt().
+	 */
+	void encrypt_file(const std::filesystem::path& input_path, const std::filesystem::path& output_path) const;
+	void decrypt_file(const std::filesystem::path& input_path, const std::filesystem::path& output_path) const;
+
+	size_t get_chunk_size() const;
+
+private:
+	CipherFortis::Cipher cipher;
+	Config config;
+
+	void process(const std::filesystem::path& input_path, const std::filesystem::path& output_path, bool decrypt) const;
+};
+
+} //namespace File
+
+#endif // CHUNKED_FILE_ENCRYPTOR_HPP
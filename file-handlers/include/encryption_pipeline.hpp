@@ -0,0 +1,98 @@
+#ifndef ENCRYPTION_PIPELINE_HPP
+#define ENCRYPTION_PIPELINE_HPP
+
+#include<atomic>
+#include<filesystem>
+#include<memory>
+#include<mutex>
+#include"../../core-crypto/include/cipher.hpp"
+
+namespace File {
+
+/**
+ * @class EncryptionPipeline
+ * @brief Three-stage file encryption: one reader thread, N cipher workers, one writer thread.
+ *
+ * The reader slices the input into chunks held in a recycled pool of buffers, the workers transform chunks in
+ * parallel and the writer puts them back in file order. Stages are connected by lock-free bounded rings
+ * (BoundedQueue); a stage finding its output ring full, or no free buffer, waits, which throttles the faster stages to
+ * the slowest one while memory stays at 'buffers' chunks.
+ *
+ * Chunks can be transformed independently in ECB, CTR and CBC decryption: the reader hands every chunk its own
+ * starting chaining value (advanced counter, or last ciphertext block of the previous chunk). CBC encryption and OFB
+ * are inherently sequential and run with a single worker. Output is byte-identical to Cipher::encrypt() / decrypt()
+ * over the whole file.
+ */
+class EncryptionPipeline {
+public:
+	struct Config {
+		size_t chunkBytes = 1024*1024;						// -Rounded down to a multiple of 16
+		size_t workers = 0;							// -Zero selects std::thread::hardware_concurrency()
+		size_t buffers = 0;							// -Chunks in circulation. Zero selects 2*workers + 2
+	};
+
+	/**
+	 * @brief Activity of one ring. Counters are updated while the pipeline runs and may be read from any thread.
+	 */
+	struct QueueCounters {
+		size_t pushed = 0;
+		size_t fullWaits = 0;							// -Producer found the ring full (back-pressure)
+		size_t emptyWaits = 0;							// -Consumer found the ring empty (starved stage)
+		size_t maxOccupancy = 0;
+	};
+
+	struct Stats {
+		size_t workers = 0;							// -Workers actually used (1 for sequential modes)
+		size_t chunks = 0;
+		QueueCounters freeBuffers;						// -Writer -> reader
+		QueueCounters work;							// -Reader -> workers
+		QueueCounters done;							// -Workers -> writer
+	};
+
+	/**
+	 * @throws std::invalid_argument if the chunk is smaller than one block
+	 */
+	explicit EncryptionPipeline(const CipherFortis::Cipher& cipher);
+	EncryptionPipeline(const CipherFortis::Cipher& cipher, const Config& config);
+
+	/**
+	 * @brief Runs the pipeline to completion and returns the counters of this run. Input and output may be the same
+	 * file. Concurrent calls on one pipeline are allowed; each run keeps its own counters.
+	 * @throws std::invalid_argument if the input size is not a multiple of 16 bytes; runtime_error on I/O failures;
+	 * the first error raised by any stage otherwise.
+	 */
+	Stats encrypt_file(const std::filesystem::path& input_path, const std::filesystem::path& output_path) const;
+	Stats decrypt_file(const std::filesystem::path& input_path, const std::filesystem::path& output_path) const;
+
+	/**
+	 * @brief Snapshot of the counters of the most recently started run, in progress or finished. All zero before
+	 * the first run.
+	 */
+	Stats get_live_stats() const;
+
+	const Config& get_config() const;
+
+private:
+	struct Counters {
+		std::atomic<size_t> pushed{0}, fullWaits{0}, emptyWaits{0}, maxOccupancy{0};
+		QueueCounters snapshot() const;
+	};
+
+	// Counters of one process() call, shared with get_live_stats() while it is the latest run.
+	struct Run {
+		Counters freeCounters, workCounters, doneCounters;
+		size_t workers = 0, chunks = 0;
+		Stats snapshot() const;
+	};
+
+	CipherFortis::Cipher cipher;
+	Config config;
+	mutable std::mutex liveMutex;
+	mutable std::shared_ptr<const Run> live;
+
+	Stats process(const std::filesystem::path& input_path, const std::filesystem::path& output_path, bool decrypt) const;
+};
+
+} //namespace File
+
+#endif // ENCRYPTION_PIPELINE_HPP
@@ -3,6 +3,8 @@
 
 #include<vector>
 #include<filesystem> // For path handling
+#include"byte_buffer.hpp"
+#include"mapped_file.hpp"
 
 // Forward declaration of the Encryptor interface.
 class Encryptor;
@@ -20,11 +22,23 @@ namespace File {
  * file data. It uses modern C++ idioms like RAII to ensure memory safety.
  */
 class FileBase {
+public:
+	/**
+	 * @brief Where FileBase::load() puts the file content.
+	 */
+	enum struct Storage {
+		Buffered,						// -Read into the 'data' buffer
+		MappedPrivate,						// -Copy-on-write mapping; encryption never touches the file until save()
+		MappedShared						// -Shared mapping; encryption rewrites the file in place
+	};
+
 protected:
 	// Using std::filesystem::path is best practice for handling file paths.
 	// It correctly handles different OS path separators ('/' vs '\').
 	std::filesystem::path file_path;
-	std::vector<uint8_t> data;
+	ByteBuffer data;							// -Pooled and aligned; never zero-filled before a read
+	Storage storage = Storage::Buffered;
+	MappedFile mapping;							// -Content when storage is not Buffered
 
 public:
 	/**
@@ -33,11 +47,29 @@ public:
 	*/
 	explicit FileBase(const std::filesystem::path& path);
 
+	/**
+	* @brief Constructs a FileBase object whose load() uses the given storage.
+	* Mapped storage applies to FileBase::load(); derived classes that decode the file keep their decoded buffer.
+	*/
+	FileBase(const std::filesystem::path& path, Storage storage);
+
 	// Virtual destructor is crucial for a base class.
 	// It ensures that when you delete a derived class through a base class
 	// pointer, the derived class's destructor is called first.
 	virtual ~FileBase() = default;
 
+	/**
+	* @brief Copies the content. A copy of mapped content is Buffered: mappings are never shared between objects.
+	*/
+	FileBase(const FileBase& other);
+	FileBase& operator=(const FileBase& other);
+
+	/**
+	* @brief Takes over the content, buffer or mapping alike; 'other' is left empty and Buffered.
+	*/
+	FileBase(FileBase&& other) noexcept;
+	FileBase& operator=(FileBase&& other) noexcept;
+
 	// --- Core Public Interface ---
 
 	/**
@@ -58,7 +90,9 @@ public:
 	/**
 	* @brief Applies an encryption algorithm to the file's data.
 	* @param algorithm An object that conforms to the Encryptor interface.
-	* * This method modifies the internal data buffer.
+	* * This method modifies the internal data buffer. Content is encrypted in place through Encryptor::encryptBytes();
+	* an algorithm whose output length differs (preservesLength() false, e.g. a padding mode) goes through
+	* Encryptor::encryption() instead, and the result replaces the content as a Buffered buffer of the new length.
 	* @throws Throws exceptions if encryption fails
 	*/
 	void apply_encryption(const Encryptor& algorithm);
@@ -71,17 +105,52 @@ public:
 	*/
 	void apply_decryption(const Encryptor& algorithm);
 
+	/**
+	* @brief Encrypts the content into a new file at 'output_path', leaving the loaded content untouched.
+	* The output file is memory mapped and written by the Encryptor directly, so no intermediate buffer is used
+	* (except for algorithms that change the length, as in apply_encryption()).
+	* @throws std::invalid_argument if 'output_path' is the loaded file; runtime_error if the output cannot be mapped.
+	*/
+	void encrypt_to(const Encryptor& algorithm, const std::filesystem::path& output_path) const;
+
+	/**
+	* @brief Decryption counterpart of encrypt_to().
+	*/
+	void decrypt_to(const Encryptor& algorithm, const std::filesystem::path& output_path) const;
+
 	/**
 	* @brief Calculates various randomness statistics on the current data buffer.
+	* @param threads Workers for the sweep. Zero: ThreadPool::shared(). One: serial. The results do not depend on it.
 	* @return A DataRandomness struct containing the results.
 	*/
-	DataRandomness calculate_randomness() const;
+	DataRandomness calculate_randomness(size_t threads = 0) const;
+
+	/**
+	* @brief apply_encryption() that also measures the ciphertext, piece by piece as the algorithm writes it
+	* (Encryptor::encryptBytesObserved), instead of reading the whole buffer again afterwards.
+	* @return The same metrics calculate_randomness() gives after apply_encryption().
+	* @throws Throws exceptions if encryption fails
+	*/
+	DataRandomness encrypt_and_measure(const Encryptor& algorithm);
 
 	// --- Accessors (Getters) ---
 
 	const std::filesystem::path& get_path() const;
-	const std::vector<uint8_t>& get_data() const;
+	/**
+	* @brief Loaded content; compares equal to std::vector<uint8_t>, and get_data().to_vector() copies it into one.
+	* @throws std::logic_error with mapped storage; use get_bytes() there.
+	*/
+	const ByteBuffer& get_data() const;
+	/**
+	* @brief Pointer to the content, valid for every storage.
+	*/
+	const uint8_t* get_bytes() const;
 	size_t get_size() const;
+	Storage get_storage() const;
+
+private:
+	std::vector<uint8_t> transformed(const Encryptor& algorithm, bool decrypt) const;
+	void replace_content(const std::vector<uint8_t>& bytes);
 };
 
 } //namespace File
@@ -0,0 +1,80 @@
+#ifndef IO_ENGINE_HPP
+#define IO_ENGINE_HPP
+
+#include<cstddef>
+#include<cstdint>
+#include<memory>
+#include<sys/types.h>
+#include<vector>
+
+namespace File {
+
+/**
+ * @class IOEngine
+ * @brief Asynchronous positional read/write queue used by the asynchronous file encryptor.
+ *
+ * Requests are submitted with a caller-chosen tag and complete in any order. Two implementations exist: Linux
+ * io_uring (raw system calls, fixed buffers registered with the kernel) and a thread-pool engine issuing blocking
+ * pread/pwrite, used wherever io_uring is not available.
+ */
+class IOEngine {
+public:
+	enum struct Backend { Auto, IoUring, ThreadPool };
+
+	struct Request {
+		int fd;
+		uint8_t* buffer;
+		size_t size;
+		off_t offset;
+		bool write;
+		uint64_t tag;
+		int bufferIndex;						// -Index in the registered buffers, -1 if not registered
+	};
+
+	struct Completion {
+		uint64_t tag;
+		ssize_t result;							// -Bytes transferred, or -errno
+	};
+
+	virtual ~IOEngine() = default;
+
+	/**
+	 * @brief Registers the buffers later requests point into. May be called once, before the first submission.
+	 */
+	virtual void register_buffers(const std::vector<std::pair<uint8_t*, size_t>>& buffers) = 0;
+
+	/**
+	 * @brief Queues a request; it may not start before the next wait().
+	 * @throws std::runtime_error if the request cannot be queued
+	 */
+	virtual void submit(const Request& request) = 0;
+
+	/**
+	 * @brief Starts every queued request and blocks until at least one completes.
+	 * @throws std::logic_error if nothing is in flight
+	 */
+	virtual Completion wait() = 0;
+
+	/**
+	 * @brief Requests submitted and not yet returned by wait().
+	 */
+	virtual size_t in_flight() const = 0;
+
+	virtual Backend backend() const = 0;
+
+	/**
+	 * @brief Builds an engine able to keep 'queueDepth' requests in flight. Auto selects io_uring when the kernel
+	 * allows it and the thread pool otherwise.
+	 * @throws std::runtime_error if IoUring is requested explicitly and is not available
+	 */
+	static std::unique_ptr<IOEngine> create(Backend backend, size_t queueDepth);
+
+	/**
+	 * @brief True if io_uring was compiled in and the running kernel accepts io_uring_setup().
+	 */
+	static bool io_uring_available();
+};
+
+} //namespace File
+
+#endif // IO_ENGINE_HPP
@@ -0,0 +1,129 @@
+#ifndef JPEG_COEFFICIENTS_HPP
+#define JPEG_COEFFICIENTS_HPP
+
+#include<array>
+#include<cstddef>
+#include<cstdint>
+#include<filesystem>
+#include<vector>
+
+class Encryptor;
+
+namespace File {
+
+/**
+ * @class JpegCoefficients
+ * @brief Quantized DCT coefficients of a baseline (sequential, Huffman coded, 8-bit) JPEG.
+ *
+ * Reading stops at entropy decoding: no dequantization, no IDCT, no color conversion. Every marker segment is kept
+ * verbatim and encode() entropy codes the coefficients again with the file's own Huffman tables, scan layout and
+ * restart interval, so an unmodified object encodes back to the bytes it was read from.
+ *
+ * encrypt() works in this domain. Each nonzero coefficient (and each nonzero DC difference) is coded as a Huffman
+ * symbol giving its size category s, followed by s amplitude bits that carry its sign and magnitude. Those amplitude
+ * bits are XORed with a keystream; the sign flips and the magnitude moves inside its category, so every Huffman symbol
+ * stays the same. The result decodes as a JPEG of the same size (give or take 0xFF stuffing bytes), and XORing again
+ * restores the original coefficients exactly.
+ */
+class JpegCoefficients {
+public:
+	struct Component {
+		uint8_t id = 0;
+		uint8_t h = 1;								// -Horizontal sampling factor
+		uint8_t v = 1;								// -Vertical sampling factor
+		std::array<uint16_t, 64> quantization{};				// -Zigzag order
+		size_t blocksPerLine = 0;
+		size_t blocksPerColumn = 0;
+		std::vector<int16_t> coefficients;					// -64 per block, zigzag order, DC not differenced
+
+		int16_t* block(size_t row, size_t column) { return this->coefficients.data() + (row * this->blocksPerLine + column) * 64; }
+		const int16_t* block(size_t row, size_t column) const { return this->coefficients.data() + (row * this->blocksPerLine + column) * 64; }
+	};
+
+	/**
+	 * @brief Reads and entropy decodes 'path'.
+	 * @throws std::invalid_argument if the file is not a baseline JPEG; runtime_error if it cannot be read.
+	 */
+	explicit JpegCoefficients(const std::filesystem::path& path);
+	JpegCoefficients(const uint8_t* data, size_t size);
+
+	int width() const { return this->width_; }
+	int height() const { return this->height_; }
+	const std::vector<Component>& components() const { return this->components_; }
+	std::vector<Component>& components() { return this->components_; }
+
+	/**
+	 * @brief The JPEG file: original marker segments around freshly entropy coded scans.
+	 * @throws std::runtime_error if a coefficient needs a Huffman symbol the file's tables do not define.
+	 */
+	std::vector<uint8_t> encode() const;
+	void save(const std::filesystem::path& path) const;
+
+	/**
+	 * @brief XORs the amplitude bits of the coefficients with a keystream, in scan order.
+	 *
+	 * The keystream is the encryption of zero bytes by 'algorithm', so decrypt() calls the encryption side too and the
+	 * mode must not be ECB (its keystream would repeat every block). A DC difference is left alone when encrypting it
+	 * could take the DC value out of the range decoders accept (its product with the quantizer must fit in 16 bits);
+	 * that test only reads values both directions know, so decryption makes the same choice.
+	 * @throws std::invalid_argument if the keystream repeats (ECB), plus the errors of Encryptor::encryptBytes.
+	 */
+	void encrypt(const Encryptor& algorithm);
+	void decrypt(const Encryptor& algorithm);
+
+	/**
+	 * @brief True if 'path' parses as a JPEG this class reads. Reads the headers only.
+	 */
+	static bool is_baseline(const std::filesystem::path& path);
+
+private:
+	struct HuffmanTable {
+		uint8_t counts[17] = {};						// -Number of codes of each length 1..16
+		std::vector<uint8_t> symbols;
+		int32_t maxCode[18] = {};						// -Decoding, per code length
+		int32_t firstCode[17] = {};
+		int32_t firstSymbol[17] = {};
+		uint16_t lookup[512] = {};						// -9-bit prefix -> length << 8 | symbol, 0 if longer
+		uint16_t code[256] = {};						// -Encoding, per symbol
+		uint8_t length[256] = {};						// -0 for symbols without a code
+
+		void build();
+	};
+	struct ScanComponent {
+		size_t component;
+		size_t dcTable;								// -Index in tables
+		size_t acTable;
+	};
+	struct Scan {
+		std::vector<ScanComponent> components;
+		size_t restartInterval = 0;						// -MCUs between restart markers, 0 for none
+	};
+	struct Segment {
+		std::vector<uint8_t> bytes;						// -Marker segments, copied verbatim
+		int scan = -1;								// -Scan whose entropy coded data follows, if any
+	};
+
+	int width_ = 0;
+	int height_ = 0;
+	std::vector<Component> components_;
+	std::vector<HuffmanTable> tables;
+	std::vector<Scan> scans;
+	std::vector<Segment> segments;
+
+	JpegCoefficients() = default;
+
+	void parse(const uint8_t* data, size_t size, bool headersOnly);
+	/*
+	 * Visits the blocks of 'scan' in coding order: onBlock(scan component, component, block index), and onRestart()
+	 * before each MCU that follows a restart marker.
+	 * */
+	template<typename OnBlock, typename OnRestart>
+	void traverse(const Scan& scan, OnBlock onBlock, OnRestart onRestart) const;
+	void decode_scan(const Scan& scan, const uint8_t* begin, const uint8_t* end);
+	void encode_scan(const Scan& scan, std::vector<uint8_t>& out) const;
+	void apply_keystream(const Encryptor& algorithm, bool decrypt);
+};
+
+} //namespace File
+
+#endif // JPEG_COEFFICIENTS_HPP
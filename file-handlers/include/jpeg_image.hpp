@@ -3,6 +3,8 @@
 
 #include "raster_image.hpp"
 
+class Encryptor;
+
 namespace File {
 
 class JPEG : public RasterImage {
@@ -10,6 +12,25 @@ public:
     explicit JPEG(const std::filesystem::path& path, int quality = 90);
     void save(const std::filesystem::path& output_path = "") const override;
 
+    /**
+     * @brief True if 'path' is a baseline JPEG, which the *_native_to() functions can process.
+     */
+    static bool native_supported(const std::filesystem::path& path);
+
+    /**
+     * @brief Encrypts the file in the DCT coefficient domain into 'output_path' (see JpegCoefficients::encrypt):
+     * no IDCT, no re-quantization, and the output is a JPEG of about the original size that decrypts back to the
+     * original bytes. Does not need load(). 'output_path' may be the file itself.
+     * @throws std::invalid_argument if the file is not a baseline JPEG or the mode is ECB; runtime_error on I/O
+     * failures.
+     */
+    void encrypt_native_to(const Encryptor& algorithm, const std::filesystem::path& output_path) const;
+
+    /**
+     * @brief Decryption counterpart of encrypt_native_to().
+     */
+    void decrypt_native_to(const Encryptor& algorithm, const std::filesystem::path& output_path) const;
+
 private:
     int quality_;
 };
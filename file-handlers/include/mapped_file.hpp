@@ -0,0 +1,74 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include<cstddef>
+#include<cstdint>
+#include<filesystem>
+
+namespace File {
+
+/**
+ * @class MappedFile
+ * @brief RAII owner of a memory mapping of a whole file.
+ *
+ * Mappings are advised for sequential access (and transparent huge pages where the kernel supports them for the
+ * file), which suits a single encryption pass. An empty file yields an open mapping with data() == nullptr.
+ */
+class MappedFile {
+public:
+	enum struct Access {
+		ReadOnly,							// -PROT_READ
+		Private,							// -Copy-on-write: changes never reach the file
+		Shared								// -Changes are written back to the file
+	};
+
+	MappedFile() = default;
+
+	/**
+	 * @brief Maps an existing file.
+	 * @throws std::runtime_error if the file cannot be opened or mapped
+	 */
+	MappedFile(const std::filesystem::path& path, Access access);
+
+	/**
+	 * @brief Creates (or truncates) 'path' with 'size' bytes and maps it shared, ready to be written.
+	 * @throws std::runtime_error if the file cannot be created, resized or mapped
+	 */
+	static MappedFile create(const std::filesystem::path& path, size_t size);
+
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator = (MappedFile&& other) noexcept;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator = (const MappedFile&) = delete;
+
+	~MappedFile();
+
+	uint8_t* data();
+	const uint8_t* data() const;
+	size_t size() const;
+	bool is_open() const;
+	Access access() const;
+
+	/**
+	 * @brief Flushes a shared mapping to the file (msync). No effect on other mappings.
+	 * @throws std::runtime_error if msync fails
+	 */
+	void sync() const;
+
+	/**
+	 * @brief Unmaps and closes. Safe to call more than once.
+	 */
+	void close();
+
+private:
+	int fd_ = -1;
+	uint8_t* data_ = nullptr;
+	size_t size_ = 0;
+	Access access_ = Access::ReadOnly;
+
+	void map(const std::filesystem::path& path);
+};
+
+} //namespace File
+
+#endif // MAPPED_FILE_HPP
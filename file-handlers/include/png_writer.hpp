@@ -0,0 +1,111 @@
+#ifndef PNG_WRITER_HPP
+#define PNG_WRITER_HPP
+
+#include<cstddef>
+#include<cstdint>
+#include<filesystem>
+#include<memory>
+
+namespace File {
+
+/**
+ * @brief How PngWriter encodes the image data (the zlib stream inside IDAT).
+ */
+enum struct PngCompression {
+	Auto,									// -Stored for data that looks random (ciphertext), Deflate otherwise
+	Stored,									// -Filter type 0 and stored deflate blocks: no filtering, no compression
+	Deflate									// -Filtered and compressed
+};
+
+/**
+ * @brief CRC-32 (ISO 3309, as used by PNG chunks) using slicing-by-8. Pass the previous result to continue a
+ * running checksum.
+ */
+uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0);
+
+/**
+ * @brief Adler-32 (RFC 1950, as used by zlib streams). Pass the previous result to continue a running checksum.
+ */
+uint32_t adler32(const uint8_t* data, size_t size, uint32_t adler = 1);
+
+/**
+ * @brief Adler-32 of the concatenation of two byte ranges, from their checksums and the length of the second one.
+ */
+uint32_t adler32_combine(uint32_t adler1, uint32_t adler2, size_t size2);
+
+/**
+ * @class PngWriter
+ * @brief Writes 8-bit grey, grey+alpha, RGB or RGBA images as PNG files.
+ *
+ * Encrypted pixels are statistically random: filtering and deflating them costs CPU and gains nothing. In Stored
+ * mode every row gets filter type 0 and the zlib stream is made of stored (BTYPE=00) blocks, so encoding is a copy
+ * plus checksums. Deflate mode filters and compresses as usual; images of at least 'parallelThreshold' bytes are
+ * split into bands of rows that worker threads filter and compress independently (sync-flushed deflate pieces,
+ * concatenated as pigz does), written as one IDAT chunk per band of a single zlib stream. Smaller images go through
+ * PngStreamWriter.
+ */
+class PngWriter {
+public:
+	struct Options {
+		PngCompression compression = PngCompression::Auto;
+		size_t threads = 0;							// -Deflate workers. Zero: ThreadPool::shared(). One: serial
+		size_t parallelThreshold = 8*1024*1024;					// -Pixel bytes from which Deflate runs in bands
+	};
+
+	/**
+	 * @brief Writes 'pixels' (top-down rows of width*channels bytes, no padding) to 'path'.
+	 * @throws std::invalid_argument on bad dimensions; runtime_error if the file cannot be written.
+	 */
+	static void write(const std::filesystem::path& path, const uint8_t* pixels, int width, int height, int channels);
+	static void write(const std::filesystem::path& path, const uint8_t* pixels, int width, int height, int channels,
+	                  const Options& options);
+
+	/**
+	 * @brief Compression that Auto resolves to for these bytes: Stored when a sample of them has near-maximal entropy.
+	 */
+	static PngCompression choose(const uint8_t* pixels, size_t size);
+};
+
+/**
+ * @class PngStreamWriter
+ * @brief Writes a PNG file row by row, as the rows are produced.
+ *
+ * IDAT chunks are emitted while rows arrive, so memory stays bounded by the previous row, the deflate window and a
+ * group of filtered rows waiting for compression, whatever the size of the image. Auto compression is resolved from
+ * the first batch of rows. The file is complete once finish() returns; a writer destroyed earlier leaves a truncated
+ * file behind.
+ */
+class PngStreamWriter {
+public:
+	/**
+	 * @brief Creates 'path' and writes the PNG header.
+	 * @throws std::invalid_argument on bad dimensions; runtime_error if the file cannot be created.
+	 */
+	PngStreamWriter(const std::filesystem::path& path, int width, int height, int channels,
+	                PngCompression compression = PngCompression::Auto);
+	PngStreamWriter(PngStreamWriter&&) noexcept;
+	PngStreamWriter& operator = (PngStreamWriter&&) noexcept;
+	~PngStreamWriter();
+
+	/**
+	 * @brief Appends 'count' top-down rows of width*channels bytes each.
+	 * @throws std::invalid_argument if the image would get more rows than its height.
+	 */
+	void write_rows(const uint8_t* rows, size_t count);
+
+	size_t rows_written() const;
+
+	/**
+	 * @brief Ends the image data and writes the closing chunks.
+	 * @throws std::logic_error if rows are missing; runtime_error if the file cannot be written.
+	 */
+	void finish();
+
+private:
+	struct State;
+	std::unique_ptr<State> state;							// -Null once finished
+};
+
+} //namespace File
+
+#endif // PNG_WRITER_HPP
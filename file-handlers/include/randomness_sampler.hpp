@@ -0,0 +1,75 @@
+#ifndef RANDOMNESS_SAMPLER_HPP
+#define RANDOMNESS_SAMPLER_HPP
+
+#include<cstddef>
+#include<cstdint>
+#include<filesystem>
+
+namespace File {
+
+/**
+ * @class RandomnessSampler
+ * @brief Approximate DataRandomness metrics of a file from a random sample of its blocks, for triage of large outputs.
+ *
+ * 'blocks' blocks of 'blockBytes' bytes are drawn without replacement and read with pread(), so the cost depends on
+ * the sample, not on the file. Each block is measured on its own (ByteMoments, adjacent pairs wrapping inside the
+ * block) and the estimates come from the pooled moments. Confidence intervals use the delete-one-block jackknife: the
+ * metric is recomputed with each block's moments subtracted from the pool, which needs no further reads.
+ *
+ * A sample passes when the entropy and correlation intervals lie inside their thresholds and the pooled chi-square is
+ * below its own (the threshold is already a test of the statistic at a fixed level). Otherwise, or when the sample would cover half the
+ * file anyway, the whole file is streamed through a RandomnessAccumulator and the exact values are reported, with
+ * zero-width intervals.
+ */
+class RandomnessSampler {
+public:
+	struct Config {
+		size_t blockBytes = 4096;						// -Bytes per sampled block
+		size_t blocks = 256;							// -Blocks drawn; at least 2
+		uint64_t seed = 0;							// -Zero: seeded from std::random_device
+		double z = 2.576;							// -Interval half-width in standard errors (99%)
+		double minEntropy = 7.99;						// -Thresholds a sample must clear
+		double maxChiSquare = 350.0;						// -255 degrees of freedom: P(X > 350) < 1e-4
+		double maxAbsCorrelation = 0.01;
+		bool escalate = true;							// -Full scan when a sample does not clear them
+	};
+
+	struct Estimate {
+		double value = 0.0;
+		double low = 0.0;
+		double high = 0.0;
+	};
+
+	struct Report {
+		uint64_t fileBytes = 0;
+		uint64_t bytesRead = 0;
+		bool fullScan = false;							// -Exact values
+		bool passed = false;							// -Thresholds cleared
+		Estimate entropy;
+		Estimate chiSquare;
+		Estimate correlation;							// -Adjacent bytes
+	};
+
+	/**
+	 * @throws std::invalid_argument if blockBytes is zero or fewer than two blocks are requested.
+	 */
+	RandomnessSampler();
+	explicit RandomnessSampler(const Config& config);
+
+	/**
+	 * @throws std::invalid_argument if the file is empty; runtime_error if it cannot be read.
+	 */
+	Report analyze(const std::filesystem::path& path) const;
+
+	/**
+	 * @brief The full scan analyze() escalates to: exact metrics, reading the file once in bounded memory.
+	 */
+	Report scan(const std::filesystem::path& path) const;
+
+private:
+	Config config;
+};
+
+} //namespace File
+
+#endif // RANDOMNESS_SAMPLER_HPP
@@ -2,15 +2,80 @@
 #define RASTER_IMAGE_HPP
 
 #include "file_base.hpp"
+#include "png_writer.hpp"
+#include <vector>
+
+namespace CipherFortis { class Cipher; }
+class ImageCorrelation;
 
 namespace File {
 
 class RasterImage : public FileBase {
 public:
     explicit RasterImage(const std::filesystem::path& path);
-    void load() override;  // stbi_load → this->data; frees stb buffer immediately
+    void load() override;  // stbi_load → this->data, which adopts the stb buffer (no copy)
+
+    /**
+     * @brief Encoding used when the image is saved as PNG. Auto stores ciphertext uncompressed and deflates anything
+     * else.
+     */
+    void set_png_compression(PngCompression compression) { png_compression_ = compression; }
+    PngCompression get_png_compression() const { return png_compression_; }
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    int channels() const { return channels_; }
+
+    /**
+     * @brief Encrypts the loaded pixels as independent tiles of the TileGrid(width, height, channels, tileWidth,
+     * tileHeight) layout. Tile i is gathered into a contiguous buffer and encrypted from cipher.tileChainingBlock(i),
+     * so any tile can later be decrypted on its own. Tiles are processed in parallel on ThreadPool::shared().
+     * @throws std::logic_error if nothing is loaded; invalid_argument if a nominal tile is shorter than one AES block
+     * or any tile is not a whole number of blocks (the pixels are left unchanged).
+     */
+    void apply_tiled_encryption(const CipherFortis::Cipher& cipher, size_t tileWidth, size_t tileHeight);
+    void apply_tiled_decryption(const CipherFortis::Cipher& cipher, size_t tileWidth, size_t tileHeight);
+
+    /**
+     * @brief Part of each pixel apply_selective_encryption() covers: the channels whose bit is set in 'channelMask'
+     * (bit c for channel c) and, in each of them, the 'bitPlanes' most significant bits.
+     */
+    struct Selection {
+        uint8_t channelMask = 0xFF;
+        uint8_t bitPlanes   = 8;
+    };
+
+    /**
+     * @brief Preview-grade encryption: XORs the selected bits of every pixel with a keystream, leaving the rest of the
+     * pixel in clear. The keystream is the encryption of zero bytes by 'cipher', generated for the selected bits only
+     * (packed, bitPlanes bits per selected sample), so AES work shrinks with the selection: one channel of RGB is a
+     * third of it, its top two planes a twelfth. The transform is its own inverse; apply_selective_decryption() is
+     * provided for symmetry.
+     * @throws std::logic_error if nothing is loaded; invalid_argument for ECB (its keystream repeats every block), an
+     * empty selection or more than 8 planes.
+     */
+    void apply_selective_encryption(const CipherFortis::Cipher& cipher, const Selection& selection);
+    void apply_selective_decryption(const CipherFortis::Cipher& cipher, const Selection& selection);
+
+    /**
+     * @brief Plaintext of the region (x, y, w, h) of a tiled-encrypted image, as top-down rows of w*channels bytes.
+     * Only the tiles that intersect the region are decrypted; the loaded pixels are not modified.
+     * @throws std::out_of_range if the region is empty or leaves the image, plus the errors of apply_tiled_decryption().
+     */
+    std::vector<uint8_t> decrypt_region(const CipherFortis::Cipher& cipher, size_t tileWidth, size_t tileHeight,
+                                        size_t x, size_t y, size_t w, size_t h) const;
+
+    /**
+     * @brief Horizontal, vertical and diagonal correlation of neighbouring pixels, per channel, over the loaded pixels.
+     * @param threads As in ImageCorrelation::measure(): zero for ThreadPool::shared(), one for serial.
+     * @throws std::logic_error if nothing is loaded.
+     */
+    ImageCorrelation calculate_correlation(size_t threads = 0) const;
 
 protected:
+    void write_png(const std::filesystem::path& path) const;
+
+    PngCompression png_compression_ = PngCompression::Auto;
     int width_    = 0;
     int height_   = 0;
     int channels_ = 0;
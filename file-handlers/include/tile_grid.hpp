@@ -0,0 +1,68 @@
+#ifndef TILE_GRID_HPP
+#define TILE_GRID_HPP
+
+#include<cstddef>
+#include<cstdint>
+#include<string>
+#include<vector>
+
+namespace File {
+
+/**
+ * @class TileGrid
+ * @brief Partition of an interleaved pixel buffer (top-down rows of width*channels bytes) into rectangular tiles,
+ * numbered row-major.
+ *
+ * Tiles have the nominal size except in the last column and the last row, which absorb the remainder of the image
+ * (up to twice the nominal size less one pixel), so no tile is ever smaller than the nominal one. An image smaller than
+ * one tile is a single tile.
+ */
+class TileGrid {
+public:
+	struct Rect {
+		size_t x = 0;
+		size_t y = 0;
+		size_t width = 0;
+		size_t height = 0;
+	};
+
+	/**
+	 * @throws std::invalid_argument if a dimension is zero.
+	 */
+	TileGrid(size_t imageWidth, size_t imageHeight, size_t channels, size_t tileWidth, size_t tileHeight);
+
+	size_t columns() const { return this->columns_; }
+	size_t rows() const { return this->rows_; }
+	size_t count() const { return this->columns_ * this->rows_; }
+	size_t tileWidth() const { return this->tileWidth_; }
+	size_t tileHeight() const { return this->tileHeight_; }
+
+	Rect tile(size_t index) const;
+	size_t tile_bytes(size_t index) const;
+
+	/**
+	 * @brief Indices of the tiles that overlap 'region', in increasing order. The region is clipped to the image.
+	 */
+	std::vector<size_t> intersecting(const Rect& region) const;
+
+	/**
+	 * @brief Copies the rows of tile 'index' out of 'pixels' into the contiguous buffer 'tile' (tile_bytes() bytes).
+	 */
+	void gather(size_t index, const uint8_t* pixels, uint8_t* tile) const;
+	void scatter(size_t index, const uint8_t* tile, uint8_t* pixels) const;
+
+	/**
+	 * @brief "<width>x<height>", the form image_encryptor records in its metadata; parse() reads it back.
+	 */
+	std::string to_string() const;
+	static bool parse(const std::string& text, size_t& tileWidth, size_t& tileHeight);
+
+private:
+	size_t imageWidth_, imageHeight_, channels_;
+	size_t tileWidth_, tileHeight_;
+	size_t columns_, rows_;
+};
+
+} //namespace File
+
+#endif // TILE_GRID_HPP
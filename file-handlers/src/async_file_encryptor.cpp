@@ -0,0 +1,227 @@
+#include"../include/async_file_encryptor.hpp"
+#include"posix_io.hpp"
+#include<cerrno>
+#include<cstdlib>
+#include<cstring>
+#include<memory>
+#include<stdexcept>
+#include<string>
+#include<fcntl.h>
+#include<sys/stat.h>
+#include<unistd.h>
+
+using namespace File;
+using PosixIO::FileDescriptor;
+using PosixIO::io_error;
+
+static constexpr size_t BLOCK_ALIGNMENT = CipherFortis::Cipher::CHAINING_BLOCK_SIZE;
+static constexpr size_t DIRECT_ALIGNMENT = 4096;                                // -Logical block size of any common device
+
+static size_t round_up(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+static const char PROCESS[] = "In member function AsyncFileEncryptor::process(...)";
+
+namespace {
+struct FreeDeleter {
+    void operator()(uint8_t* p) const { std::free(p); }
+};
+
+struct Slot {
+    enum struct State { Free, Reading, Ready, Writing } state = State::Free;
+    std::unique_ptr<uint8_t, FreeDeleter> buffer;
+    size_t chunk = 0;
+    off_t offset = 0;
+    size_t length = 0;                                                          // -Payload bytes of the chunk
+    size_t transferSize = 0;                                                    // -Bytes requested (padded with O_DIRECT)
+    size_t done = 0;
+};
+
+// Opens with O_DIRECT when asked, retrying without it on file systems that refuse it (tmpfs answers EINVAL).
+int open_file(const std::filesystem::path& path, int flags, bool& direct) {
+#ifdef O_DIRECT
+    if(direct) {
+        int fd = ::open(path.c_str(), flags | O_DIRECT | O_CLOEXEC, 0644);
+        if(fd >= 0 || errno != EINVAL) return fd;
+        direct = false;
+    }
+#else
+    direct = false;
+#endif
+    return ::open(path.c_str(), flags | O_CLOEXEC, 0644);
+}
+}
+
+AsyncFileEncryptor::AsyncFileEncryptor(const CipherFortis::Cipher& cipher_)
+    : AsyncFileEncryptor(cipher_, Config()) {}
+
+AsyncFileEncryptor::AsyncFileEncryptor(const CipherFortis::Cipher& cipher_, const Config& config_)
+    : cipher(cipher_), config(config_) {
+    if(this->config.queueDepth == 0) {
+        throw std::invalid_argument("In constructor AsyncFileEncryptor::AsyncFileEncryptor(...): queue depth cannot be zero");
+    }
+    size_t chunk = this->config.chunkBytes - this->config.chunkBytes % BLOCK_ALIGNMENT;
+    if(chunk == 0) {
+        throw std::invalid_argument(
+            "In constructor AsyncFileEncryptor::AsyncFileEncryptor(...): chunk size (" +
+            std::to_string(this->config.chunkBytes) + ") must hold at least one block of 16 bytes"
+        );
+    }
+    if(chunk > MAX_CHUNK_BYTES) {
+        throw std::invalid_argument(
+            "In constructor AsyncFileEncryptor::AsyncFileEncryptor(...): chunk size (" +
+            std::to_string(this->config.chunkBytes) + ") exceeds " + std::to_string(MAX_CHUNK_BYTES) + " bytes"
+        );
+    }
+    this->config.chunkBytes = this->config.directIO ? round_up(chunk, DIRECT_ALIGNMENT) : chunk;
+}
+
+const AsyncFileEncryptor::Config& AsyncFileEncryptor::get_config() const {
+    return this->config;
+}
+
+AsyncFileEncryptor::Stats AsyncFileEncryptor::encrypt_file(const std::filesystem::path& input_path, const std::filesystem::path& output_path) const {
+    return this->process(input_path, output_path, false);
+}
+
+AsyncFileEncryptor::Stats AsyncFileEncryptor::decrypt_file(const std::filesystem::path& input_path, const std::filesystem::path& output_path) const {
+    return this->process(input_path, output_path, true);
+}
+
+AsyncFileEncryptor::Stats AsyncFileEncryptor::process(const std::filesystem::path& input_path, const std::filesystem::path& output_path, bool decrypt) const {
+    Stats stats;
+    std::error_code ec;
+    const bool in_place = std::filesystem::equivalent(input_path, output_path, ec);
+
+    bool inDirect = this->config.directIO, outDirect = this->config.directIO;
+    FileDescriptor in, out;
+    in.fd = open_file(input_path, O_RDONLY, inDirect);
+    if(in.fd < 0) throw io_error(PROCESS, "Could not open file", input_path, errno);
+    struct stat st;
+    if(::fstat(in.fd, &st) != 0) throw io_error(PROCESS, "Could not stat file", input_path, errno);
+    const size_t total = static_cast<size_t>(st.st_size);
+    if(total % BLOCK_ALIGNMENT != 0) {
+        throw std::invalid_argument(
+            std::string(PROCESS) + ": file size (" + std::to_string(total) +
+            ") must be a multiple of 16 bytes"
+        );
+    }
+    // In place is safe: chunk k is written only after it was read, and reads only run ahead of k.
+    out.fd = open_file(output_path, O_WRONLY | O_CREAT | (in_place ? 0 : O_TRUNC), outDirect);
+    if(out.fd < 0) throw io_error(PROCESS, "Could not create file", output_path, errno);
+    stats.directIO = inDirect && outDirect;
+
+#ifdef POSIX_FADV_SEQUENTIAL
+    if(!inDirect) ::posix_fadvise(in.fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    const size_t chunk = this->config.chunkBytes;
+    const size_t nchunks = (total + chunk - 1) / chunk;
+    const size_t depth = this->config.queueDepth < nchunks ? this->config.queueDepth : (nchunks > 0 ? nchunks : 1);
+    const size_t bufferSize = round_up(chunk, DIRECT_ALIGNMENT);
+
+    // Buffers are declared before the engine: it is destroyed first and drains what the kernel may still touch.
+    std::vector<Slot> slots(depth);
+    std::vector<std::pair<uint8_t*, size_t>> registered;
+    for(Slot& s : slots) {
+        s.buffer.reset(static_cast<uint8_t*>(std::aligned_alloc(DIRECT_ALIGNMENT, bufferSize)));
+        if(!s.buffer) throw std::bad_alloc();
+        registered.emplace_back(s.buffer.get(), bufferSize);
+    }
+    std::unique_ptr<IOEngine> engine = IOEngine::create(this->config.backend, depth);
+    engine->register_buffers(registered);
+    stats.backend = engine->backend();
+    stats.chunks = nchunks;
+
+    uint8_t chaining[CipherFortis::Cipher::CHAINING_BLOCK_SIZE];
+    this->cipher.initChainingBlock(chaining);
+
+    auto submit = [&](size_t index, bool write) {
+        Slot& s = slots[index];
+        IOEngine::Request r;
+        r.fd = write ? out.fd : in.fd;
+        r.buffer = s.buffer.get() + s.done;
+        r.size = s.transferSize - s.done;
+        r.offset = s.offset + static_cast<off_t>(s.done);
+        r.write = write;
+        r.tag = index;
+        r.bufferIndex = static_cast<int>(index);
+        engine->submit(r);
+        if(write) stats.writes++;
+        else stats.reads++;
+    };
+    auto find_chunk = [&](size_t c) -> Slot* {
+        for(Slot& s : slots) if(s.state != Slot::State::Free && s.chunk == c) return &s;
+        return nullptr;
+    };
+
+    size_t nextRead = 0, nextEncrypt = 0, written = 0;
+    double inFlightSum = 0;
+    size_t samples = 0;
+    while(written < nchunks) {
+        for(size_t i = 0; i < slots.size() && nextRead < nchunks; i++) {
+            Slot& s = slots[i];
+            if(s.state != Slot::State::Free) continue;
+            s.state = Slot::State::Reading;
+            s.chunk = nextRead;
+            s.offset = static_cast<off_t>(nextRead * chunk);
+            s.length = total - nextRead * chunk < chunk ? total - nextRead * chunk : chunk;
+            s.transferSize = inDirect ? round_up(s.length, DIRECT_ALIGNMENT) : s.length;
+            s.done = 0;
+            submit(i, false);
+            nextRead++;
+        }
+
+        for(Slot* s = find_chunk(nextEncrypt); s != nullptr && s->state == Slot::State::Ready; s = find_chunk(nextEncrypt)) {
+            if(decrypt) this->cipher.decryptSegment(s->buffer.get(), s->length, s->buffer.get(), chaining);
+            else        this->cipher.encryptSegment(s->buffer.get(), s->length, s->buffer.get(), chaining);
+            s->state = Slot::State::Writing;
+            s->transferSize = outDirect ? round_up(s->length, DIRECT_ALIGNMENT) : s->length;
+            // The padding of a short last chunk reaches the disk until ftruncate(): zeros, not an earlier chunk's bytes.
+            std::memset(s->buffer.get() + s->length, 0, s->transferSize - s->length);
+            s->done = 0;
+            submit(static_cast<size_t>(s - slots.data()), true);
+            nextEncrypt++;
+        }
+
+        size_t inFlight = engine->in_flight();
+        if(inFlight == 0) break;
+        inFlightSum += static_cast<double>(inFlight);
+        samples++;
+        if(inFlight > stats.maxInFlight) stats.maxInFlight = inFlight;
+        if(nextEncrypt < nchunks) {
+            Slot* next = find_chunk(nextEncrypt);
+            if(next == nullptr || next->state == Slot::State::Reading) stats.stalls++;
+        }
+
+        IOEngine::Completion c = engine->wait();
+        Slot& s = slots[c.tag];
+        bool writing = s.state == Slot::State::Writing;
+        if(c.result < 0) {
+            throw io_error(PROCESS, writing ? "Could not write file" : "Could not read file",
+                           writing ? output_path : input_path, static_cast<int>(-c.result));
+        }
+        s.done += static_cast<size_t>(c.result);
+        if(writing) {
+            if(s.done < s.transferSize) {
+                if(c.result == 0) throw io_error(PROCESS, "Could not write file", output_path, EIO);
+                submit(c.tag, true);                                            // -Short write: send the rest
+            } else {
+                s.state = Slot::State::Free;
+                written++;
+            }
+        } else if(s.done >= s.length) {
+            s.state = Slot::State::Ready;                                       // -Padded O_DIRECT reads stop at EOF
+        } else {
+            if(c.result == 0) throw io_error(PROCESS, "File shrank while being read", input_path, EIO);
+            submit(c.tag, false);
+        }
+    }
+    stats.meanInFlight = samples > 0 ? inFlightSum / static_cast<double>(samples) : 0;
+
+    if(outDirect || in_place) {
+        if(::ftruncate(out.fd, static_cast<off_t>(total)) != 0) throw io_error(PROCESS, "Could not resize file", output_path, errno);
+    }
+    return stats;
+}
@@ -1,7 +1,12 @@
 #include "../include/bitmap.hpp"
+#include "../include/mapped_file.hpp"
+#include "../../core-crypto/include/encryptor.hpp"
 #include "../../third-party/stb/stb_image_write.h"
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <stdexcept>
+#include <utility>
 
 using namespace File;
 
@@ -76,3 +81,104 @@ uint8_t Bitmap::getPixelComponentValue(size_t i, size_t j, RGB c) const {
         static_cast<unsigned>(c)
     ];
 }
+
+// ---------------------------------------------------------------------------
+// Native BMP path
+// ---------------------------------------------------------------------------
+
+static uint32_t read_u32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+           static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+static uint16_t read_u16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | p[1] << 8);
+}
+
+static bool parse_layout(const uint8_t* bytes, size_t size, Bitmap::PixelLayout& layout) {
+    constexpr size_t FILE_HEADER = 14, INFO_HEADER = 40, BI_RGB = 0;
+    if (size < FILE_HEADER + INFO_HEADER || bytes[0] != 'B' || bytes[1] != 'M') return false;
+    const uint8_t* info = bytes + FILE_HEADER;
+    const int32_t width  = static_cast<int32_t>(read_u32(info + 4));
+    const int32_t height = static_cast<int32_t>(read_u32(info + 8));
+    const uint16_t bpp   = read_u16(info + 14);
+    if (read_u32(info) < INFO_HEADER || read_u16(info + 12) != 1 || read_u32(info + 16) != BI_RGB) return false;
+    if ((bpp != 24 && bpp != 32) || width <= 0 || height == 0) return false;
+
+    layout.offset = read_u32(bytes + 10);
+    layout.width = static_cast<size_t>(width);
+    layout.height = height > 0 ? static_cast<size_t>(height) : static_cast<size_t>(-static_cast<int64_t>(height));
+    layout.bytesPerPixel = bpp / 8u;
+    layout.stride = (layout.width * layout.bytesPerPixel + 3) / 4 * 4;
+    layout.bottomUp = height > 0;
+    return layout.offset >= FILE_HEADER + INFO_HEADER &&
+           layout.stride * layout.height <= size - std::min(size, layout.offset);
+}
+
+bool Bitmap::native_layout(const std::filesystem::path& path, PixelLayout& layout) {
+    try {
+        MappedFile file(path, MappedFile::Access::ReadOnly);
+        return parse_layout(file.data(), file.size(), layout);
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+/*
+ * Moves pixels between the file layout (rows in storage order, BGR(A), padded) and the order stb_image decodes them
+ * to (top-down rows, RGB(A), packed). Only rows are reordered and blue/red swapped; nothing is decoded.
+ * */
+static void gather_pixels(const uint8_t* file, const Bitmap::PixelLayout& l, uint8_t* pixels) {
+    const size_t bpp = l.bytesPerPixel, rowBytes = l.width * bpp;
+    for (size_t y = 0; y < l.height; y++) {
+        const uint8_t* src = file + l.offset + (l.bottomUp ? l.height - 1 - y : y) * l.stride;
+        uint8_t* dst = pixels + y * rowBytes;
+        std::memcpy(dst, src, rowBytes);
+        for (size_t x = 0; x < rowBytes; x += bpp) std::swap(dst[x], dst[x + 2]);
+    }
+}
+
+static void scatter_pixels(const uint8_t* pixels, const Bitmap::PixelLayout& l, uint8_t* file) {
+    const size_t bpp = l.bytesPerPixel, rowBytes = l.width * bpp;
+    for (size_t y = 0; y < l.height; y++) {
+        const uint8_t* src = pixels + y * rowBytes;
+        uint8_t* dst = file + l.offset + (l.bottomUp ? l.height - 1 - y : y) * l.stride;
+        std::memcpy(dst, src, rowBytes);
+        for (size_t x = 0; x < rowBytes; x += bpp) std::swap(dst[x], dst[x + 2]);
+    }
+}
+
+void Bitmap::encrypt_native_to(const Encryptor& algorithm, const std::filesystem::path& output_path) const {
+    this->process_native(algorithm, output_path, false);
+}
+
+void Bitmap::decrypt_native_to(const Encryptor& algorithm, const std::filesystem::path& output_path) const {
+    this->process_native(algorithm, output_path, true);
+}
+
+void Bitmap::process_native(const Encryptor& algorithm, const std::filesystem::path& output_path, bool decrypt) const {
+    std::error_code ec;
+    const bool in_place = std::filesystem::equivalent(this->file_path, output_path, ec);
+    MappedFile input(this->file_path, in_place ? MappedFile::Access::Shared : MappedFile::Access::ReadOnly);
+    PixelLayout layout;
+    if (!parse_layout(input.data(), input.size(), layout)) {
+        throw std::invalid_argument(
+            "In member function void Bitmap::process_native(...): '" + this->file_path.string() +
+            "' is not an uncompressed 24 or 32-bit BMP"
+        );
+    }
+
+    ByteBuffer pixels(layout.width * layout.height * layout.bytesPerPixel);
+    gather_pixels(input.data(), layout, pixels.data());
+    if (decrypt) algorithm.decryptBytes(pixels.data(), pixels.size(), pixels.data());
+    else         algorithm.encryptBytes(pixels.data(), pixels.size(), pixels.data());
+
+    if (in_place) {
+        scatter_pixels(pixels.data(), layout, input.data());
+        input.sync();
+        return;
+    }
+    MappedFile output = MappedFile::create(output_path, input.size());
+    std::memcpy(output.data(), input.data(), input.size());                    // -Headers, padding and trailing data
+    scatter_pixels(pixels.data(), layout, output.data());
+}
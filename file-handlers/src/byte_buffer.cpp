@@ -0,0 +1,202 @@
+#include"../include/byte_buffer.hpp"
+#include<cstdlib>
+#include<cstring>
+#include<new>
+#include<sys/mman.h>
+
+using namespace File;
+
+BufferPool::BufferPool() : BufferPool(Config()) {}
+
+BufferPool::BufferPool(const Config& config_) : config(config_) {}
+
+BufferPool::~BufferPool() {
+    this->trim();
+}
+
+size_t BufferPool::size_class(size_t size) {
+    if(size == 0) return 0;
+    if(size <= PAGE) {
+        size_t c = CACHE_LINE;
+        while(c < size) c <<= 1;
+        return c;
+    }
+    unsigned k = 0;                                                             // -2^k < size <= 2^(k+1)
+    while((size_t(1) << (k + 1)) < size) k++;
+    const size_t step = size_t(1) << (k - 2);                                   // -Four classes per doubling
+    return (size + step - 1) / step * step;
+}
+
+uint8_t* BufferPool::allocate(size_t capacity) const {
+    const bool huge = this->config.hugePages && capacity >= HUGE_PAGE;
+    const size_t alignment = huge ? HUGE_PAGE : capacity >= PAGE ? PAGE : CACHE_LINE;
+    void* p = nullptr;
+    if(::posix_memalign(&p, alignment, capacity) != 0) throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+    if(huge) ::madvise(p, capacity, MADV_HUGEPAGE);                            // -Advisory: ignored without THP
+#endif
+    return static_cast<uint8_t*>(p);
+}
+
+uint8_t* BufferPool::acquire(size_t size, size_t& capacity) {
+    capacity = size_class(size);
+    if(capacity == 0) return nullptr;
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        auto it = this->cache.find(capacity);
+        if(it != this->cache.end() && !it->second.empty()) {
+            uint8_t* block = it->second.back();
+            it->second.pop_back();
+            this->counters.cachedBytes -= capacity;
+            this->counters.hits++;
+            return block;
+        }
+        this->counters.misses++;
+    }
+    return this->allocate(capacity);
+}
+
+void BufferPool::release(uint8_t* block, size_t capacity) noexcept {
+    if(block == nullptr) return;
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if(this->counters.cachedBytes + capacity <= this->config.maxCachedBytes) {
+            try {
+                this->cache[capacity].push_back(block);
+                this->counters.cachedBytes += capacity;
+                return;
+            } catch(...) {}                                                     // -Out of memory for the list: free
+        }
+    }
+    std::free(block);
+}
+
+void BufferPool::trim() noexcept {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    for(auto& entry : this->cache) {
+        for(uint8_t* block : entry.second) std::free(block);
+    }
+    this->cache.clear();
+    this->counters.cachedBytes = 0;
+}
+
+BufferPool::Stats BufferPool::stats() const {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->counters;
+}
+
+BufferPool& BufferPool::shared() {
+    // Never destroyed: buffers in objects with static storage may be released after any static pool would be gone.
+    static BufferPool* pool = new BufferPool();
+    return *pool;
+}
+
+ByteBuffer::ByteBuffer() noexcept {}
+
+ByteBuffer::ByteBuffer(size_t size, BufferPool& pool) : pool_(&pool) {
+    this->resize(size);
+}
+
+ByteBuffer::ByteBuffer(const uint8_t* first, const uint8_t* last, BufferPool& pool) : pool_(&pool) {
+    this->assign(first, last);
+}
+
+ByteBuffer::ByteBuffer(const std::vector<uint8_t>& bytes) : ByteBuffer(bytes.data(), bytes.data() + bytes.size()) {}
+
+ByteBuffer::ByteBuffer(const ByteBuffer& other) : pool_(other.pool_) {
+    this->assign(other.begin(), other.end());
+}
+
+ByteBuffer::ByteBuffer(ByteBuffer&& other) noexcept
+    : data_(other.data_), size_(other.size_), capacity_(other.capacity_), pool_(other.pool_), release_(other.release_) {
+    other.release_ = nullptr;
+    other.data_ = nullptr;
+    other.size_ = 0;
+    other.capacity_ = 0;
+}
+
+ByteBuffer& ByteBuffer::operator = (const ByteBuffer& other) {
+    if(this != &other) this->assign(other.begin(), other.end());
+    return *this;
+}
+
+ByteBuffer& ByteBuffer::operator = (ByteBuffer&& other) noexcept {
+    if(this != &other) {
+        this->reset();
+        this->data_ = other.data_;
+        this->size_ = other.size_;
+        this->capacity_ = other.capacity_;
+        this->pool_ = other.pool_;
+        this->release_ = other.release_;
+        other.release_ = nullptr;
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.capacity_ = 0;
+    }
+    return *this;
+}
+
+ByteBuffer::~ByteBuffer() {
+    this->reset();
+}
+
+void ByteBuffer::reserve(size_t capacity) {
+    if(capacity <= this->capacity_) return;
+    if(this->pool_ == nullptr) this->pool_ = &BufferPool::shared();
+    size_t newCapacity;
+    uint8_t* block = this->pool_->acquire(capacity, newCapacity);
+    if(this->size_ > 0) std::memcpy(block, this->data_, this->size_);
+    const size_t size = this->size_;
+    this->reset();
+    this->data_ = block;
+    this->size_ = size;
+    this->capacity_ = newCapacity;
+}
+
+void ByteBuffer::resize(size_t size) {
+    this->reserve(size);
+    this->size_ = size;
+}
+
+void ByteBuffer::assign(const uint8_t* first, const uint8_t* last) {
+    const size_t size = static_cast<size_t>(last - first);
+    if(size > this->capacity_) {
+        this->clear();                                                          // -Nothing worth copying on growth
+        this->reserve(size);
+    }
+    if(size > 0) std::memmove(this->data_, first, size);
+    this->size_ = size;
+}
+
+void ByteBuffer::clear() noexcept {
+    this->size_ = 0;
+}
+
+void ByteBuffer::reset() noexcept {
+    if(this->release_ != nullptr) this->release_(this->data_);
+    else if(this->data_ != nullptr) this->pool_->release(this->data_, this->capacity_);
+    this->release_ = nullptr;
+    this->data_ = nullptr;
+    this->size_ = 0;
+    this->capacity_ = 0;
+}
+
+void ByteBuffer::adopt(uint8_t* block, size_t size, void (*release)(void*)) noexcept {
+    this->reset();
+    this->data_ = block;
+    this->size_ = size;
+    this->capacity_ = size;
+    this->release_ = release;
+}
+
+namespace File {
+
+bool operator == (const ByteBuffer& a, const ByteBuffer& b) {
+    return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size()) == 0);
+}
+
+bool operator == (const ByteBuffer& a, const std::vector<uint8_t>& b) {
+    return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size()) == 0);
+}
+
+} //namespace File
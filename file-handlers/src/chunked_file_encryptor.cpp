@@ -0,0 +1,115 @@
+#include"../include/chunked_file_encryptor.hpp"
+#include"posix_io.hpp"
+#include<cerrno>
+#include<memory>
+#include<stdexcept>
+#include<string>
+#include<fcntl.h>
+#include<sys/stat.h>
+#include<unistd.h>
+
+using namespace File;
+using PosixIO::FileDescriptor;
+using PosixIO::io_error;
+
+static constexpr size_t CHUNK_ALIGNMENT = CipherFortis::Cipher::CHAINING_BLOCK_SIZE;
+
+static size_t validate_chunk_size(size_t chunkBytes) {
+    size_t rounded = chunkBytes - chunkBytes % CHUNK_ALIGNMENT;
+    if(rounded == 0) {
+        throw std::invalid_argument(
+            "In constructor ChunkedFileEncryptor::ChunkedFileEncryptor(...): chunk size (" + std::to_string(chunkBytes) +
+            ") must hold at least one block of " + std::to_string(CHUNK_ALIGNMENT) + " bytes"
+        );
+    }
+    return rounded;
+}
+
+static const char PROCESS[] = "In member function void ChunkedFileEncryptor::process(...)";
+
+ChunkedFileEncryptor::ChunkedFileEncryptor(const CipherFortis::Cipher& cipher_)
+    : ChunkedFileEncryptor(cipher_, Config()) {}
+
+ChunkedFileEncryptor::ChunkedFileEncryptor(const CipherFortis::Cipher& cipher_, const Config& config_)
+    : cipher(cipher_), config(config_) {
+    this->config.chunkBytes = validate_chunk_size(config_.chunkBytes);
+}
+
+size_t ChunkedFileEncryptor::get_chunk_size() const {
+    return this->config.chunkBytes;
+}
+
+void ChunkedFileEncryptor::encrypt_file(const std::filesystem::path& input_path, const std::filesystem::path& output_path) const {
+    this->process(input_path, output_path, false);
+}
+
+void ChunkedFileEncryptor::decrypt_file(const std::filesystem::path& input_path, const std::filesystem::path& output_path) const {
+    this->process(input_path, output_path, true);
+}
+
+void ChunkedFileEncryptor::process(const std::filesystem::path& input_path, const std::filesystem::path& output_path, bool decrypt) const {
+    std::error_code ec;
+    bool in_place = std::filesystem::equivalent(input_path, output_path, ec);
+
+    FileDescriptor in, out;
+    in.fd = ::open(input_path.c_str(), (in_place ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+    if(in.fd < 0) throw io_error(PROCESS, "Could not open file", input_path);
+
+    struct stat st;
+    if(::fstat(in.fd, &st) != 0) throw io_error(PROCESS, "Could not stat file", input_path);
+    const size_t total = static_cast<size_t>(st.st_size);
+    if(total % CHUNK_ALIGNMENT != 0) {
+        throw std::invalid_argument(
+            std::string(PROCESS) + ": file size (" + std::to_string(total) +
+            ") must be a multiple of " + std::to_string(CHUNK_ALIGNMENT) + " bytes"
+        );
+    }
+
+    int out_fd = in.fd;
+    if(!in_place) {
+        out.fd = ::open(output_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if(out.fd < 0) throw io_error(PROCESS, "Could not create file", output_path);
+        out_fd = out.fd;
+    }
+
+#ifdef POSIX_FADV_SEQUENTIAL
+    ::posix_fadvise(in.fd, 0, 0, POSIX_FADV_SEQUENTIAL);                        // -Larger read-ahead window
+#endif
+
+    const size_t chunk = this->config.chunkBytes;
+    std::unique_ptr<uint8_t[]> buffer(new uint8_t[chunk]);
+    uint8_t chaining[CipherFortis::Cipher::CHAINING_BLOCK_SIZE];
+    this->cipher.initChainingBlock(chaining);
+
+    for(size_t offset = 0; offset < total; offset += chunk) {
+        const off_t pos = static_cast<off_t>(offset);
+        const size_t n = total - offset < chunk ? total - offset : chunk;
+#ifdef POSIX_FADV_WILLNEED
+        if(offset + n < total) ::posix_fadvise(in.fd, pos + static_cast<off_t>(n), static_cast<off_t>(chunk), POSIX_FADV_WILLNEED);
+#endif
+        if(PosixIO::read_full(in.fd, buffer.get(), n, pos, input_path, PROCESS) != n) {
+            throw io_error(PROCESS, "File shrank while being read", input_path, EIO);
+        }
+
+        if(decrypt) this->cipher.decryptSegment(buffer.get(), n, buffer.get(), chaining);
+        else        this->cipher.encryptSegment(buffer.get(), n, buffer.get(), chaining);
+
+        PosixIO::write_full(out_fd, buffer.get(), n, pos, output_path, PROCESS);
+
+        if(this->config.dropBehind) {
+#ifdef POSIX_FADV_DONTNEED
+            if(!in_place) ::posix_fadvise(in.fd, pos, static_cast<off_t>(n), POSIX_FADV_DONTNEED);
+#endif
+#if defined(__linux__) && defined(SYNC_FILE_RANGE_WRITE)
+            // Dirty pages cannot be dropped: start writeback of this chunk, wait for the previous one and drop it.
+            ::sync_file_range(out_fd, pos, static_cast<off_t>(n), SYNC_FILE_RANGE_WRITE);
+            if(offset >= chunk) {
+                off_t previous = pos - static_cast<off_t>(chunk);
+                ::sync_file_range(out_fd, previous, static_cast<off_t>(chunk),
+                                  SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+                ::posix_fadvise(out_fd, previous, static_cast<off_t>(chunk), POSIX_FADV_DONTNEED);
+            }
+#endif
+        }
+    }
+}
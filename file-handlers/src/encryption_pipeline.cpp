@@ -0,0 +1,259 @@
+#include"../include/encryption_pipeline.hpp"
+#include"../include/bounded_queue.hpp"
+#include"posix_io.hpp"
+#include<cerrno>
+#include<chrono>
+#include<cstring>
+#include<exception>
+#include<limits>
+#include<memory>
+#include<mutex>
+#include<stdexcept>
+#include<string>
+#include<thread>
+#include<vector>
+#include<fcntl.h>
+#include<sys/stat.h>
+#include<unistd.h>
+
+using namespace File;
+
+static constexpr size_t BLOCK = CipherFortis::Cipher::CHAINING_BLOCK_SIZE;
+
+static const char PROCESS[] = "In member function EncryptionPipeline::Stats EncryptionPipeline::process(...)";
+
+namespace {
+struct Chunk {
+    size_t index;                                                               // -END_OF_WORK tells a worker to stop
+    size_t buffer;                                                              // -Index in the buffer pool
+    off_t offset;
+    size_t length;
+    uint8_t chaining[BLOCK];                                                    // -Chaining value the chunk starts from
+};
+constexpr size_t END_OF_WORK = std::numeric_limits<size_t>::max();
+
+void update_max(std::atomic<size_t>& max, size_t value) {
+    size_t current = max.load(std::memory_order_relaxed);
+    while(value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+/*
+ * Retries 'attempt' until it succeeds or the pipeline aborts, backing off from spinning to yielding to sleeping.
+ * Each blocking episode is counted once in 'waits'.
+ * */
+template<typename F>
+bool wait_for(F attempt, const std::atomic<bool>& abort, std::atomic<size_t>& waits) {
+    if(attempt()) return true;
+    waits.fetch_add(1, std::memory_order_relaxed);
+    for(unsigned spins = 0;; spins++) {
+        if(abort.load(std::memory_order_relaxed)) return false;
+        if(attempt()) return true;
+        if(spins < 64) continue;
+        if(spins < 256) std::this_thread::yield();
+        else std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+}
+}
+
+EncryptionPipeline::QueueCounters EncryptionPipeline::Counters::snapshot() const {
+    QueueCounters c;
+    c.pushed = this->pushed.load(std::memory_order_relaxed);
+    c.fullWaits = this->fullWaits.load(std::memory_order_relaxed);
+    c.emptyWaits = this->emptyWaits.load(std::memory_order_relaxed);
+    c.maxOccupancy = this->maxOccupancy.load(std::memory_order_relaxed);
+    return c;
+}
+
+EncryptionPipeline::EncryptionPipeline(const CipherFortis::Cipher& cipher_)
+    : EncryptionPipeline(cipher_, Config()) {}
+
+EncryptionPipeline::EncryptionPipeline(const CipherFortis::Cipher& cipher_, const Config& config_)
+    : cipher(cipher_), config(config_) {
+    this->config.chunkBytes -= this->config.chunkBytes % BLOCK;
+    if(this->config.chunkBytes == 0) {
+        throw std::invalid_argument(
+            "In constructor EncryptionPipeline::EncryptionPipeline(...): chunk size (" + std::to_string(config_.chunkBytes) +
+            ") must hold at least one block of 16 bytes"
+        );
+    }
+    if(this->config.workers == 0) {
+        this->config.workers = std::thread::hardware_concurrency();
+        if(this->config.workers == 0) this->config.workers = 1;
+    }
+    if(this->config.buffers == 0) this->config.buffers = 2*this->config.workers + 2;
+}
+
+const EncryptionPipeline::Config& EncryptionPipeline::get_config() const {
+    return this->config;
+}
+
+EncryptionPipeline::Stats EncryptionPipeline::Run::snapshot() const {
+    Stats s;
+    s.workers = this->workers;
+    s.chunks = this->chunks;
+    s.freeBuffers = this->freeCounters.snapshot();
+    s.work = this->workCounters.snapshot();
+    s.done = this->doneCounters.snapshot();
+    return s;
+}
+
+EncryptionPipeline::Stats EncryptionPipeline::get_live_stats() const {
+    std::shared_ptr<const Run> run;
+    {
+        std::lock_guard<std::mutex> lock(this->liveMutex);
+        run = this->live;
+    }
+    return run ? run->snapshot() : Stats();
+}
+
+EncryptionPipeline::Stats EncryptionPipeline::encrypt_file(const std::filesystem::path& input_path, const std::filesystem::path& output_path) const {
+    return this->process(input_path, output_path, false);
+}
+
+EncryptionPipeline::Stats EncryptionPipeline::decrypt_file(const std::filesystem::path& input_path, const std::filesystem::path& output_path) const {
+    return this->process(input_path, output_path, true);
+}
+
+EncryptionPipeline::Stats EncryptionPipeline::process(const std::filesystem::path& input_path, const std::filesystem::path& output_path, bool decrypt) const {
+    using Mode = CipherFortis::Cipher::OperationMode::Identifier;
+    std::error_code ec;
+    const bool in_place = std::filesystem::equivalent(input_path, output_path, ec);
+
+    PosixIO::FileDescriptor in, out;
+    in.fd = ::open(input_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(in.fd < 0) throw PosixIO::io_error(PROCESS, "Could not open file", input_path);
+    struct stat st;
+    if(::fstat(in.fd, &st) != 0) throw PosixIO::io_error(PROCESS, "Could not stat file", input_path);
+    const size_t total = static_cast<size_t>(st.st_size);
+    if(total % BLOCK != 0) {
+        throw std::invalid_argument(
+            "In member function EncryptionPipeline::process(...): file size (" + std::to_string(total) +
+            ") must be a multiple of 16 bytes"
+        );
+    }
+    out.fd = ::open(output_path.c_str(), O_WRONLY | O_CREAT | (in_place ? 0 : O_TRUNC) | O_CLOEXEC, 0644);
+    if(out.fd < 0) throw PosixIO::io_error(PROCESS, "Could not create file", output_path);
+#ifdef POSIX_FADV_SEQUENTIAL
+    ::posix_fadvise(in.fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    const Mode mode = this->cipher.getOptModeID();
+    const bool sequential = mode == Mode::OFB || (mode == Mode::CBC && !decrypt);
+    const size_t workers = sequential ? 1 : this->config.workers;
+    const size_t chunkBytes = this->config.chunkBytes;
+    const size_t nchunks = (total + chunkBytes - 1) / chunkBytes;
+    const size_t nbuffers = this->config.buffers;
+
+    const std::shared_ptr<Run> run = std::make_shared<Run>();
+    run->workers = workers;
+    run->chunks = nchunks;
+    {
+        std::lock_guard<std::mutex> lock(this->liveMutex);
+        this->live = run;
+    }
+
+    std::vector<std::unique_ptr<uint8_t[]>> pool(nbuffers);
+    for(std::unique_ptr<uint8_t[]>& b : pool) b.reset(new uint8_t[chunkBytes]);
+    BoundedQueue<size_t> freeQueue(nbuffers);
+    BoundedQueue<Chunk> workQueue(nbuffers + workers);                         // -Room for the end-of-work markers
+    BoundedQueue<Chunk> doneQueue(nbuffers);
+    for(size_t i = 0; i < nbuffers; i++) freeQueue.try_push(i);
+
+    std::atomic<bool> abort{false};
+    std::mutex errorMutex;
+    std::exception_ptr error;
+    auto fail = [&](std::exception_ptr e) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if(!error) error = e;
+        abort = true;
+    };
+    auto push = [&](BoundedQueue<Chunk>& q, Counters& counters, const Chunk& c) {
+        if(!wait_for([&]() { return q.try_push(c); }, abort, counters.fullWaits)) return false;
+        counters.pushed.fetch_add(1, std::memory_order_relaxed);
+        update_max(counters.maxOccupancy, q.size_approx());
+        return true;
+    };
+
+    auto reader = [&]() {
+        try {
+            uint8_t chaining[BLOCK];
+            this->cipher.initChainingBlock(chaining);
+            for(size_t k = 0; k < nchunks; k++) {
+                size_t buffer;
+                if(!wait_for([&]() { return freeQueue.try_pop(buffer); }, abort, run->freeCounters.emptyWaits)) return;
+                Chunk c;
+                c.index = k;
+                c.buffer = buffer;
+                c.offset = static_cast<off_t>(k * chunkBytes);
+                c.length = total - k * chunkBytes < chunkBytes ? total - k * chunkBytes : chunkBytes;
+                uint8_t* data = pool[buffer].get();
+                if(PosixIO::read_full(in.fd, data, c.length, c.offset, input_path, PROCESS) != c.length) {
+                    throw PosixIO::io_error(PROCESS, "File shrank while being read", input_path, EIO);
+                }
+                std::memcpy(c.chaining, chaining, BLOCK);
+                if(mode == Mode::CTR) CipherFortis::Cipher::advanceCounter(chaining, c.length / BLOCK);
+                else if(mode == Mode::CBC && decrypt) std::memcpy(chaining, data + c.length - BLOCK, BLOCK);
+                if(!push(workQueue, run->workCounters, c)) return;
+            }
+            Chunk end{};
+            end.index = END_OF_WORK;
+            for(size_t w = 0; w < workers; w++) if(!push(workQueue, run->workCounters, end)) return;
+        } catch(...) {
+            fail(std::current_exception());
+        }
+    };
+
+    auto worker = [&]() {
+        try {
+            uint8_t carried[BLOCK];                                             // -Used by sequential modes (single worker)
+            this->cipher.initChainingBlock(carried);
+            for(;;) {
+                Chunk c;
+                if(!wait_for([&]() { return workQueue.try_pop(c); }, abort, run->workCounters.emptyWaits)) return;
+                if(c.index == END_OF_WORK) return;
+                uint8_t* data = pool[c.buffer].get();
+                uint8_t* chaining = sequential ? carried : c.chaining;
+                if(decrypt) this->cipher.decryptSegment(data, c.length, data, chaining);
+                else        this->cipher.encryptSegment(data, c.length, data, chaining);
+                if(!push(doneQueue, run->doneCounters, c)) return;
+            }
+        } catch(...) {
+            fail(std::current_exception());
+        }
+    };
+
+    auto writer = [&]() {
+        try {
+            // At most 'nbuffers' chunks are in flight, so index % nbuffers identifies a reorder slot.
+            std::vector<Chunk> reorder(nbuffers);
+            std::vector<bool> present(nbuffers, false);
+            for(size_t next = 0; next < nchunks;) {
+                Chunk c;
+                if(!wait_for([&]() { return doneQueue.try_pop(c); }, abort, run->doneCounters.emptyWaits)) return;
+                reorder[c.index % nbuffers] = c;
+                present[c.index % nbuffers] = true;
+                while(next < nchunks && present[next % nbuffers]) {
+                    const Chunk& w = reorder[next % nbuffers];
+                    const uint8_t* data = pool[w.buffer].get();
+                    PosixIO::write_full(out.fd, data, w.length, w.offset, output_path, PROCESS);
+                    present[next % nbuffers] = false;
+                    size_t buffer = w.buffer;
+                    if(!wait_for([&]() { return freeQueue.try_push(buffer); }, abort, run->freeCounters.fullWaits)) return;
+                    run->freeCounters.pushed.fetch_add(1, std::memory_order_relaxed);
+                    update_max(run->freeCounters.maxOccupancy, freeQueue.size_approx());
+                    next++;
+                }
+            }
+        } catch(...) {
+            fail(std::current_exception());
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.emplace_back(reader);
+    for(size_t w = 0; w < workers; w++) threads.emplace_back(worker);
+    threads.emplace_back(writer);
+    for(std::thread& t : threads) t.join();
+    if(error) std::rethrow_exception(error);
+    return run->snapshot();
+}
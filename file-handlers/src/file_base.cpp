@@ -1,14 +1,95 @@
 #include"../include/file_base.hpp"
 #include"../../core-crypto/include/encryptor.hpp"
 #include"../../analysis/include/data_randomness.hpp"
+#include"../../analysis/include/randomness_accumulator.hpp"
+#include<cerrno>
+#include<cstring>
 #include<fstream>
+#include<utility>
+#include<fcntl.h>
+#include<unistd.h>
 
 using namespace File;
 
 // Constructor implementation
 FileBase::FileBase(const std::filesystem::path& path) : file_path(path) {}
 
+FileBase::FileBase(const std::filesystem::path& path, Storage storage_) : file_path(path), storage(storage_) {}
+
+FileBase::FileBase(const FileBase& other) : file_path(other.file_path), data(other.data) {
+    if(other.storage != Storage::Buffered) this->data.assign(other.get_bytes(), other.get_bytes() + other.get_size());
+}
+
+FileBase& FileBase::operator=(const FileBase& other) {
+    if(this != &other) {
+        this->file_path = other.file_path;
+        this->mapping.close();
+        this->storage = Storage::Buffered;
+        if(other.storage != Storage::Buffered) this->data.assign(other.get_bytes(), other.get_bytes() + other.get_size());
+        else this->data = other.data;
+    }
+    return *this;
+}
+
+FileBase::FileBase(FileBase&& other) noexcept
+    : file_path(std::move(other.file_path)), data(std::move(other.data)), storage(other.storage), mapping(std::move(other.mapping)) {
+    other.storage = Storage::Buffered;
+}
+
+FileBase& FileBase::operator=(FileBase&& other) noexcept {
+    if(this != &other) {
+        this->file_path = std::move(other.file_path);
+        this->data = std::move(other.data);
+        this->storage = other.storage;
+        this->mapping = std::move(other.mapping);
+        other.storage = Storage::Buffered;
+    }
+    return *this;
+}
+
+static bool same_file(const std::filesystem::path& a, const std::filesystem::path& b) {
+    std::error_code ec;
+    return std::filesystem::equivalent(a, b, ec);
+}
+
+/*
+ * Writes 'size' bytes to 'path' without truncating first: the bytes may live in a private mapping of that very file,
+ * whose untouched pages would fault if the file shrank under them. The file is cut to 'size' afterwards.
+ * */
+static void write_bytes(const std::filesystem::path& path, const uint8_t* bytes, size_t size) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if(fd < 0) {
+        throw std::runtime_error(
+            "In member function bool FileBase::save(const std::filesystem::path& output_path) const: Could not open file."
+        );
+    }
+    size_t written = 0;
+    while(written < size) {
+        ssize_t w = ::write(fd, bytes + written, size - written);
+        if(w < 0) {
+            if(errno == EINTR) continue;
+            break;
+        }
+        written += static_cast<size_t>(w);
+    }
+    bool ok = written == size && ::ftruncate(fd, static_cast<off_t>(size)) == 0;
+    ::close(fd);
+    if(!ok) {
+        throw std::runtime_error(
+            "In member function bool FileBase::save(const std::filesystem::path& output_path) const: Could not write file."
+        );
+    }
+}
+
 void FileBase::load() {
+    if(this->storage != Storage::Buffered) {
+        this->data.reset();
+        this->mapping = MappedFile(
+            this->file_path,
+            this->storage == Storage::MappedShared ? MappedFile::Access::Shared : MappedFile::Access::Private
+        );
+        return;
+    }
     std::ifstream file;
     file.open(this->file_path, std::ios::binary | std::ios::ate);
     if (!file.is_open()) {
@@ -18,9 +99,9 @@ void FileBase::load() {
     }
     std::streamsize size = file.tellg();
     file.seekg(0, std::ios::beg);
-    this->data.resize(size);
+    this->data.resize(static_cast<size_t>(size));
     if (!file.read(reinterpret_cast<char*>(this->data.data()), size)) {
-        this->data.clear(); // Clear data on failure
+        this->data.reset(); // Clear data on failure
         throw std::runtime_error(
             "In member function void FileBase::load(): Could not read file."
         );
@@ -28,6 +109,15 @@ void FileBase::load() {
 }
 
 void FileBase::save(const std::filesystem::path& output_path) const{
+    if(this->storage != Storage::Buffered) {
+        const std::filesystem::path& target = output_path.empty() ? this->file_path : output_path;
+        if(this->storage == Storage::MappedShared && same_file(target, this->file_path)) {
+            this->mapping.sync();                                               // -Content already is the file
+        } else {
+            write_bytes(target, this->mapping.data(), this->mapping.size());
+        }
+        return;
+    }
     std::ofstream file;
     if(output_path.empty())
         file.open(this->file_path, std::ios::binary);
@@ -45,32 +135,121 @@ void FileBase::save(const std::filesystem::path& output_path) const{
     }
 }
 
+/*
+ * Baseline path for encryptors whose output length differs from the input (Encryptor::preservesLength()): the
+ * content goes through encryption()/decryption() and is replaced, so it ends up Buffered whatever the storage was.
+ * */
+std::vector<uint8_t> FileBase::transformed(const Encryptor& algorithm, bool decrypt) const{
+    std::vector<uint8_t> input(this->get_bytes(), this->get_bytes() + this->get_size()), output;
+    if(decrypt) algorithm.decryption(input, output);
+    else        algorithm.encryption(input, output);
+    return output;
+}
+
+void FileBase::replace_content(const std::vector<uint8_t>& bytes){
+    this->data.assign(bytes.data(), bytes.data() + bytes.size());
+    if(this->storage != Storage::Buffered) {
+        this->mapping.close();
+        this->storage = Storage::Buffered;
+    }
+}
+
+static void write_mapped(const std::filesystem::path& path, const std::vector<uint8_t>& bytes) {
+    MappedFile output = MappedFile::create(path, bytes.size());
+    if(!bytes.empty()) std::memcpy(output.data(), bytes.data(), bytes.size());
+}
+
 void FileBase::apply_encryption(const Encryptor& algorithm){
-    try{
-        algorithm.encryption(this->data,this->data);
-    } catch(...){
-        throw;
+    if(!algorithm.preservesLength()) {
+        this->replace_content(this->transformed(algorithm, false));
+        return;
     }
+    if(this->storage != Storage::Buffered) {
+        algorithm.encryptBytes(this->mapping.data(), this->mapping.size(), this->mapping.data());
+        return;
+    }
+    algorithm.encryptBytes(this->data.data(), this->data.size(), this->data.data());
 }
 
 void FileBase::apply_decryption(const Encryptor& algorithm){
-    try{
-        algorithm.decryption(this->data,this->data);
-    } catch(...){
-        throw;
+    if(!algorithm.preservesLength()) {
+        this->replace_content(this->transformed(algorithm, true));
+        return;
+    }
+    if(this->storage != Storage::Buffered) {
+        algorithm.decryptBytes(this->mapping.data(), this->mapping.size(), this->mapping.data());
+        return;
     }
+    algorithm.decryptBytes(this->data.data(), this->data.size(), this->data.data());
 }
 
-DataRandomness FileBase::calculate_randomness() const{
-    return DataRandomness(reinterpret_cast<const std::vector<std::byte>&>(this->data));
+void FileBase::encrypt_to(const Encryptor& algorithm, const std::filesystem::path& output_path) const{
+    if(same_file(output_path, this->file_path)) {
+        throw std::invalid_argument(
+            "In member function void FileBase::encrypt_to(const Encryptor&, const std::filesystem::path&) const: "
+            "output path is the loaded file"
+        );
+    }
+    if(!algorithm.preservesLength()) {
+        write_mapped(output_path, this->transformed(algorithm, false));
+        return;
+    }
+    MappedFile output = MappedFile::create(output_path, this->get_size());
+    algorithm.encryptBytes(this->get_bytes(), this->get_size(), output.data());
+}
+
+void FileBase::decrypt_to(const Encryptor& algorithm, const std::filesystem::path& output_path) const{
+    if(same_file(output_path, this->file_path)) {
+        throw std::invalid_argument(
+            "In member function void FileBase::decrypt_to(const Encryptor&, const std::filesystem::path&) const: "
+            "output path is the loaded file"
+        );
+    }
+    if(!algorithm.preservesLength()) {
+        write_mapped(output_path, this->transformed(algorithm, true));
+        return;
+    }
+    MappedFile output = MappedFile::create(output_path, this->get_size());
+    algorithm.decryptBytes(this->get_bytes(), this->get_size(), output.data());
+}
+
+DataRandomness FileBase::calculate_randomness(size_t threads) const{
+    if(this->get_size() == 0) {
+        throw std::runtime_error("Empty data set.");                            // -As DataRandomness(std::vector) reports it
+    }
+    return DataRandomness(ByteMoments::measure(this->get_bytes(), this->get_size(), 0, 1, {1}, threads));
+}
+
+DataRandomness FileBase::encrypt_and_measure(const Encryptor& algorithm){
+    if(!algorithm.preservesLength()) {
+        this->apply_encryption(algorithm);
+        return this->calculate_randomness();
+    }
+    uint8_t* bytes = this->storage != Storage::Buffered ? this->mapping.data() : this->data.data();
+    RandomnessAccumulator accumulator;
+    algorithm.encryptBytesObserved(bytes, this->get_size(), bytes, [&accumulator](const uint8_t* piece, size_t size) {
+        accumulator.update(piece, size);
+    });
+    return DataRandomness(accumulator.finalize());
 }
 
 const std::filesystem::path& FileBase::get_path() const{
     return this->file_path;
 }
-const std::vector<uint8_t>& FileBase::get_data() const{
+const ByteBuffer& FileBase::get_data() const{
+    if(this->storage != Storage::Buffered) {
+        throw std::logic_error(
+            "In member function const ByteBuffer& FileBase::get_data() const: content is memory mapped, use get_bytes()"
+        );
+    }
     return this->data;
 }
+const uint8_t* FileBase::get_bytes() const{
+    return this->storage != Storage::Buffered ? this->mapping.data() : this->data.data();
+}
 size_t FileBase::get_size() const{
-    return this->data.size();
+    return this->storage != Storage::Buffered ? this->mapping.size() : this->data.size();
+}
+FileBase::Storage FileBase::get_storage() const{
+    return this->storage;
 }
@@ -0,0 +1,293 @@
+#include"../include/io_engine.hpp"
+#include"../../core-crypto/include/thread_pool.hpp"
+#include<cerrno>
+#include<condition_variable>
+#include<cstring>
+#include<deque>
+#include<mutex>
+#include<stdexcept>
+#include<string>
+#include<unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include<linux/io_uring.h>
+#include<sys/mman.h>
+#include<sys/syscall.h>
+#include<sys/uio.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(__NR_io_uring_register)
+#define CIPHFORTIS_HAVE_IO_URING 1
+#endif
+#endif
+#endif
+
+using namespace File;
+
+namespace {
+
+// Blocking transfer of the whole request; returns bytes moved (short only at end of file) or -errno.
+ssize_t transfer(const IOEngine::Request& r) {
+    size_t done = 0;
+    while(done < r.size) {
+        ssize_t n = r.write
+            ? ::pwrite(r.fd, r.buffer + done, r.size - done, r.offset + static_cast<off_t>(done))
+            : ::pread(r.fd, r.buffer + done, r.size - done, r.offset + static_cast<off_t>(done));
+        if(n < 0) {
+            if(errno == EINTR) continue;
+            return -errno;
+        }
+        if(n == 0) break;
+        done += static_cast<size_t>(n);
+    }
+    return static_cast<ssize_t>(done);
+}
+
+/*
+ * Blocking pread/pwrite on a private ThreadPool. Requests queued by submit() are handed to the pool by wait(), as
+ * io_uring does with its submission queue.
+ * */
+class ThreadPoolEngine : public IOEngine {
+public:
+    explicit ThreadPoolEngine(size_t queueDepth) {
+        CipherFortis::ThreadPool::Config config;
+        config.threadCount = queueDepth < 16 ? queueDepth : 16;
+        this->pool.reset(new CipherFortis::ThreadPool(config));
+    }
+
+    ~ThreadPoolEngine() override {
+        this->pool.reset();                                                     // -Runs what is left; completions still have a home
+    }
+
+    void register_buffers(const std::vector<std::pair<uint8_t*, size_t>>&) override {}
+
+    void submit(const Request& request) override {
+        this->queued.push_back(request);
+        this->inFlight++;
+    }
+
+    Completion wait() override {
+        if(this->inFlight == 0) throw std::logic_error("In member function IOEngine::wait(): no request in flight");
+        for(const Request& r : this->queued) {
+            this->pool->submit([this, r]() {
+                ssize_t result = transfer(r);
+                std::lock_guard<std::mutex> lock(this->mutex);
+                this->completed.push_back(Completion{r.tag, result});
+                this->ready.notify_one();
+            });
+        }
+        this->queued.clear();
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->ready.wait(lock, [this]() { return !this->completed.empty(); });
+        Completion c = this->completed.front();
+        this->completed.pop_front();
+        this->inFlight--;
+        return c;
+    }
+
+    size_t in_flight() const override { return this->inFlight; }
+    Backend backend() const override { return Backend::ThreadPool; }
+
+private:
+    std::vector<Request> queued;
+    size_t inFlight = 0;
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<Completion> completed;
+    std::unique_ptr<CipherFortis::ThreadPool> pool;
+};
+
+#ifdef CIPHFORTIS_HAVE_IO_URING
+int uring_setup(unsigned entries, io_uring_params* p) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, p));
+}
+
+int uring_enter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+int uring_register(int fd, unsigned opcode, const void* arg, unsigned nargs) {
+    return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, nargs));
+}
+
+/*
+ * io_uring driven through the raw system calls (liburing is not required). The submission and completion rings are
+ * shared with the kernel: we own the SQ tail and the CQ head, the kernel owns the other two indices.
+ * */
+class IoUringEngine : public IOEngine {
+public:
+    // Largest transfer of one request: sqe->len is 32 bits and the kernel caps reads and writes at MAX_RW_COUNT. A
+    // bigger request completes short, as the other engine's transfers may.
+    static constexpr uint32_t MAX_TRANSFER = 0x7FFFF000;
+
+    explicit IoUringEngine(size_t queueDepth) {
+        io_uring_params p;
+        std::memset(&p, 0, sizeof(p));
+        this->ringFd = uring_setup(static_cast<unsigned>(queueDepth), &p);
+        if(this->ringFd < 0) {
+            throw std::runtime_error(std::string("In constructor IoUringEngine: io_uring_setup failed: ") + std::strerror(errno));
+        }
+        this->sqRingSize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        this->cqRingSize = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if(single) {
+            if(this->cqRingSize > this->sqRingSize) this->sqRingSize = this->cqRingSize;
+            this->cqRingSize = this->sqRingSize;
+        }
+        this->sqRing = ::mmap(nullptr, this->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->ringFd, IORING_OFF_SQ_RING);
+        if(this->sqRing == MAP_FAILED) { this->sqRing = nullptr; this->fail("mmap of the submission ring"); }
+        if(single) {
+            this->cqRing = this->sqRing;
+        } else {
+            this->cqRing = ::mmap(nullptr, this->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->ringFd, IORING_OFF_CQ_RING);
+            if(this->cqRing == MAP_FAILED) { this->cqRing = nullptr; this->fail("mmap of the completion ring"); }
+        }
+        this->sqesSize = p.sq_entries * sizeof(io_uring_sqe);
+        void* sqesMap = ::mmap(nullptr, this->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->ringFd, IORING_OFF_SQES);
+        if(sqesMap == MAP_FAILED) this->fail("mmap of the submission entries");
+        this->sqes = static_cast<io_uring_sqe*>(sqesMap);
+
+        uint8_t* sq = static_cast<uint8_t*>(this->sqRing);
+        uint8_t* cq = static_cast<uint8_t*>(this->cqRing);
+        this->sqHead  = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+        this->sqTail  = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+        this->sqMask  = reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+        this->sqArray = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+        this->cqHead  = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+        this->cqTail  = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+        this->cqMask  = reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+        this->cqes    = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+        this->sqEntries = p.sq_entries;
+    }
+
+    ~IoUringEngine() override {
+        while(this->inFlight > 0) {                                             // -The kernel may still write into caller buffers
+            try { this->wait(); } catch(...) { break; }
+        }
+        this->release();
+    }
+
+    void register_buffers(const std::vector<std::pair<uint8_t*, size_t>>& buffers) override {
+        std::vector<iovec> iov(buffers.size());
+        for(size_t i = 0; i < buffers.size(); i++) iov[i] = iovec{buffers[i].first, buffers[i].second};
+        // Registration pins the pages and counts against RLIMIT_MEMLOCK; without it plain READ/WRITE still work.
+        this->fixedBuffers = uring_register(this->ringFd, IORING_REGISTER_BUFFERS, iov.data(), static_cast<unsigned>(iov.size())) == 0;
+    }
+
+    void submit(const Request& request) override {
+        unsigned tail = *this->sqTail;
+        if(tail - __atomic_load_n(this->sqHead, __ATOMIC_ACQUIRE) >= this->sqEntries) this->flush(0);
+        unsigned index = tail & *this->sqMask;
+        io_uring_sqe* sqe = &this->sqes[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        bool fixed = this->fixedBuffers && request.bufferIndex >= 0;
+        if(request.write) sqe->opcode = fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+        else              sqe->opcode = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+        sqe->fd = request.fd;
+        sqe->addr = reinterpret_cast<uint64_t>(request.buffer);
+        sqe->len = request.size < MAX_TRANSFER ? static_cast<uint32_t>(request.size) : MAX_TRANSFER;
+        sqe->off = static_cast<uint64_t>(request.offset);
+        sqe->user_data = request.tag;
+        if(fixed) sqe->buf_index = static_cast<uint16_t>(request.bufferIndex);
+        this->sqArray[index] = index;
+        __atomic_store_n(this->sqTail, tail + 1, __ATOMIC_RELEASE);
+        this->toSubmit++;
+        this->inFlight++;
+    }
+
+    Completion wait() override {
+        if(this->inFlight == 0) throw std::logic_error("In member function IOEngine::wait(): no request in flight");
+        for(;;) {
+            unsigned head = *this->cqHead;
+            if(head != __atomic_load_n(this->cqTail, __ATOMIC_ACQUIRE)) {
+                const io_uring_cqe& cqe = this->cqes[head & *this->cqMask];
+                Completion c{cqe.user_data, static_cast<ssize_t>(cqe.res)};
+                __atomic_store_n(this->cqHead, head + 1, __ATOMIC_RELEASE);
+                this->inFlight--;
+                return c;
+            }
+            this->flush(1);
+        }
+    }
+
+    size_t in_flight() const override { return this->inFlight; }
+    Backend backend() const override { return Backend::IoUring; }
+
+private:
+    int ringFd = -1;
+    void* sqRing = nullptr;
+    void* cqRing = nullptr;
+    size_t sqRingSize = 0, cqRingSize = 0, sqesSize = 0;
+    io_uring_sqe* sqes = nullptr;
+    io_uring_cqe* cqes = nullptr;
+    unsigned *sqHead = nullptr, *sqTail = nullptr, *sqMask = nullptr, *sqArray = nullptr;
+    unsigned *cqHead = nullptr, *cqTail = nullptr, *cqMask = nullptr;
+    unsigned sqEntries = 0;
+    unsigned toSubmit = 0;
+    size_t inFlight = 0;
+    bool fixedBuffers = false;
+
+    void flush(unsigned minComplete) {
+        for(;;) {
+            int r = uring_enter(this->ringFd, this->toSubmit, minComplete, minComplete > 0 ? IORING_ENTER_GETEVENTS : 0);
+            if(r >= 0) {
+                this->toSubmit -= static_cast<unsigned>(r) < this->toSubmit ? static_cast<unsigned>(r) : this->toSubmit;
+                return;
+            }
+            if(errno != EINTR) {
+                throw std::runtime_error(std::string("In member function IOEngine::wait(): io_uring_enter failed: ") + std::strerror(errno));
+            }
+        }
+    }
+
+    void release() {
+        if(this->sqes != nullptr) ::munmap(this->sqes, this->sqesSize);
+        if(this->cqRing != nullptr && this->cqRing != this->sqRing) ::munmap(this->cqRing, this->cqRingSize);
+        if(this->sqRing != nullptr) ::munmap(this->sqRing, this->sqRingSize);
+        if(this->ringFd >= 0) ::close(this->ringFd);
+        this->sqes = nullptr; this->cqRing = nullptr; this->sqRing = nullptr; this->ringFd = -1;
+    }
+
+    [[noreturn]] void fail(const char* what) {
+        int saved = errno;
+        this->release();
+        throw std::runtime_error(std::string("In constructor IoUringEngine: ") + what + " failed: " + std::strerror(saved));
+    }
+};
+#endif
+
+} // namespace
+
+bool IOEngine::io_uring_available() {
+#ifdef CIPHFORTIS_HAVE_IO_URING
+    static const bool available = []() {
+        io_uring_params p;
+        std::memset(&p, 0, sizeof(p));
+        int fd = uring_setup(1, &p);                                            // -ENOSYS, or EPERM under seccomp filters
+        if(fd < 0) return false;
+        ::close(fd);
+        return true;
+    }();
+    return available;
+#else
+    return false;
+#endif
+}
+
+std::unique_ptr<IOEngine> IOEngine::create(Backend backend, size_t queueDepth) {
+    if(queueDepth == 0) {
+        throw std::invalid_argument("In function IOEngine::create(Backend, size_t): queue depth cannot be zero");
+    }
+#ifdef CIPHFORTIS_HAVE_IO_URING
+    if(backend != Backend::ThreadPool && io_uring_available()) {
+        try {
+            return std::unique_ptr<IOEngine>(new IoUringEngine(queueDepth));
+        } catch(const std::runtime_error&) {
+            if(backend == Backend::IoUring) throw;
+        }
+    }
+#endif
+    if(backend == Backend::IoUring) {
+        throw std::runtime_error("In function IOEngine::create(Backend, size_t): io_uring is not available");
+    }
+    return std::unique_ptr<IOEngine>(new ThreadPoolEngine(queueDepth));
+}
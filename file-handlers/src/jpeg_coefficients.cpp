@@ -0,0 +1,587 @@
+#include"../include/jpeg_coefficients.hpp"
+#include"../include/mapped_file.hpp"
+#include"../../core-crypto/include/encryptor.hpp"
+#include<algorithm>
+#include<cstdlib>
+#include<cstring>
+#include<fstream>
+#include<stdexcept>
+#include<string>
+
+using namespace File;
+
+namespace {
+const char READ[] = "In member function JpegCoefficients::parse(...)";
+
+[[noreturn]] void invalid(const std::string& what) {
+    throw std::invalid_argument(std::string(READ) + ": " + what);
+}
+
+size_t ceil_div(size_t a, size_t b) { return (a + b - 1) / b; }
+
+unsigned category(int value) {                                                 // -Bits of |value|
+    unsigned magnitude = static_cast<unsigned>(value < 0 ? -value : value), s = 0;
+    for(; magnitude != 0; magnitude >>= 1) s++;
+    return s;
+}
+
+/*
+ * Amplitude bits of a coefficient of category s: the value itself when positive, value - 1 (its low s bits) when
+ * negative. The leading bit is therefore the sign.
+ * */
+uint32_t amplitude_bits(int value, unsigned s) {
+    return static_cast<uint32_t>(value > 0 ? value : value + (1 << s) - 1);
+}
+
+int extend(uint32_t bits, unsigned s) {
+    return bits >> (s - 1) ? static_cast<int>(bits) : static_cast<int>(bits) - (1 << s) + 1;
+}
+
+/*
+ * Entropy coded data reader: MSB first, drops the zero byte stuffed after 0xFF and stops at markers, past which it
+ * feeds zeros.
+ * */
+class BitReader {
+public:
+    BitReader(const uint8_t* begin, const uint8_t* end_) : p(begin), end(end_) {}
+
+    uint32_t peek(unsigned n) {
+        if(this->count < n) this->refill();
+        return static_cast<uint32_t>(this->buffer >> (64 - n));
+    }
+
+    void skip(unsigned n) {
+        this->buffer <<= n;
+        this->count -= n;
+    }
+
+    uint32_t get(unsigned n) {
+        if(n == 0) return 0;
+        const uint32_t bits = this->peek(n);
+        this->skip(n);
+        return bits;
+    }
+
+    /*
+     * Drops the padding of the interval that ends and consumes its RSTn marker.
+     * */
+    void restart(unsigned n) {
+        this->buffer = 0;
+        this->count = 0;
+        this->marker = false;
+        if(this->end - this->p < 2 || this->p[0] != 0xFF || this->p[1] != 0xD0 + (n & 7)) invalid("missing restart marker");
+        this->p += 2;
+    }
+
+private:
+    const uint8_t* p;
+    const uint8_t* end;
+    uint64_t buffer = 0;                                                        // -Next bits in the high end
+    unsigned count = 0;
+    bool marker = false;
+
+    void refill() {
+        while(this->count <= 56) {
+            uint8_t byte = 0;
+            if(!this->marker && this->p < this->end) {
+                byte = *this->p;
+                if(byte != 0xFF) {
+                    this->p++;
+                } else if(this->end - this->p >= 2 && this->p[1] == 0x00) {
+                    this->p += 2;
+                } else {
+                    this->marker = true;
+                    byte = 0;
+                }
+            }
+            this->buffer |= static_cast<uint64_t>(byte) << (56 - this->count);
+            this->count += 8;
+        }
+    }
+};
+
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& out_) : out(out_) {}
+
+    void put(uint32_t bits, unsigned n) {                                      // -n <= 16
+        this->buffer = this->buffer << n | (bits & ((1u << n) - 1));
+        this->count += n;
+        while(this->count >= 8) {
+            const uint8_t byte = static_cast<uint8_t>(this->buffer >> (this->count - 8));
+            this->out.push_back(byte);
+            if(byte == 0xFF) this->out.push_back(0x00);
+            this->count -= 8;
+        }
+    }
+
+    void pad() {                                                                // -With one bits, as the standard asks
+        if(this->count > 0) this->put((1u << (8 - this->count)) - 1, 8 - this->count);
+    }
+
+private:
+    std::vector<uint8_t>& out;
+    uint32_t buffer = 0;
+    unsigned count = 0;
+};
+
+/*
+ * Keystream consumed a few bits at a time, MSB first.
+ * */
+class KeyBits {
+public:
+    explicit KeyBits(const std::vector<uint8_t>& bytes_) : bytes(bytes_) {}
+
+    uint32_t take(unsigned n) {
+        uint32_t bits = 0;
+        for(unsigned i = 0; i < n; i++, this->position++) {
+            bits = bits << 1 | ((this->bytes[this->position >> 3] >> (7 - (this->position & 7))) & 1u);
+        }
+        return bits;
+    }
+
+private:
+    const std::vector<uint8_t>& bytes;
+    size_t position = 0;
+};
+
+uint16_t be16(const uint8_t* p) { return static_cast<uint16_t>(p[0] << 8 | p[1]); }
+}
+
+// ---------------------------------------------------------------------------
+// Huffman tables
+// ---------------------------------------------------------------------------
+
+void JpegCoefficients::HuffmanTable::build() {
+    // Canonical codes (JPEG Annex C): consecutive values within a length, doubled when moving to the next length.
+    uint32_t next = 0;
+    size_t k = 0;
+    std::memset(this->lookup, 0, sizeof(this->lookup));
+    std::memset(this->length, 0, sizeof(this->length));
+    for(unsigned l = 1; l <= 16; l++) {
+        this->firstCode[l] = static_cast<int32_t>(next);
+        this->firstSymbol[l] = static_cast<int32_t>(k);
+        for(unsigned i = 0; i < this->counts[l]; i++, k++, next++) {
+            if(next >= (1u << l)) invalid("overfull Huffman table");
+            const uint8_t symbol = this->symbols[k];
+            this->code[symbol] = static_cast<uint16_t>(next);
+            this->length[symbol] = static_cast<uint8_t>(l);
+            if(l <= 9) {
+                const uint32_t first = next << (9 - l);
+                for(uint32_t j = 0; j < (1u << (9 - l)); j++) this->lookup[first + j] = static_cast<uint16_t>(l << 8 | symbol);
+            }
+        }
+        this->maxCode[l] = this->counts[l] > 0 ? static_cast<int32_t>(next) - 1 : -1;
+        next <<= 1;
+    }
+}
+
+namespace {
+template<typename Table>
+uint8_t decode_symbol(BitReader& reader, const Table& table) {
+    const uint16_t entry = table.lookup[reader.peek(9)];
+    if(entry != 0) {
+        reader.skip(entry >> 8);
+        return static_cast<uint8_t>(entry);
+    }
+    const uint32_t bits = reader.peek(16);
+    for(unsigned l = 10; l <= 16; l++) {
+        const int32_t code = static_cast<int32_t>(bits >> (16 - l));
+        if(code <= table.maxCode[l]) {
+            reader.skip(l);
+            return table.symbols[static_cast<size_t>(table.firstSymbol[l] + code - table.firstCode[l])];
+        }
+    }
+    invalid("invalid Huffman code");
+}
+
+template<typename Table>
+void encode_symbol(BitWriter& writer, const Table& table, unsigned symbol) {
+    if(table.length[symbol] == 0) {
+        throw std::runtime_error(
+            "In member function JpegCoefficients::encode() const: symbol " + std::to_string(symbol) +
+            " has no code in the file's Huffman table"
+        );
+    }
+    writer.put(table.code[symbol], table.length[symbol]);
+}
+}
+
+// ---------------------------------------------------------------------------
+// Parsing
+// ---------------------------------------------------------------------------
+
+JpegCoefficients::JpegCoefficients(const std::filesystem::path& path) {
+    const MappedFile file(path, MappedFile::Access::ReadOnly);
+    this->parse(file.data(), file.size(), false);
+}
+
+JpegCoefficients::JpegCoefficients(const uint8_t* data, size_t size) {
+    this->parse(data, size, false);
+}
+
+bool JpegCoefficients::is_baseline(const std::filesystem::path& path) {
+    try {
+        const MappedFile file(path, MappedFile::Access::ReadOnly);
+        JpegCoefficients headers;
+        headers.parse(file.data(), file.size(), true);
+        return true;
+    } catch(const std::exception&) {
+        return false;
+    }
+}
+
+void JpegCoefficients::parse(const uint8_t* data, size_t size, bool headersOnly) {
+    if(data == nullptr || size < 4 || data[0] != 0xFF || data[1] != 0xD8) invalid("not a JPEG file");
+    std::array<std::array<uint16_t, 64>, 4> quantization{};
+    size_t dcSlot[4] = {SIZE_MAX, SIZE_MAX, SIZE_MAX, SIZE_MAX}, acSlot[4] = {SIZE_MAX, SIZE_MAX, SIZE_MAX, SIZE_MAX};
+    std::vector<uint8_t> quantTable;                                            // -Per component
+    std::vector<bool> coded;
+    size_t restartInterval = 0;
+    Segment current;
+    current.bytes.assign(data, data + 2);
+    size_t pos = 2;
+    bool ended = false;
+    while(!ended) {
+        if(pos >= size || data[pos] != 0xFF) invalid("marker expected at offset " + std::to_string(pos));
+        size_t start = pos;
+        while(pos < size && data[pos] == 0xFF) pos++;                           // -Fill bytes
+        if(pos >= size) invalid("truncated file");
+        const uint8_t marker = data[pos++];
+        if(marker == 0xD9) {                                                    // -EOI, kept with any trailing bytes
+            current.bytes.insert(current.bytes.end(), data + start, data + size);
+            ended = true;
+            continue;
+        }
+        if(marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {              // -No length field
+            current.bytes.insert(current.bytes.end(), data + start, data + pos);
+            continue;
+        }
+        if(size - pos < 2) invalid("truncated segment");
+        const size_t length = be16(data + pos);
+        if(length < 2 || size - pos < length) invalid("truncated segment");
+        const uint8_t* p = data + pos + 2;
+        const size_t payload = length - 2;
+        pos += length;
+        current.bytes.insert(current.bytes.end(), data + start, data + pos);
+
+        switch(marker) {
+            case 0xC0:
+            case 0xC1: {                                                        // -Baseline, extended sequential Huffman
+                if(!this->components_.empty()) invalid("several frames");
+                if(payload < 6 || p[0] != 8) invalid("only 8-bit precision is supported");
+                this->height_ = be16(p + 1);
+                this->width_ = be16(p + 3);
+                const size_t count = p[5];
+                if(this->width_ == 0 || this->height_ == 0) invalid("empty image or DNL height");
+                if(count == 0 || count > 4 || payload < 6 + 3 * count) invalid("bad frame header");
+                size_t hmax = 1, vmax = 1;
+                for(size_t i = 0; i < count; i++) {
+                    Component c;
+                    c.id = p[6 + 3 * i];
+                    c.h = static_cast<uint8_t>(p[7 + 3 * i] >> 4);
+                    c.v = static_cast<uint8_t>(p[7 + 3 * i] & 15);
+                    if(c.h < 1 || c.h > 4 || c.v < 1 || c.v > 4 || p[8 + 3 * i] > 3) invalid("bad frame header");
+                    quantTable.push_back(p[8 + 3 * i]);
+                    coded.push_back(false);
+                    hmax = c.h > hmax ? c.h : hmax;
+                    vmax = c.v > vmax ? c.v : vmax;
+                    this->components_.push_back(c);
+                }
+                const size_t mcusX = ceil_div(static_cast<size_t>(this->width_), 8 * hmax);
+                const size_t mcusY = ceil_div(static_cast<size_t>(this->height_), 8 * vmax);
+                for(Component& c : this->components_) {
+                    c.blocksPerLine = mcusX * c.h;
+                    c.blocksPerColumn = mcusY * c.v;
+                    if(!headersOnly) c.coefficients.assign(c.blocksPerLine * c.blocksPerColumn * 64, 0);
+                }
+                break;
+            }
+            case 0xC2: case 0xC3: case 0xC5: case 0xC6: case 0xC7:
+            case 0xC9: case 0xCA: case 0xCB: case 0xCD: case 0xCE: case 0xCF:
+                invalid("only baseline and extended sequential Huffman JPEG is supported (SOF" +
+                        std::to_string(marker - 0xC0) + ")");
+            case 0xC4: {                                                        // -DHT
+                for(size_t i = 0; i < payload;) {
+                    if(payload - i < 17 || (p[i] >> 4) > 1 || (p[i] & 15) > 3) invalid("bad Huffman table");
+                    HuffmanTable table;
+                    size_t total = 0;
+                    for(unsigned l = 1; l <= 16; l++) total += (table.counts[l] = p[i + l]);
+                    if(total > 256 || payload - i - 17 < total) invalid("bad Huffman table");
+                    table.symbols.assign(p + i + 17, p + i + 17 + total);
+                    table.build();
+                    (p[i] >> 4 ? acSlot : dcSlot)[p[i] & 15] = this->tables.size();
+                    this->tables.push_back(table);
+                    i += 17 + total;
+                }
+                break;
+            }
+            case 0xDB: {                                                        // -DQT
+                for(size_t i = 0; i < payload;) {
+                    const bool wide = p[i] >> 4;
+                    const size_t id = p[i] & 15;
+                    if(id > 3 || payload - i < 1 + (wide ? 128u : 64u)) invalid("bad quantization table");
+                    for(size_t k = 0; k < 64; k++) {
+                        quantization[id][k] = wide ? be16(p + i + 1 + 2 * k) : p[i + 1 + k];
+                    }
+                    i += 1 + (wide ? 128 : 64);
+                }
+                break;
+            }
+            case 0xDD:                                                          // -DRI
+                if(payload < 2) invalid("bad restart interval");
+                restartInterval = be16(p);
+                break;
+            case 0xDC:
+                invalid("DNL markers are not supported");
+            case 0xDA: {                                                        // -SOS
+                if(this->components_.empty()) invalid("scan before frame header");
+                const size_t count = payload > 0 ? p[0] : 0;
+                if(count == 0 || count > 4 || payload < 4 + 2 * count) invalid("bad scan header");
+                const uint8_t* tail = p + 1 + 2 * count;
+                if(tail[0] != 0 || tail[1] != 63 || tail[2] != 0) invalid("not a sequential scan");
+                Scan scan;
+                scan.restartInterval = restartInterval;
+                for(size_t i = 0; i < count; i++) {
+                    size_t c = 0;
+                    while(c < this->components_.size() && this->components_[c].id != p[1 + 2 * i]) c++;
+                    if(c == this->components_.size()) invalid("scan of an unknown component");
+                    const size_t dc = dcSlot[p[2 + 2 * i] >> 4 & 3], ac = acSlot[p[2 + 2 * i] & 3];
+                    if(dc == SIZE_MAX || ac == SIZE_MAX) invalid("scan uses an undefined Huffman table");
+                    if(coded[c]) invalid("component coded twice");
+                    coded[c] = true;
+                    this->components_[c].quantization = quantization[quantTable[c]];
+                    scan.components.push_back(ScanComponent{c, dc, ac});
+                }
+                current.scan = static_cast<int>(this->scans.size());
+                this->scans.push_back(scan);
+                this->segments.push_back(std::move(current));
+                current = Segment();
+
+                // Entropy coded data runs to the first marker other than RSTn.
+                size_t end = pos;
+                while(end + 1 < size && !(data[end] == 0xFF && data[end + 1] != 0x00 &&
+                                          (data[end + 1] < 0xD0 || data[end + 1] > 0xD7))) end++;
+                if(end + 1 >= size) invalid("truncated scan");
+                if(!headersOnly) this->decode_scan(this->scans.back(), data + pos, data + end);
+                pos = end;
+                break;
+            }
+            default:                                                            // -APPn, COM and the like
+                break;
+        }
+    }
+    if(this->scans.empty()) invalid("no scan");
+    this->segments.push_back(std::move(current));
+}
+
+// ---------------------------------------------------------------------------
+// Entropy coding
+// ---------------------------------------------------------------------------
+
+template<typename OnBlock, typename OnRestart>
+void JpegCoefficients::traverse(const Scan& scan, OnBlock onBlock, OnRestart onRestart) const {
+    size_t hmax = 1, vmax = 1;
+    for(const Component& c : this->components_) {
+        hmax = c.h > hmax ? c.h : hmax;
+        vmax = c.v > vmax ? c.v : vmax;
+    }
+    const size_t interval = scan.restartInterval;
+    if(scan.components.size() == 1) {
+        // Non-interleaved: every block is an MCU, over the component's own (unpadded) block grid.
+        const size_t c = scan.components[0].component;
+        const Component& component = this->components_[c];
+        const size_t columns = ceil_div(ceil_div(static_cast<size_t>(this->width_) * component.h, hmax), 8);
+        const size_t rows = ceil_div(ceil_div(static_cast<size_t>(this->height_) * component.v, vmax), 8);
+        for(size_t n = 0; n < rows * columns; n++) {
+            if(interval != 0 && n != 0 && n % interval == 0) onRestart();
+            onBlock(size_t(0), c, (n / columns) * component.blocksPerLine + n % columns);
+        }
+        return;
+    }
+    const size_t mcusX = ceil_div(static_cast<size_t>(this->width_), 8 * hmax);
+    const size_t mcusY = ceil_div(static_cast<size_t>(this->height_), 8 * vmax);
+    for(size_t m = 0; m < mcusX * mcusY; m++) {
+        if(interval != 0 && m != 0 && m % interval == 0) onRestart();
+        const size_t mx = m % mcusX, my = m / mcusX;
+        for(size_t k = 0; k < scan.components.size(); k++) {
+            const size_t c = scan.components[k].component;
+            const Component& component = this->components_[c];
+            for(size_t by = 0; by < component.v; by++) {
+                for(size_t bx = 0; bx < component.h; bx++) {
+                    onBlock(k, c, (my * component.v + by) * component.blocksPerLine + mx * component.h + bx);
+                }
+            }
+        }
+    }
+}
+
+void JpegCoefficients::decode_scan(const Scan& scan, const uint8_t* begin, const uint8_t* end) {
+    BitReader reader(begin, end);
+    int predictions[4] = {0, 0, 0, 0};
+    unsigned restarts = 0;
+    this->traverse(scan,
+        [&](size_t k, size_t c, size_t b) {
+            const HuffmanTable& dc = this->tables[scan.components[k].dcTable];
+            const HuffmanTable& ac = this->tables[scan.components[k].acTable];
+            int16_t* block = this->components_[c].coefficients.data() + b * 64;
+            const unsigned s = decode_symbol(reader, dc);
+            if(s > 11) invalid("bad DC difference");
+            predictions[k] += s == 0 ? 0 : extend(reader.get(s), s);
+            block[0] = static_cast<int16_t>(predictions[k]);
+            for(unsigned i = 1; i < 64; i++) {
+                const unsigned rs = decode_symbol(reader, ac), run = rs >> 4, size = rs & 15;
+                if(size == 0) {
+                    if(run != 15) break;                                        // -EOB
+                    i += 15;                                                    // -ZRL: sixteen zeros
+                    continue;
+                }
+                i += run;
+                if(i > 63 || size > 10) invalid("bad AC coefficient");
+                block[i] = static_cast<int16_t>(extend(reader.get(size), size));
+            }
+        },
+        [&]() {
+            reader.restart(restarts++);
+            std::fill(predictions, predictions + 4, 0);
+        });
+}
+
+void JpegCoefficients::encode_scan(const Scan& scan, std::vector<uint8_t>& out) const {
+    BitWriter writer(out);
+    int predictions[4] = {0, 0, 0, 0};
+    unsigned restarts = 0;
+    this->traverse(scan,
+        [&](size_t k, size_t c, size_t b) {
+            const HuffmanTable& dc = this->tables[scan.components[k].dcTable];
+            const HuffmanTable& ac = this->tables[scan.components[k].acTable];
+            const int16_t* block = this->components_[c].coefficients.data() + b * 64;
+            const int difference = block[0] - predictions[k];
+            predictions[k] = block[0];
+            unsigned s = category(difference);
+            encode_symbol(writer, dc, s);
+            if(s > 0) writer.put(amplitude_bits(difference, s), s);
+            unsigned run = 0;
+            for(unsigned i = 1; i < 64; i++) {
+                if(block[i] == 0) {
+                    run++;
+                    continue;
+                }
+                for(; run > 15; run -= 16) encode_symbol(writer, ac, 0xF0);
+                s = category(block[i]);
+                encode_symbol(writer, ac, run << 4 | s);
+                writer.put(amplitude_bits(block[i], s), s);
+                run = 0;
+            }
+            if(run > 0) encode_symbol(writer, ac, 0x00);
+        },
+        [&]() {
+            writer.pad();
+            out.push_back(0xFF);
+            out.push_back(static_cast<uint8_t>(0xD0 + (restarts++ & 7)));
+            std::fill(predictions, predictions + 4, 0);
+        });
+    writer.pad();
+}
+
+std::vector<uint8_t> JpegCoefficients::encode() const {
+    std::vector<uint8_t> out;
+    for(const Segment& segment : this->segments) {
+        out.insert(out.end(), segment.bytes.begin(), segment.bytes.end());
+        if(segment.scan >= 0) this->encode_scan(this->scans[static_cast<size_t>(segment.scan)], out);
+    }
+    return out;
+}
+
+void JpegCoefficients::save(const std::filesystem::path& path) const {
+    const std::vector<uint8_t> bytes = this->encode();
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if(!file) {
+        throw std::runtime_error(
+            "In member function void JpegCoefficients::save(const std::filesystem::path&) const: Could not write file '" +
+            path.string() + "'"
+        );
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Encryption
+// ---------------------------------------------------------------------------
+
+void JpegCoefficients::encrypt(const Encryptor& algorithm) {
+    this->apply_keystream(algorithm, false);
+}
+
+void JpegCoefficients::decrypt(const Encryptor& algorithm) {
+    this->apply_keystream(algorithm, true);
+}
+
+void JpegCoefficients::apply_keystream(const Encryptor& algorithm, bool decrypt) {
+    // One amplitude bit of keystream per coded amplitude bit, categories being the same on both sides.
+    size_t bits = 0;
+    for(const Scan& scan : this->scans) {
+        int predictions[4] = {0, 0, 0, 0};
+        this->traverse(scan,
+            [&](size_t k, size_t c, size_t b) {
+                const int16_t* block = this->components_[c].coefficients.data() + b * 64;
+                bits += category(block[0] - predictions[k]);
+                predictions[k] = block[0];
+                for(unsigned i = 1; i < 64; i++) bits += category(block[i]);
+            },
+            [&]() { std::fill(predictions, predictions + 4, 0); });
+    }
+    const size_t blocks = ceil_div(ceil_div(bits, 8), 16);
+    const std::vector<uint8_t> zeros((blocks < 2 ? 2 : blocks) * 16, 0);
+    std::vector<uint8_t> keystream(zeros.size());
+    algorithm.encryptBytes(zeros.data(), zeros.size(), keystream.data());
+    if(std::memcmp(keystream.data(), keystream.data() + 16, 16) == 0) {
+        throw std::invalid_argument(
+            std::string("In member function void JpegCoefficients::") + (decrypt ? "decrypt" : "encrypt") +
+            "(const Encryptor&): the keystream repeats; use a chaining mode (CBC, OFB, CTR), not ECB"
+        );
+    }
+
+    // Largest |DC| that keeps DC * quantizer within 16 bits (stb_image rejects anything else), less twice the
+    // largest |DC| an 8-bit image produces. Encrypted differences are only taken while the ciphered predictor
+    // plus the difference stays under this bound; once they stop, the ciphered DC is the plain one shifted by a
+    // fixed amount of at most the bound plus one plain DC, so it cannot exceed the limit either.
+    std::vector<int> bound(this->components_.size());
+    for(size_t c = 0; c < bound.size(); c++) {
+        const int q = this->components_[c].quantization[0] > 0 ? this->components_[c].quantization[0] : 1;
+        bound[c] = 32767 / q - 2 * ((1024 + q - 1) / q);
+    }
+
+    KeyBits key(keystream);
+    auto crypt = [](int value, unsigned s, uint32_t mask) { return extend(amplitude_bits(value, s) ^ mask, s); };
+    for(const Scan& scan : this->scans) {
+        int plain[4] = {0, 0, 0, 0}, ciphered[4] = {0, 0, 0, 0};                // -DC predictors
+        this->traverse(scan,
+            [&](size_t k, size_t c, size_t b) {
+                int16_t* block = this->components_[c].coefficients.data() + b * 64;
+                const int difference = block[0] - (decrypt ? ciphered[k] : plain[k]);
+                const unsigned s = category(difference);
+                const uint32_t mask = key.take(s);
+                const bool inRange = std::abs(ciphered[k]) + (1 << s) - 1 <= bound[c];
+                const int other = s > 0 && inRange ? crypt(difference, s, mask) : difference;
+                if(decrypt) {
+                    ciphered[k] = block[0];
+                    plain[k] += other;
+                    block[0] = static_cast<int16_t>(plain[k]);
+                } else {
+                    plain[k] = block[0];
+                    ciphered[k] += other;
+                    block[0] = static_cast<int16_t>(ciphered[k]);
+                }
+                for(unsigned i = 1; i < 64; i++) {
+                    if(block[i] == 0) continue;
+                    const unsigned size = category(block[i]);
+                    block[i] = static_cast<int16_t>(crypt(block[i], size, key.take(size)));
+                }
+            },
+            [&]() {
+                std::fill(plain, plain + 4, 0);
+                std::fill(ciphered, ciphered + 4, 0);
+            });
+    }
+}
@@ -1,4 +1,5 @@
 #include "../include/jpeg_image.hpp"
+#include "../include/jpeg_coefficients.hpp"
 #include "../../third-party/stb/stb_image_write.h"
 #include <stdexcept>
 
@@ -16,17 +17,10 @@ void JPEG::save(const std::filesystem::path& output_path) const {
         );
     }
     const auto& out = output_path.empty() ? this->file_path : output_path;
-    int result;
     if (out.extension() == ".png") {
-        result = stbi_write_png(
-            out.string().c_str(),
-            width_, height_, channels_,
-            this->data.data(),
-            width_ * channels_);
-        if (!result)
-            throw std::runtime_error("JPEG::save(): failed to write PNG file");
+        write_png(out);
     } else {
-        result = stbi_write_jpg(
+        int result = stbi_write_jpg(
             out.string().c_str(),
             width_, height_, channels_,
             this->data.data(),
@@ -36,4 +30,20 @@ void JPEG::save(const std::filesystem::path& output_path) const {
     }
 }
 
+bool JPEG::native_supported(const std::filesystem::path& path) {
+    return JpegCoefficients::is_baseline(path);
+}
+
+void JPEG::encrypt_native_to(const Encryptor& algorithm, const std::filesystem::path& output_path) const {
+    JpegCoefficients coefficients(this->file_path);
+    coefficients.encrypt(algorithm);
+    coefficients.save(output_path);
+}
+
+void JPEG::decrypt_native_to(const Encryptor& algorithm, const std::filesystem::path& output_path) const {
+    JpegCoefficients coefficients(this->file_path);
+    coefficients.decrypt(algorithm);
+    coefficients.save(output_path);
+}
+
 } // namespace File
@@ -0,0 +1,134 @@
+#include"../include/mapped_file.hpp"
+#include<cerrno>
+#include<cstring>
+#include<stdexcept>
+#include<string>
+#include<fcntl.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include<unistd.h>
+
+using namespace File;
+
+static std::runtime_error mappingError(const char* function, const std::filesystem::path& path, const char* what) {
+    return std::runtime_error(
+        std::string("In member function ") + function + ": " + what + " '" + path.string() + "': " + std::strerror(errno)
+    );
+}
+
+MappedFile::MappedFile(const std::filesystem::path& path, Access access): access_(access) {
+    int flags = access == Access::Shared ? O_RDWR : O_RDONLY;
+    this->fd_ = ::open(path.c_str(), flags | O_CLOEXEC);
+    if(this->fd_ < 0) {
+        throw mappingError("MappedFile::MappedFile(const std::filesystem::path&, Access)", path, "Could not open file");
+    }
+    struct stat st;
+    if(::fstat(this->fd_, &st) != 0) {
+        int saved = errno;
+        this->close();
+        errno = saved;
+        throw mappingError("MappedFile::MappedFile(const std::filesystem::path&, Access)", path, "Could not stat file");
+    }
+    this->size_ = static_cast<size_t>(st.st_size);
+    this->map(path);
+}
+
+MappedFile MappedFile::create(const std::filesystem::path& path, size_t size) {
+    MappedFile file;
+    file.access_ = Access::Shared;
+    file.fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(file.fd_ < 0) {
+        throw mappingError("MappedFile::create(const std::filesystem::path&, size_t)", path, "Could not create file");
+    }
+    if(::ftruncate(file.fd_, static_cast<off_t>(size)) != 0) {
+        throw mappingError("MappedFile::create(const std::filesystem::path&, size_t)", path, "Could not resize file");
+    }
+    file.size_ = size;
+    file.map(path);
+    return file;
+}
+
+void MappedFile::map(const std::filesystem::path& path) {
+    if(this->size_ == 0) return;                                                // -mmap rejects zero-length mappings
+    int prot = PROT_READ;
+    int flags = MAP_SHARED;
+    if(this->access_ == Access::Private) {
+        prot |= PROT_WRITE;
+        flags = MAP_PRIVATE;
+    } else if(this->access_ == Access::Shared) {
+        prot |= PROT_WRITE;
+    }
+    void* p = ::mmap(nullptr, this->size_, prot, flags, this->fd_, 0);
+    if(p == MAP_FAILED) {
+        int saved = errno;
+        this->close();
+        errno = saved;
+        throw mappingError("MappedFile::map(const std::filesystem::path&)", path, "Could not map file");
+    }
+    this->data_ = static_cast<uint8_t*>(p);
+    // Hints only: failures are harmless.
+    ::madvise(this->data_, this->size_, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+    ::madvise(this->data_, this->size_, MADV_HUGEPAGE);
+#endif
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept:
+    fd_(other.fd_), data_(other.data_), size_(other.size_), access_(other.access_) {
+    other.fd_ = -1;
+    other.data_ = nullptr;
+    other.size_ = 0;
+}
+
+MappedFile& MappedFile::operator = (MappedFile&& other) noexcept {
+    if(this != &other) {
+        this->close();
+        this->fd_ = other.fd_;
+        this->data_ = other.data_;
+        this->size_ = other.size_;
+        this->access_ = other.access_;
+        other.fd_ = -1;
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    this->close();
+}
+
+void MappedFile::close() {
+    if(this->data_ != nullptr) ::munmap(this->data_, this->size_);
+    if(this->fd_ >= 0) ::close(this->fd_);
+    this->data_ = nullptr;
+    this->size_ = 0;
+    this->fd_ = -1;
+}
+
+uint8_t* MappedFile::data() {
+    return this->data_;
+}
+
+const uint8_t* MappedFile::data() const {
+    return this->data_;
+}
+
+size_t MappedFile::size() const {
+    return this->size_;
+}
+
+bool MappedFile::is_open() const {
+    return this->fd_ >= 0;
+}
+
+MappedFile::Access MappedFile::access() const {
+    return this->access_;
+}
+
+void MappedFile::sync() const {
+    if(this->access_ != Access::Shared || this->data_ == nullptr) return;
+    if(::msync(this->data_, this->size_, MS_SYNC) != 0) {
+        throw std::runtime_error(std::string("In member function void MappedFile::sync(): msync failed: ") + std::strerror(errno));
+    }
+}
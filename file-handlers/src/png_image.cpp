@@ -17,9 +17,8 @@ void PNG::save(const std::filesystem::path& output_path) const {
     }
     const auto& out = output_path.empty() ? this->file_path : output_path;
     const std::string ext = out.extension().string();
-    int result;
     if (ext == ".jpg" || ext == ".jpeg") {
-        result = stbi_write_jpg(
+        int result = stbi_write_jpg(
             out.string().c_str(),
             width_, height_, channels_,
             this->data.data(),
@@ -27,13 +26,7 @@ void PNG::save(const std::filesystem::path& output_path) const {
         if (!result)
             throw std::runtime_error("PNG::save(): failed to write JPEG file");
     } else {
-        result = stbi_write_png(
-            out.string().c_str(),
-            width_, height_, channels_,
-            this->data.data(),
-            width_ * channels_);
-        if (!result)
-            throw std::runtime_error("PNG::save(): failed to write file");
+        write_png(out);
     }
 }
 
@@ -0,0 +1,751 @@
+#include"../include/png_writer.hpp"
+#include"../../analysis/include/data_randomness.hpp"
+#include"../../core-crypto/include/thread_pool.hpp"
+#include<algorithm>
+#include<cmath>
+#include<cstdint>
+#include<cstdlib>
+#include<cstring>
+#include<deque>
+#include<future>
+#include<fstream>
+#include<memory>
+#include<stdexcept>
+#include<string>
+#include<vector>
+
+using namespace File;
+
+// ---------------------------------------------------------------------------
+// Checksums
+// ---------------------------------------------------------------------------
+
+namespace {
+struct CrcTables {
+    uint32_t t[8][256];
+    CrcTables() {
+        for(uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for(int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[0][n] = c;
+        }
+        for(uint32_t n = 0; n < 256; n++) {
+            for(int k = 1; k < 8; k++) t[k][n] = (t[k - 1][n] >> 8) ^ t[0][t[k - 1][n] & 0xFF];
+        }
+    }
+};
+
+const CrcTables& crc_tables() {
+    static const CrcTables tables;
+    return tables;
+}
+
+inline uint32_t load_le32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+           static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+}
+
+uint32_t File::crc32(const uint8_t* data, size_t size, uint32_t crc) {
+    const uint32_t (&t)[8][256] = crc_tables().t;
+    crc = ~crc;
+    // Slicing-by-8: eight table lookups consume eight bytes per iteration instead of one.
+    for(; size >= 8; data += 8, size -= 8) {
+        const uint32_t lo = load_le32(data) ^ crc, hi = load_le32(data + 4);
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+              t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+    }
+    for(; size > 0; data++, size--) crc = t[0][(crc ^ *data) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+uint32_t File::adler32(const uint8_t* data, size_t size, uint32_t adler) {
+    constexpr uint32_t MOD = 65521;
+    constexpr size_t NMAX = 5552;                                               // -Largest run before 'b' may overflow
+    uint32_t a = adler & 0xFFFF, b = adler >> 16;
+    while(size > 0) {
+        size_t n = size < NMAX ? size : NMAX;
+        size -= n;
+        for(; n >= 8; data += 8, n -= 8) {
+            a += data[0]; b += a; a += data[1]; b += a; a += data[2]; b += a; a += data[3]; b += a;
+            a += data[4]; b += a; a += data[5]; b += a; a += data[6]; b += a; a += data[7]; b += a;
+        }
+        for(; n > 0; data++, n--) { a += *data; b += a; }
+        a %= MOD;
+        b %= MOD;
+    }
+    return b << 16 | a;
+}
+
+uint32_t File::adler32_combine(uint32_t adler1, uint32_t adler2, size_t size2) {
+    // Appending n bytes adds their sum to 'a'; 'b' gains n times the previous 'a' plus the appended 'b' (minus the
+    // n that the initial 1 of the second checksum contributed).
+    constexpr uint64_t MOD = 65521;
+    const uint64_t n = size2 % MOD;
+    const uint64_t a1 = adler1 & 0xFFFF, b1 = adler1 >> 16, a2 = adler2 & 0xFFFF, b2 = adler2 >> 16;
+    const uint64_t a = (a1 + a2 + MOD - 1) % MOD;
+    const uint64_t b = (b1 + b2 + n * a1 + MOD - n) % MOD;
+    return static_cast<uint32_t>(b << 16 | a);
+}
+
+// ---------------------------------------------------------------------------
+// Stored PNG encoding
+// ---------------------------------------------------------------------------
+
+namespace {
+void put_be32(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v >> 24);
+    p[1] = static_cast<uint8_t>(v >> 16);
+    p[2] = static_cast<uint8_t>(v >> 8);
+    p[3] = static_cast<uint8_t>(v);
+}
+
+/*
+ * Writes PNG chunks to a stream. IDAT payload is buffered and emitted in chunks of IDAT_BYTES.
+ * */
+class ChunkStream {
+public:
+    static constexpr size_t IDAT_BYTES = 256*1024;
+
+    explicit ChunkStream(std::ofstream& out_) : out(out_) { this->idat.reserve(IDAT_BYTES); }
+
+    void chunk(const char type[4], const uint8_t* data, size_t size) {
+        uint32_t crc = crc32(reinterpret_cast<const uint8_t*>(type), 4);
+        if(size > 0) crc = crc32(data, size, crc);
+        this->chunk(type, data, size, crc);
+    }
+
+    /*
+     * 'crc' covers the type and the data; lets workers checksum their chunks in parallel.
+     * */
+    void chunk(const char type[4], const uint8_t* data, size_t size, uint32_t crc) {
+        uint8_t header[8];
+        put_be32(header, static_cast<uint32_t>(size));
+        std::copy(type, type + 4, header + 4);
+        uint8_t trailer[4];
+        put_be32(trailer, crc);
+        this->out.write(reinterpret_cast<const char*>(header), 8);
+        if(size > 0) this->out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+        this->out.write(reinterpret_cast<const char*>(trailer), 4);
+    }
+
+    void put(const uint8_t* data, size_t size) {
+        while(size > 0) {
+            size_t n = IDAT_BYTES - this->idat.size();
+            if(n > size) n = size;
+            this->idat.insert(this->idat.end(), data, data + n);
+            data += n;
+            size -= n;
+            if(this->idat.size() == IDAT_BYTES) this->flush();
+        }
+    }
+
+    void flush() {
+        if(this->idat.empty()) return;
+        this->chunk("IDAT", this->idat.data(), this->idat.size());
+        this->idat.clear();
+    }
+
+private:
+    std::ofstream& out;
+    std::vector<uint8_t> idat;
+};
+
+/*
+ * zlib stream made of stored deflate blocks. The total length is known upfront, so block headers are inserted
+ * while the data streams through and no block needs to be buffered.
+ * */
+class StoredZlib {
+public:
+    static constexpr size_t MAX_BLOCK = 65535;
+
+    StoredZlib(ChunkStream& sink_, size_t total_) : sink(sink_), remaining(total_) {
+        const uint8_t header[2] = {0x78, 0x01};                                 // -32K window, no preset dictionary
+        this->sink.put(header, 2);
+        if(this->remaining == 0) this->start_block();                          // -A final, empty block
+    }
+
+    void put(const uint8_t* data, size_t size) {
+        this->adler = adler32(data, size, this->adler);
+        while(size > 0) {
+            if(this->inBlock == 0) this->start_block();
+            size_t n = size < this->inBlock ? size : this->inBlock;
+            this->sink.put(data, n);
+            data += n;
+            size -= n;
+            this->inBlock -= n;
+        }
+    }
+
+    void finish() {
+        uint8_t trailer[4];
+        put_be32(trailer, this->adler);
+        this->sink.put(trailer, 4);
+    }
+
+private:
+    ChunkStream& sink;
+    size_t remaining;                                                           // -Bytes not yet covered by a block
+    size_t inBlock = 0;                                                         // -Bytes left in the current block
+    uint32_t adler = 1;
+
+    void start_block() {
+        const size_t len = this->remaining < MAX_BLOCK ? this->remaining : MAX_BLOCK;
+        this->remaining -= len;
+        const uint8_t header[5] = {
+            static_cast<uint8_t>(this->remaining == 0 ? 1 : 0),                // -BFINAL, BTYPE=00
+            static_cast<uint8_t>(len), static_cast<uint8_t>(len >> 8),
+            static_cast<uint8_t>(~len), static_cast<uint8_t>(~len >> 8)
+        };
+        this->sink.put(header, 5);
+        this->inBlock = len;
+    }
+};
+
+const char WRITE[] = "In function PngWriter::write(...)";
+const uint8_t PNG_SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+
+uint8_t color_type(int channels) {
+    static const uint8_t types[5] = {0, 0, 4, 2, 6};                           // -Grey, grey+alpha, RGB, RGBA
+    return types[channels];
+}
+
+/*
+ * 'where' names the caller in exception messages.
+ * */
+std::ofstream open_png(const std::filesystem::path& path, const char* where) {
+    std::ofstream out(path, std::ios::binary);
+    if(!out.is_open()) {
+        throw std::runtime_error(std::string(where) + ": Could not open file '" + path.string() + "'");
+    }
+    out.write(reinterpret_cast<const char*>(PNG_SIGNATURE), 8);
+    return out;
+}
+
+void write_ihdr(ChunkStream& chunks, int width, int height, int channels) {
+    uint8_t ihdr[13];
+    put_be32(ihdr, static_cast<uint32_t>(width));
+    put_be32(ihdr + 4, static_cast<uint32_t>(height));
+    ihdr[8] = 8;                                                                // -Bit depth
+    ihdr[9] = color_type(channels);
+    ihdr[10] = ihdr[11] = ihdr[12] = 0;                                         // -Deflate, adaptive filtering, no interlace
+    chunks.chunk("IHDR", ihdr, sizeof(ihdr));
+}
+
+void close_png(std::ofstream& out, ChunkStream& chunks, const std::filesystem::path& path, const char* where) {
+    chunks.flush();
+    chunks.chunk("IEND", nullptr, 0);
+    out.flush();
+    if(!out) {
+        throw std::runtime_error(std::string(where) + ": Could not write file '" + path.string() + "'");
+    }
+}
+}
+
+// ---------------------------------------------------------------------------
+// Filtered and deflated PNG encoding
+// ---------------------------------------------------------------------------
+
+namespace {
+uint8_t paeth(uint8_t a, uint8_t b, uint8_t c) {
+    const int p = a + b - c, pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    return pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+}
+
+/*
+ * Filters one row with the heuristic of the PNG specification: the filter type whose output has the smallest sum of
+ * absolute values, reading bytes as signed. 'prior' is the unfiltered row above (all zeros for the first row); 'out'
+ * receives the filter type byte followed by rowBytes filtered bytes.
+ * */
+void filter_row(const uint8_t* row, const uint8_t* prior, size_t rowBytes, size_t bpp, uint8_t* out, uint8_t* scratch) {
+    uint64_t best = UINT64_MAX;
+    for(uint8_t type = 0; type < 5; type++) {
+        uint64_t cost = 0;
+        for(size_t x = 0; x < rowBytes; x++) {
+            const uint8_t a = x >= bpp ? row[x - bpp] : 0, b = prior[x], c = x >= bpp ? prior[x - bpp] : 0;
+            uint8_t predictor = 0;
+            switch(type) {
+                case 1: predictor = a; break;
+                case 2: predictor = b; break;
+                case 3: predictor = static_cast<uint8_t>((a + b) / 2); break;
+                case 4: predictor = paeth(a, b, c); break;
+                default: break;
+            }
+            const uint8_t residual = static_cast<uint8_t>(row[x] - predictor);
+            scratch[x] = residual;
+            cost += residual < 128 ? residual : 256u - residual;
+        }
+        if(cost < best) {
+            best = cost;
+            out[0] = type;
+            std::memcpy(out + 1, scratch, rowBytes);
+        }
+    }
+}
+
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& out_) : out(out_) {}
+
+    void put(uint32_t bits, unsigned length) {                                  // -Deflate packs bits LSB first
+        this->buffer |= static_cast<uint64_t>(bits) << this->count;
+        this->count += length;
+        while(this->count >= 8) {
+            this->out.push_back(static_cast<uint8_t>(this->buffer));
+            this->buffer >>= 8;
+            this->count -= 8;
+        }
+    }
+
+    void align() {
+        if(this->count > 0) this->put(0, 8 - this->count);
+    }
+
+private:
+    std::vector<uint8_t>& out;
+    uint64_t buffer = 0;
+    unsigned count = 0;
+};
+
+const uint16_t LENGTH_BASE[29] = {3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258};
+const uint8_t LENGTH_EXTRA[29] = {0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0};
+const uint16_t DIST_BASE[30] = {1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,
+                                8193,12289,16385,24577};
+
+uint32_t reverse_bits(uint32_t code, unsigned bits) {
+    uint32_t r = 0;
+    for(unsigned i = 0; i < bits; i++) r |= ((code >> i) & 1) << (bits - 1 - i);
+    return r;
+}
+
+/*
+ * Fixed Huffman code of RFC 1951 section 3.2.6, bit-reversed for BitWriter.
+ * */
+struct FixedCode {
+    uint16_t lit[288];
+    uint8_t litBits[288];
+    uint8_t dist[30];
+    uint8_t lengthCode[259];                                                    // -Match length -> length code 0..28
+
+    FixedCode() {
+        for(uint32_t v = 0; v < 288; v++) {
+            uint32_t code, bits;
+            if(v < 144)      { code = 0x30 + v;          bits = 8; }
+            else if(v < 256) { code = 0x190 + v - 144;   bits = 9; }
+            else if(v < 280) { code = v - 256;           bits = 7; }
+            else             { code = 0xC0 + v - 280;    bits = 8; }
+            this->lit[v] = static_cast<uint16_t>(reverse_bits(code, bits));
+            this->litBits[v] = static_cast<uint8_t>(bits);
+        }
+        for(uint32_t d = 0; d < 30; d++) this->dist[d] = static_cast<uint8_t>(reverse_bits(d, 5));
+        for(uint8_t c = 0; c < 29; c++) {
+            for(uint32_t len = LENGTH_BASE[c]; len < LENGTH_BASE[c] + (1u << LENGTH_EXTRA[c]) && len <= 258; len++) {
+                this->lengthCode[len] = c;
+            }
+        }
+    }
+};
+
+const FixedCode& fixed_code() {
+    static const FixedCode code;
+    return code;
+}
+
+unsigned distance_code(size_t distance) {
+    if(distance <= 4) return static_cast<unsigned>(distance - 1);
+    const uint32_t v = static_cast<uint32_t>(distance - 1);
+    const unsigned msb = 31u - static_cast<unsigned>(__builtin_clz(v));
+    return 2 * msb + ((v >> (msb - 1)) & 1);
+}
+
+/*
+ * Compresses data[history, size) as one deflate block: LZ77 over hash chains, encoded with the fixed Huffman code (the
+ * same choice stb_image_write makes). Unless 'final', the block is followed by an empty stored block, a sync flush that
+ * leaves the output byte aligned, so pieces compressed independently can be concatenated into one stream, as pigz does.
+ *
+ * The hash chains (256 KiB) are kept between calls instead of being allocated and cleared for each block. Positions
+ * are stored as 32-bit offsets from 'base' in a virtual stream that only grows: a call with 'history' > 0 continues
+ * the previous one, its first 'history' bytes being the last bytes of the previous data and already in the chains,
+ * while a call with 'history' == 0 starts after the previous data and ignores every older entry. When offsets near
+ * 32 bits, base moves up and entries out of the window are dropped (rebase).
+ * */
+class Deflater {
+public:
+    Deflater() : head(HASH_SIZE, NONE), prev(WINDOW, NONE) {}
+
+    void compress(const uint8_t* data, size_t history, size_t size, bool final, std::vector<uint8_t>& out) {
+        const FixedCode& fc = fixed_code();
+        const uint64_t origin = this->next - history;                           // -Virtual position of data[0]
+        this->next = origin + size;
+        auto hash = [data](size_t i) {
+            const uint32_t v = static_cast<uint32_t>(data[i]) << 16 | static_cast<uint32_t>(data[i + 1]) << 8 | data[i + 2];
+            return (v * 2654435761u) >> (32 - HASH_BITS);
+        };
+        auto insert = [&](size_t i, uint32_t h) {
+            const uint64_t v = origin + i;
+            if(v - this->base >= NONE) this->rebase(v - WINDOW);
+            const uint32_t stored = static_cast<uint32_t>(v - this->base);
+            this->prev[stored & (WINDOW - 1)] = this->head[h];
+            this->head[h] = stored;
+        };
+
+        // The previous call could not hash its last MIN_MATCH - 1 positions; the bytes after them are here now.
+        for(size_t i = history >= MIN_MATCH - 1 ? history - (MIN_MATCH - 1) : 0; i < history && i + MIN_MATCH <= size; i++) {
+            insert(i, hash(i));
+        }
+
+        BitWriter bits(out);
+        bits.put(final ? 1 : 0, 1);
+        bits.put(1, 2);                                                         // -BTYPE=01, fixed Huffman
+        for(size_t i = history; i < size;) {
+            size_t bestLen = 0, bestDist = 0;
+            if(i + MIN_MATCH <= size) {
+                const uint32_t h = hash(i);
+                const uint64_t v = origin + i;
+                const size_t maxLen = size - i < MAX_MATCH ? size - i : MAX_MATCH;
+                uint32_t entry = this->head[h];
+                for(size_t chain = MAX_CHAIN; entry != NONE && chain > 0; chain--) {
+                    const uint64_t cv = this->base + entry;
+                    if(cv < origin || v - cv > WINDOW) break;                   // -Before this data, or out of the window
+                    const size_t candidate = static_cast<size_t>(cv - origin);
+                    if(data[candidate + bestLen] == data[i + bestLen]) {
+                        size_t len = 0;
+                        while(len < maxLen && data[candidate + len] == data[i + len]) len++;
+                        if(len > bestLen) {
+                            bestLen = len;
+                            bestDist = i - candidate;
+                            if(len == maxLen) break;
+                        }
+                    }
+                    const uint32_t older = this->prev[entry & (WINDOW - 1)];
+                    if(older == NONE || older >= entry) break;                  // -Slot reused by a newer position
+                    entry = older;
+                }
+                insert(i, h);
+            }
+            if(bestLen >= MIN_MATCH) {
+                const unsigned lc = fc.lengthCode[bestLen], symbol = 257 + lc;
+                bits.put(fc.lit[symbol], fc.litBits[symbol]);
+                if(LENGTH_EXTRA[lc] > 0) bits.put(static_cast<uint32_t>(bestLen - LENGTH_BASE[lc]), LENGTH_EXTRA[lc]);
+                const unsigned dc = distance_code(bestDist);
+                bits.put(fc.dist[dc], 5);
+                if(dc >= 4) bits.put(static_cast<uint32_t>(bestDist - DIST_BASE[dc]), dc / 2 - 1);
+                for(size_t k = 1; k < bestLen; k++) {
+                    if(i + k + MIN_MATCH <= size) insert(i + k, hash(i + k));
+                }
+                i += bestLen;
+            } else {
+                bits.put(fc.lit[data[i]], fc.litBits[data[i]]);
+                i++;
+            }
+        }
+        bits.put(fc.lit[256], fc.litBits[256]);                                // -End of block
+        if(!final) {
+            bits.put(0, 3);                                                     // -Empty stored block: BFINAL=0, BTYPE=00
+            bits.align();
+            const uint8_t empty[4] = {0x00, 0x00, 0xFF, 0xFF};
+            out.insert(out.end(), empty, empty + 4);
+        }
+        bits.align();
+    }
+
+private:
+    static constexpr size_t WINDOW = 32768, MIN_MATCH = 3, MAX_MATCH = 258, MAX_CHAIN = 32;
+    static constexpr unsigned HASH_BITS = 15;
+    static constexpr size_t HASH_SIZE = size_t(1) << HASH_BITS;
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    std::vector<uint32_t> head, prev;
+    uint64_t base = 0;                                                          // -Virtual position stored as 0
+    uint64_t next = 0;                                                          // -Virtual position after the last data
+
+    void rebase(uint64_t newBase) {
+        auto shift = [this, newBase](uint32_t& entry) {
+            if(entry == NONE) return;
+            const uint64_t v = this->base + entry;
+            entry = v < newBase ? NONE : static_cast<uint32_t>(v - newBase);
+        };
+        for(uint32_t& entry : this->head) shift(entry);
+        for(uint32_t& entry : this->prev) shift(entry);
+        this->base = newBase;
+    }
+};
+
+struct EncodedBand {
+    std::vector<uint8_t> idat;                                                  // -Payload of one IDAT chunk
+    uint32_t crc = 0;
+    uint32_t adler = 1;                                                         // -Of the filtered (uncompressed) rows
+    size_t rawBytes = 0;
+};
+
+EncodedBand encode_band(const uint8_t* pixels, size_t rowBytes, size_t bpp, size_t y0, size_t y1, bool first, bool last) {
+    EncodedBand band;
+    band.rawBytes = (y1 - y0) * (rowBytes + 1);
+    std::vector<uint8_t> filtered(band.rawBytes), scratch(rowBytes);
+    const std::vector<uint8_t> zeros(y0 == 0 ? rowBytes : 0, 0);
+    for(size_t y = y0; y < y1; y++) {
+        const uint8_t* prior = y == 0 ? zeros.data() : pixels + (y - 1) * rowBytes;
+        filter_row(pixels + y * rowBytes, prior, rowBytes, bpp, filtered.data() + (y - y0) * (rowBytes + 1), scratch.data());
+    }
+    band.adler = adler32(filtered.data(), filtered.size());
+    band.idat.reserve(filtered.size() / 2);
+    if(first) {
+        band.idat.push_back(0x78);                                              // -zlib header: deflate, 32K window
+        band.idat.push_back(0x01);
+    }
+    thread_local Deflater deflater;                                             // -One set of hash chains per band worker
+    deflater.compress(filtered.data(), 0, filtered.size(), last, band.idat);
+    band.crc = crc32(band.idat.data(), band.idat.size(), crc32(reinterpret_cast<const uint8_t*>("IDAT"), 4));
+    return band;
+}
+
+/*
+ * Rows are split into bands of about BAND_BYTES that workers filter and compress independently; the writer emits one
+ * IDAT chunk per band in order and combines the bands' Adler-32 into the zlib trailer.
+ * */
+void write_deflated(const std::filesystem::path& path, const uint8_t* pixels, int width, int height, int channels,
+                    const PngWriter::Options& options) {
+    constexpr size_t BAND_BYTES = 1024*1024;
+    const size_t rowBytes = static_cast<size_t>(width) * static_cast<size_t>(channels);
+    const size_t rows = static_cast<size_t>(height);
+    const size_t bandRows = rowBytes + 1 >= BAND_BYTES ? 1 : BAND_BYTES / (rowBytes + 1);
+    const size_t bands = (rows + bandRows - 1) / bandRows;
+    auto encode = [=](size_t b) {
+        const size_t y0 = b * bandRows, y1 = y0 + bandRows < rows ? y0 + bandRows : rows;
+        return encode_band(pixels, rowBytes, static_cast<size_t>(channels), y0, y1, b == 0, b == bands - 1);
+    };
+
+    std::unique_ptr<CipherFortis::ThreadPool> ownPool;
+    CipherFortis::ThreadPool* pool = nullptr;
+    if(options.threads != 1 && bands > 1) {
+        if(options.threads == 0) {
+            pool = &CipherFortis::ThreadPool::shared();
+        } else {
+            CipherFortis::ThreadPool::Config config;
+            config.threadCount = options.threads;
+            ownPool = std::make_unique<CipherFortis::ThreadPool>(config);
+            pool = ownPool.get();
+        }
+        if(pool->isWorkerThread()) pool = nullptr;                              // -Blocking on our own workers could deadlock
+    }
+
+    std::ofstream out = open_png(path, WRITE);
+    ChunkStream chunks(out);
+    write_ihdr(chunks, width, height, channels);
+    uint32_t adler = 1;
+    auto emit = [&](const EncodedBand& band) {
+        chunks.chunk("IDAT", band.idat.data(), band.idat.size(), band.crc);
+        adler = adler32_combine(adler, band.adler, band.rawBytes);
+    };
+    if(pool == nullptr) {
+        for(size_t b = 0; b < bands; b++) emit(encode(b));
+    } else {
+        // At most 2 bands per worker are in flight, bounding memory to a few compressed bands.
+        const size_t window = 2 * pool->getThreadCount();
+        std::deque<std::future<EncodedBand>> inFlight;
+        size_t next = 0;
+        for(size_t b = 0; b < bands; b++) {
+            while(next < bands && inFlight.size() < window) {
+                const size_t index = next++;
+                inFlight.push_back(pool->async([encode, index]() { return encode(index); }));
+            }
+            EncodedBand band = inFlight.front().get();
+            inFlight.pop_front();
+            emit(band);
+        }
+    }
+    uint8_t trailer[4];
+    put_be32(trailer, adler);
+    chunks.chunk("IDAT", trailer, 4);
+    close_png(out, chunks, path, WRITE);
+}
+}
+
+// ---------------------------------------------------------------------------
+// PngStreamWriter
+// ---------------------------------------------------------------------------
+
+namespace {
+const char STREAM_OPEN[] = "In member function PngStreamWriter::PngStreamWriter(...)";
+const char STREAM_FINISH[] = "In member function PngStreamWriter::finish()";
+}
+
+struct PngStreamWriter::State {
+    static constexpr size_t WINDOW = 32768;                                     // -Deflate history kept between groups
+    static constexpr size_t GROUP = 128*1024;                                   // -Filtered bytes compressed per call
+
+    std::filesystem::path path;
+    size_t rowBytes, channels, height, rows = 0;
+    PngCompression compression;
+    std::ofstream out;
+    ChunkStream chunks;
+    std::unique_ptr<StoredZlib> stored;
+    // Deflate state: the unfiltered previous row, and filtered bytes waiting for compression after WINDOW bytes of
+    // history.
+    std::vector<uint8_t> prior, scratch, pending, compressed;
+    size_t history = 0;
+    std::unique_ptr<Deflater> deflater;
+    uint32_t adler = 1;
+
+    State(const std::filesystem::path& path_, int width, int height_, int channels_, PngCompression compression_)
+    : path(path_), rowBytes(static_cast<size_t>(width) * static_cast<size_t>(channels_)),
+      channels(static_cast<size_t>(channels_)), height(static_cast<size_t>(height_)), compression(compression_),
+      out(open_png(path_, STREAM_OPEN)), chunks(out) {
+        write_ihdr(this->chunks, width, height_, channels_);
+    }
+
+    void begin(const uint8_t* rows_, size_t count) {
+        if(this->compression == PngCompression::Auto) this->compression = PngWriter::choose(rows_, count * this->rowBytes);
+        if(this->compression == PngCompression::Stored) {
+            this->stored = std::make_unique<StoredZlib>(this->chunks, (this->rowBytes + 1) * this->height);
+        } else {
+            this->prior.assign(this->rowBytes, 0);
+            this->scratch.resize(this->rowBytes);
+            this->pending.reserve(WINDOW + GROUP + this->rowBytes + 1);
+            this->deflater = std::make_unique<Deflater>();
+            const uint8_t header[2] = {0x78, 0x01};
+            this->chunks.put(header, 2);
+        }
+    }
+
+    void put_row(const uint8_t* row) {
+        if(this->stored) {
+            const uint8_t filterNone = 0;
+            this->stored->put(&filterNone, 1);
+            this->stored->put(row, this->rowBytes);
+            return;
+        }
+        const size_t at = this->pending.size();
+        this->pending.resize(at + this->rowBytes + 1);
+        filter_row(row, this->prior.data(), this->rowBytes, this->channels, this->pending.data() + at, this->scratch.data());
+        this->adler = adler32(this->pending.data() + at, this->rowBytes + 1, this->adler);
+        std::memcpy(this->prior.data(), row, this->rowBytes);
+        if(this->pending.size() - this->history >= GROUP) this->compress(false);
+    }
+
+    void compress(bool final) {
+        this->deflater->compress(this->pending.data(), this->history, this->pending.size(), final, this->compressed);
+        this->chunks.put(this->compressed.data(), this->compressed.size());
+        this->compressed.clear();
+        const size_t keep = this->pending.size() < WINDOW ? this->pending.size() : WINDOW;
+        this->pending.erase(this->pending.begin(), this->pending.end() - static_cast<std::ptrdiff_t>(keep));
+        this->history = keep;
+    }
+
+    void finish() {
+        if(this->stored) {
+            this->stored->finish();
+        } else {
+            this->compress(true);
+            uint8_t trailer[4];
+            put_be32(trailer, this->adler);
+            this->chunks.put(trailer, 4);
+        }
+        close_png(this->out, this->chunks, this->path, STREAM_FINISH);
+    }
+};
+
+PngStreamWriter::PngStreamWriter(const std::filesystem::path& path, int width, int height, int channels,
+                                 PngCompression compression) {
+    if(width <= 0 || height <= 0 || channels < 1 || channels > 4) {
+        throw std::invalid_argument(
+            std::string(STREAM_OPEN) + ": invalid image (" + std::to_string(width) + "x" + std::to_string(height) +
+            ", " + std::to_string(channels) + " channels)"
+        );
+    }
+    this->state = std::make_unique<State>(path, width, height, channels, compression);
+}
+
+PngStreamWriter::PngStreamWriter(PngStreamWriter&&) noexcept = default;
+PngStreamWriter& PngStreamWriter::operator = (PngStreamWriter&&) noexcept = default;
+PngStreamWriter::~PngStreamWriter() = default;
+
+void PngStreamWriter::write_rows(const uint8_t* rows, size_t count) {
+    if(this->state == nullptr) {
+        throw std::logic_error("In member function PngStreamWriter::write_rows(...): writer is finished");
+    }
+    if(count > this->state->height - this->state->rows) {
+        throw std::invalid_argument(
+            "In member function PngStreamWriter::write_rows(...): " + std::to_string(count) + " rows exceed the " +
+            std::to_string(this->state->height - this->state->rows) + " still expected"
+        );
+    }
+    if(count == 0) return;
+    if(rows == nullptr) {
+        throw std::invalid_argument("In member function PngStreamWriter::write_rows(...): null rows");
+    }
+    if(this->state->rows == 0) this->state->begin(rows, count);
+    for(size_t y = 0; y < count; y++) this->state->put_row(rows + y * this->state->rowBytes);
+    this->state->rows += count;
+}
+
+size_t PngStreamWriter::rows_written() const {
+    return this->state == nullptr ? 0 : this->state->rows;
+}
+
+void PngStreamWriter::finish() {
+    if(this->state == nullptr) {
+        throw std::logic_error(std::string(STREAM_FINISH) + ": writer is finished");
+    }
+    if(this->state->rows != this->state->height) {
+        throw std::logic_error(
+            std::string(STREAM_FINISH) + ": " + std::to_string(this->state->rows) + " of " +
+            std::to_string(this->state->height) + " rows written"
+        );
+    }
+    this->state->finish();
+    this->state.reset();
+}
+
+// ---------------------------------------------------------------------------
+// PngWriter
+// ---------------------------------------------------------------------------
+
+PngCompression PngWriter::choose(const uint8_t* pixels, size_t size) {
+    // Sixteen windows spread over the image. A 64 KiB random sample has ~7.997 bits of entropy per byte and an
+    // adjacent-byte correlation within +-0.01; photographs stay below 7.9 bits, and smooth content with a flat
+    // histogram (gradients) is caught by its correlation.
+    constexpr size_t WINDOWS = 16, WINDOW_BYTES = 4096, MIN_BYTES = 4096;
+    constexpr double RANDOM_ENTROPY = 7.9, RANDOM_CORRELATION = 0.05;
+    if(pixels == nullptr || size < MIN_BYTES) return PngCompression::Deflate;
+    std::vector<std::byte> sample;
+    const uint8_t* begin = pixels;
+    if(size <= WINDOWS * WINDOW_BYTES) {
+        sample.assign(reinterpret_cast<const std::byte*>(begin), reinterpret_cast<const std::byte*>(begin + size));
+    } else {
+        const size_t step = (size - WINDOW_BYTES) / (WINDOWS - 1);
+        for(size_t w = 0; w < WINDOWS; w++) {
+            const std::byte* window = reinterpret_cast<const std::byte*>(begin + w * step);
+            sample.insert(sample.end(), window, window + WINDOW_BYTES);
+        }
+    }
+    const DataRandomness randomness(sample);
+    const bool random = randomness.getEntropy() >= RANDOM_ENTROPY &&
+                        std::fabs(randomness.getCorrelationAdjacentByte()) < RANDOM_CORRELATION;
+    return random ? PngCompression::Stored : PngCompression::Deflate;
+}
+
+void PngWriter::write(const std::filesystem::path& path, const uint8_t* pixels, int width, int height, int channels) {
+    write(path, pixels, width, height, channels, Options());
+}
+
+void PngWriter::write(const std::filesystem::path& path, const uint8_t* pixels, int width, int height, int channels,
+                      const Options& options) {
+    if(pixels == nullptr || width <= 0 || height <= 0 || channels < 1 || channels > 4) {
+        throw std::invalid_argument(
+            "In function PngWriter::write(...): invalid image (" + std::to_string(width) + "x" + std::to_string(height) +
+            ", " + std::to_string(channels) + " channels)"
+        );
+    }
+    const size_t size = static_cast<size_t>(width) * static_cast<size_t>(height) * static_cast<size_t>(channels);
+    PngCompression compression = options.compression;
+    if(compression == PngCompression::Auto) compression = choose(pixels, size);
+
+    if(compression == PngCompression::Deflate && size >= options.parallelThreshold) {
+        write_deflated(path, pixels, width, height, channels, options);
+        return;
+    }
+    PngStreamWriter writer(path, width, height, channels, compression);
+    writer.write_rows(pixels, static_cast<size_t>(height));
+    writer.finish();
+}
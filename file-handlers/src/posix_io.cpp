@@ -0,0 +1,42 @@
+#include"posix_io.hpp"
+#include<cstring>
+#include<unistd.h>
+
+using namespace File;
+
+PosixIO::FileDescriptor::~FileDescriptor() {
+    if(this->fd >= 0) ::close(this->fd);
+}
+
+std::runtime_error PosixIO::io_error(const std::string& where, const std::string& what, const std::filesystem::path& path,
+                                     int error) {
+    return std::runtime_error(where + ": " + what + " '" + path.string() + "': " + std::strerror(error));
+}
+
+size_t PosixIO::read_full(int fd, uint8_t* buffer, size_t size, off_t offset, const std::filesystem::path& path,
+                          const std::string& where) {
+    size_t got = 0;
+    while(got < size) {
+        ssize_t r = ::pread(fd, buffer + got, size - got, offset + static_cast<off_t>(got));
+        if(r < 0) {
+            if(errno == EINTR) continue;
+            throw io_error(where, "Could not read file", path);
+        }
+        if(r == 0) break;
+        got += static_cast<size_t>(r);
+    }
+    return got;
+}
+
+void PosixIO::write_full(int fd, const uint8_t* buffer, size_t size, off_t offset, const std::filesystem::path& path,
+                         const std::string& where) {
+    size_t written = 0;
+    while(written < size) {
+        ssize_t w = ::pwrite(fd, buffer + written, size - written, offset + static_cast<off_t>(written));
+        if(w < 0) {
+            if(errno == EINTR) continue;
+            throw io_error(where, "Could not write file", path);
+        }
+        written += static_cast<size_t>(w);
+    }
+}
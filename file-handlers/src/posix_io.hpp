@@ -0,0 +1,40 @@
+#ifndef POSIX_IO_HPP
+#define POSIX_IO_HPP
+
+#include<cerrno>
+#include<cstddef>
+#include<cstdint>
+#include<filesystem>
+#include<stdexcept>
+#include<string>
+#include<sys/types.h>
+
+// Descriptor-level helpers shared by the file handlers that bypass iostreams. Internal: not installed with the
+// library headers. 'where' is the prefix of every error message, e.g. "In member function ...(...)".
+namespace File {
+namespace PosixIO {
+
+// Closes on scope exit so every error path releases its descriptor.
+struct FileDescriptor {
+    int fd = -1;
+    FileDescriptor() = default;
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator = (const FileDescriptor&) = delete;
+    ~FileDescriptor();
+};
+
+// "<where>: <what> '<path>': <strerror(error)>"
+std::runtime_error io_error(const std::string& where, const std::string& what, const std::filesystem::path& path,
+                            int error = errno);
+
+// Reads until 'size' bytes or end of file; returns the number of bytes read.
+size_t read_full(int fd, uint8_t* buffer, size_t size, off_t offset, const std::filesystem::path& path,
+                 const std::string& where);
+
+void write_full(int fd, const uint8_t* buffer, size_t size, off_t offset, const std::filesystem::path& path,
+                const std::string& where);
+
+} // namespace PosixIO
+} // namespace File
+
+#endif // POSIX_IO_HPP
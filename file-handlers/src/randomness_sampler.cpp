@@ -0,0 +1,180 @@
+#include"../include/randomness_sampler.hpp"
+#include"../../analysis/include/byte_moments.hpp"
+#include"../../analysis/include/randomness_accumulator.hpp"
+#include"posix_io.hpp"
+#include<cmath>
+#include<random>
+#include<set>
+#include<stdexcept>
+#include<string>
+#include<vector>
+#include<fcntl.h>
+#include<sys/stat.h>
+
+using namespace File;
+using PosixIO::FileDescriptor;
+using PosixIO::io_error;
+using PosixIO::read_full;
+
+namespace {
+
+const size_t SCAN_CHUNK = 4*1024*1024;                                          // -Read size of a full scan
+
+size_t open_for_reading(FileDescriptor& file, const std::filesystem::path& path, const char* where) {
+    file.fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(file.fd < 0) throw io_error(where, "Could not open file", path);
+    struct stat st;
+    if(::fstat(file.fd, &st) != 0) throw io_error(where, "Could not stat file", path);
+    if(st.st_size == 0) {
+        throw std::invalid_argument(std::string(where) + ": empty file '" + path.string() + "'");
+    }
+    return static_cast<size_t>(st.st_size);
+}
+
+struct Metrics {
+    double entropy;
+    double chiSquare;
+    double correlation;
+};
+
+Metrics metrics_of(const ByteMoments& m) {
+    return {m.entropy(), m.chiSquare(), m.correlation(0)};
+}
+
+// The chi-square threshold is already a test at a fixed level on the statistic itself, whose spread over uniform data
+// (about 22.6 for 255 degrees of freedom) does not shrink with the sample; its interval would count that spread twice.
+bool passes(const RandomnessSampler::Config& config, const RandomnessSampler::Report& r) {
+    return r.entropy.low >= config.minEntropy &&                                // -False for NaN bounds too
+           r.chiSquare.value <= config.maxChiSquare &&
+           std::fabs(r.correlation.low) <= config.maxAbsCorrelation &&
+           std::fabs(r.correlation.high) <= config.maxAbsCorrelation;
+}
+
+RandomnessSampler::Report scan_descriptor(const RandomnessSampler::Config& config, int fd, size_t size,
+                                          const std::filesystem::path& path, const char* where) {
+    RandomnessAccumulator accumulator;
+    std::vector<uint8_t> buffer(size < SCAN_CHUNK ? size : SCAN_CHUNK);
+    size_t offset = 0;
+    while(offset < size) {
+        const size_t got = read_full(fd, buffer.data(), buffer.size(), static_cast<off_t>(offset), path, where);
+        if(got == 0) break;                                                     // -Truncated meanwhile: measure what is there
+        accumulator.update(buffer.data(), got);
+        offset += got;
+    }
+    if(accumulator.count() == 0) {
+        throw std::runtime_error(std::string(where) + ": no bytes read from '" + path.string() + "'");
+    }
+    const Metrics exact = metrics_of(accumulator.finalize());
+    RandomnessSampler::Report report;
+    report.fileBytes = size;
+    report.bytesRead = accumulator.count();
+    report.fullScan = true;
+    report.entropy = {exact.entropy, exact.entropy, exact.entropy};
+    report.chiSquare = {exact.chiSquare, exact.chiSquare, exact.chiSquare};
+    report.correlation = {exact.correlation, exact.correlation, exact.correlation};
+    report.passed = passes(config, report);
+    return report;
+}
+
+/*
+ * Pooled value and jackknife interval: theta_i is the metric without block i, and the variance of the pooled value is
+ * estimated as (k-1)/k * sum (theta_i - mean theta_i)^2.
+ * */
+RandomnessSampler::Estimate jackknife(double pooled, const std::vector<double>& leaveOneOut, double z) {
+    const double k = static_cast<double>(leaveOneOut.size());
+    double mean = 0.0, squares = 0.0;
+    for(double v : leaveOneOut) mean += v;
+    mean /= k;
+    for(double v : leaveOneOut) squares += (v - mean)*(v - mean);
+    const double halfWidth = z * std::sqrt((k - 1.0) / k * squares);
+    return {pooled, pooled - halfWidth, pooled + halfWidth};
+}
+
+} // namespace
+
+RandomnessSampler::RandomnessSampler() : RandomnessSampler(Config()) {}
+
+RandomnessSampler::RandomnessSampler(const Config& config_) : config(config_) {
+    if(config_.blockBytes == 0 || config_.blocks < 2) {
+        throw std::invalid_argument(
+            "In constructor RandomnessSampler::RandomnessSampler(const Config&): need a nonzero block size and at least "
+            "2 blocks (got " + std::to_string(config_.blockBytes) + " bytes, " + std::to_string(config_.blocks) + " blocks)"
+        );
+    }
+}
+
+RandomnessSampler::Report RandomnessSampler::scan(const std::filesystem::path& path) const {
+    const char where[] = "In member function RandomnessSampler::Report RandomnessSampler::scan(const std::filesystem::path&) const";
+    FileDescriptor in;
+    const size_t size = open_for_reading(in, path, where);
+    return scan_descriptor(this->config, in.fd, size, path, where);
+}
+
+RandomnessSampler::Report RandomnessSampler::analyze(const std::filesystem::path& path) const {
+    const char where[] = "In member function RandomnessSampler::Report RandomnessSampler::analyze(const std::filesystem::path&) const";
+    FileDescriptor in;
+    const size_t size = open_for_reading(in, path, where);
+    const size_t blockBytes = this->config.blockBytes;
+    const uint64_t totalBlocks = (size - 1) / blockBytes + 1;
+    if(this->config.blocks * 2 >= totalBlocks) return scan_descriptor(this->config, in.fd, size, path, where);
+
+    // Floyd's algorithm: 'blocks' distinct indices below totalBlocks, visited in file order
+    uint64_t seed = this->config.seed;
+    if(seed == 0) {
+        std::random_device device;
+        seed = static_cast<uint64_t>(device()) << 32 | device();
+    }
+    std::mt19937_64 rng(seed);
+    std::set<uint64_t> chosen;
+    for(uint64_t j = totalBlocks - this->config.blocks; j < totalBlocks; j++) {
+        const uint64_t t = std::uniform_int_distribution<uint64_t>(0, j)(rng);
+        chosen.insert(chosen.count(t) != 0 ? j : t);
+    }
+
+    std::vector<uint8_t> buffer(blockBytes);
+    std::vector<ByteMoments> parts;
+    parts.reserve(chosen.size());
+    ByteMoments pooled;
+    pooled.lags = {1};
+    pooled.lagProducts = {0};
+    Report report;
+    report.fileBytes = size;
+    for(uint64_t index : chosen) {
+        const size_t offset = static_cast<size_t>(index) * blockBytes;
+        const size_t length = size - offset < blockBytes ? size - offset : blockBytes;
+        const size_t got = read_full(in.fd, buffer.data(), length, static_cast<off_t>(offset), path, where);
+        if(got != length) {
+            throw std::runtime_error(std::string(where) + ": '" + path.string() + "' shrank while sampled");
+        }
+        parts.push_back(ByteMoments::measure(buffer.data(), got, {1}));
+        const ByteMoments& part = parts.back();
+        for(size_t v = 0; v < 256; v++) pooled.histogram[v] += part.histogram[v];
+        pooled.count += part.count;
+        pooled.lagProducts[0] += part.lagProducts[0];
+        report.bytesRead += got;
+    }
+
+    const Metrics estimate = metrics_of(pooled);
+    std::vector<double> entropy, chiSquare, correlation;
+    for(const ByteMoments& part : parts) {                                      // -Integer moments: exact subtraction
+        ByteMoments rest = pooled;
+        for(size_t v = 0; v < 256; v++) rest.histogram[v] -= part.histogram[v];
+        rest.count -= part.count;
+        rest.lagProducts[0] -= part.lagProducts[0];
+        const Metrics m = metrics_of(rest);
+        entropy.push_back(m.entropy);
+        chiSquare.push_back(m.chiSquare);
+        correlation.push_back(m.correlation);
+    }
+    report.entropy = jackknife(estimate.entropy, entropy, this->config.z);
+    report.chiSquare = jackknife(estimate.chiSquare, chiSquare, this->config.z);
+    report.correlation = jackknife(estimate.correlation, correlation, this->config.z);
+    report.passed = passes(this->config, report);
+
+    if(!report.passed && this->config.escalate) {
+        const uint64_t sampled = report.bytesRead;
+        report = scan_descriptor(this->config, in.fd, size, path, where);
+        report.bytesRead += sampled;
+    }
+    return report;
+}
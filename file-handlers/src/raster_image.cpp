@@ -1,5 +1,13 @@
 #include "../include/raster_image.hpp"
+#include "../include/tile_grid.hpp"
+#include "../../core-crypto/include/cipher.hpp"
+#include "../../core-crypto/include/thread_pool.hpp"
+#include "../../analysis/include/image_correlation.hpp"
 #include "../../third-party/stb/stb_image.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <future>
 #include <stdexcept>
 #include <string>
 
@@ -19,8 +27,188 @@ void RasterImage::load() {
     width_    = w;
     height_   = h;
     channels_ = ch;
-    this->data.assign(pixels, pixels + w * h * ch);
-    stbi_image_free(pixels);
+    // Adopted, not copied: the decoded image is encrypted where stb put it and freed by stb's own allocator.
+    this->data.adopt(pixels, static_cast<size_t>(w) * static_cast<size_t>(h) * static_cast<size_t>(ch), stbi_image_free);
+}
+
+void RasterImage::write_png(const std::filesystem::path& path) const {
+    PngWriter::Options options;
+    options.compression = png_compression_;
+    PngWriter::write(path, this->data.data(), width_, height_, channels_, options);
+}
+
+namespace {
+
+// Runs work(i) for every i < count. Workers pull indices from a shared counter, so uneven tiles (the last row and
+// column absorb the remainder) still balance. Inline when called from a pool worker, which must not block on its pool.
+template<typename Work>
+void for_each_tile(size_t count, Work work) {
+    CipherFortis::ThreadPool& pool = CipherFortis::ThreadPool::shared();
+    const size_t tasks = std::min(count, pool.getThreadCount());
+    if (tasks <= 1 || pool.isWorkerThread()) {
+        for (size_t i = 0; i < count; i++) work(i);
+        return;
+    }
+    std::atomic<size_t> next{0};
+    std::vector<std::future<void>> pending;
+    pending.reserve(tasks);
+    for (size_t t = 0; t < tasks; t++) {
+        pending.push_back(pool.async([&next, &work, count]() {
+            for (size_t i = next++; i < count; i = next++) work(i);
+        }));
+    }
+    for (std::future<void>& f : pending) f.wait();                          // -All done before any rethrow
+    for (std::future<void>& f : pending) f.get();
+}
+
+TileGrid make_grid(const char* where, size_t dataSize, int width, int height, int channels,
+                   size_t tileWidth, size_t tileHeight) {
+    if (dataSize == 0)
+        throw std::logic_error(std::string(where) + ": no image loaded");
+    TileGrid grid(static_cast<size_t>(width), static_cast<size_t>(height), static_cast<size_t>(channels),
+                  tileWidth, tileHeight);
+    if (grid.count() > 1 && tileWidth * tileHeight * static_cast<size_t>(channels) < CipherFortis::Cipher::CHAINING_BLOCK_SIZE)
+        throw std::invalid_argument(
+            std::string(where) + ": tiles of " + grid.to_string() + " pixels are shorter than one AES block");
+    // Every mode takes whole blocks; checked for all tiles up front so a bad grid fails before any tile is transformed.
+    for (size_t i = 0; i < grid.count(); i++) {
+        if (grid.tile_bytes(i) % CipherFortis::Cipher::CHAINING_BLOCK_SIZE != 0) {
+            const TileGrid::Rect r = grid.tile(i);
+            throw std::invalid_argument(
+                std::string(where) + ": tile " + std::to_string(i) + " (" + std::to_string(r.width) + "x" +
+                std::to_string(r.height) + " pixels, " + std::to_string(grid.tile_bytes(i)) +
+                " bytes) is not a whole number of AES blocks");
+        }
+    }
+    return grid;
+}
+
+void transform_tiles(const CipherFortis::Cipher& cipher, const TileGrid& grid, uint8_t* pixels, bool decrypt) {
+    for_each_tile(grid.count(), [&](size_t i) {
+        std::vector<uint8_t> tile(grid.tile_bytes(i));
+        uint8_t chainingBlock[CipherFortis::Cipher::CHAINING_BLOCK_SIZE];
+        cipher.tileChainingBlock(i, chainingBlock);
+        grid.gather(i, pixels, tile.data());
+        if (decrypt) cipher.decryptFrom(tile.data(), tile.size(), tile.data(), chainingBlock);
+        else         cipher.encryptFrom(tile.data(), tile.size(), tile.data(), chainingBlock);
+        grid.scatter(i, tile.data(), pixels);
+    });
+}
+
+} // namespace
+
+void RasterImage::apply_tiled_encryption(const CipherFortis::Cipher& cipher, size_t tileWidth, size_t tileHeight) {
+    const TileGrid grid = make_grid("In member function RasterImage::apply_tiled_encryption(...)",
+                                    this->data.size(), width_, height_, channels_, tileWidth, tileHeight);
+    transform_tiles(cipher, grid, this->data.data(), false);
+}
+
+void RasterImage::apply_tiled_decryption(const CipherFortis::Cipher& cipher, size_t tileWidth, size_t tileHeight) {
+    const TileGrid grid = make_grid("In member function RasterImage::apply_tiled_decryption(...)",
+                                    this->data.size(), width_, height_, channels_, tileWidth, tileHeight);
+    transform_tiles(cipher, grid, this->data.data(), true);
+}
+
+void RasterImage::apply_selective_encryption(const CipherFortis::Cipher& cipher, const Selection& selection) {
+    const char where[] = "In member function RasterImage::apply_selective_encryption(...)";
+    if (this->data.empty())
+        throw std::logic_error(std::string(where) + ": no image loaded");
+    if (cipher.getOptModeID() == CipherFortis::Cipher::OperationMode::Identifier::ECB)
+        throw std::invalid_argument(std::string(where) + ": ECB mode has no keystream");
+    if (selection.bitPlanes == 0 || selection.bitPlanes > 8)
+        throw std::invalid_argument(
+            std::string(where) + ": bit planes must be 1 to 8, got " + std::to_string(static_cast<unsigned>(selection.bitPlanes)));
+
+    const size_t channels = static_cast<size_t>(channels_);
+    size_t selected[8], count = 0;
+    for (size_t c = 0; c < channels && c < 8; c++) {
+        if (selection.channelMask >> c & 1) selected[count++] = c;
+    }
+    if (count == 0)
+        throw std::invalid_argument(std::string(where) + ": no channel of the image is selected");
+
+    const size_t planes = selection.bitPlanes;
+    const size_t pixels = this->data.size() / channels;
+    // 8192 pixels consume a whole number of AES blocks (8192 * count * planes bits), so the keystream of consecutive
+    // chunks is one segmented message and the result does not depend on the chunk size.
+    const size_t chunkPixels = 8192;
+    const size_t chunkBytes = chunkPixels * count * planes / 8;
+    std::vector<uint8_t> zeros(chunkBytes), keystream(chunkBytes + 1);         // -One spare byte for the bit reader
+    uint8_t chainingBlock[CipherFortis::Cipher::CHAINING_BLOCK_SIZE];
+    cipher.initChainingBlock(chainingBlock);
+
+    uint8_t* p = this->data.data();
+    for (size_t first = 0; first < pixels; first += chunkPixels) {
+        const size_t n = std::min(chunkPixels, pixels - first);
+        size_t bytes = (n * count * planes + 7) / 8;
+        bytes = (bytes + 15) / 16 * 16;
+        cipher.encryptSegment(zeros.data(), bytes, keystream.data(), chainingBlock);
+        uint8_t* q = p + first * channels;
+        const uint8_t* ks = keystream.data();
+
+        if (planes == 8 && count == channels) {                                 // -Every byte: a plain XOR
+            for (size_t i = 0; i < n * channels; i++) q[i] ^= ks[i];
+        } else if (planes == 8) {
+            for (size_t i = 0; i < n; i++) {
+                for (size_t s = 0; s < count; s++) q[i * channels + selected[s]] ^= ks[i * count + s];
+            }
+        } else {
+            // Sample k takes keystream bits [k*planes, (k+1)*planes), read LSB first, as its top 'planes' bits.
+            const unsigned shift = static_cast<unsigned>(8 - planes), mask = (1u << planes) - 1;
+            size_t bit = 0;
+            for (size_t i = 0; i < n; i++) {
+                for (size_t s = 0; s < count; s++, bit += planes) {
+                    const unsigned window = ks[bit >> 3] | static_cast<unsigned>(ks[(bit >> 3) + 1]) << 8;
+                    q[i * channels + selected[s]] ^= static_cast<uint8_t>((window >> (bit & 7) & mask) << shift);
+                }
+            }
+        }
+    }
+}
+
+void RasterImage::apply_selective_decryption(const CipherFortis::Cipher& cipher, const Selection& selection) {
+    this->apply_selective_encryption(cipher, selection);
+}
+
+std::vector<uint8_t> RasterImage::decrypt_region(const CipherFortis::Cipher& cipher, size_t tileWidth, size_t tileHeight,
+                                                 size_t x, size_t y, size_t w, size_t h) const {
+    const char where[] = "In member function RasterImage::decrypt_region(...) const";
+    const TileGrid grid = make_grid(where, this->data.size(), width_, height_, channels_, tileWidth, tileHeight);
+    if (w == 0 || h == 0 || x + w > static_cast<size_t>(width_) || y + h > static_cast<size_t>(height_))
+        throw std::out_of_range(
+            std::string(where) + ": region " + std::to_string(w) + "x" + std::to_string(h) + "+" + std::to_string(x) +
+            "+" + std::to_string(y) + " is not inside the " + std::to_string(width_) + "x" + std::to_string(height_) +
+            " image");
+
+    const size_t channels = static_cast<size_t>(channels_);
+    const std::vector<size_t> tiles = grid.intersecting(TileGrid::Rect{x, y, w, h});
+    std::vector<uint8_t> region(w * h * channels);
+    for_each_tile(tiles.size(), [&](size_t k) {
+        const size_t i = tiles[k];
+        const TileGrid::Rect r = grid.tile(i);
+        std::vector<uint8_t> tile(grid.tile_bytes(i));
+        uint8_t chainingBlock[CipherFortis::Cipher::CHAINING_BLOCK_SIZE];
+        cipher.tileChainingBlock(i, chainingBlock);
+        grid.gather(i, this->data.data(), tile.data());
+        cipher.decryptFrom(tile.data(), tile.size(), tile.data(), chainingBlock);
+        // Overlap of the tile and the region; tiles are disjoint, so workers write disjoint parts of 'region'.
+        const size_t x0 = std::max(x, r.x), x1 = std::min(x + w, r.x + r.width);
+        const size_t y0 = std::max(y, r.y), y1 = std::min(y + h, r.y + r.height);
+        for (size_t row = y0; row < y1; row++) {
+            std::memcpy(region.data() + ((row - y) * w + (x0 - x)) * channels,
+                        tile.data() + ((row - r.y) * r.width + (x0 - r.x)) * channels,
+                        (x1 - x0) * channels);
+        }
+    });
+    return region;
+}
+
+ImageCorrelation RasterImage::calculate_correlation(size_t threads) const {
+    if (this->data.empty()) {
+        throw std::logic_error("In member function RasterImage::calculate_correlation(size_t) const: no image loaded");
+    }
+    return ImageCorrelation::measure(this->data.data(), static_cast<size_t>(width_), static_cast<size_t>(height_),
+                                     static_cast<size_t>(channels_), threads);
 }
 
 } // namespace File
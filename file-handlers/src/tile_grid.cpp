@@ -0,0 +1,93 @@
+#include"../include/tile_grid.hpp"
+#include<cstring>
+#include<stdexcept>
+
+using namespace File;
+
+TileGrid::TileGrid(size_t imageWidth, size_t imageHeight, size_t channels, size_t tileWidth, size_t tileHeight)
+: imageWidth_(imageWidth), imageHeight_(imageHeight), channels_(channels), tileWidth_(tileWidth), tileHeight_(tileHeight) {
+    if(imageWidth == 0 || imageHeight == 0 || channels == 0 || tileWidth == 0 || tileHeight == 0) {
+        throw std::invalid_argument(
+            "In constructor TileGrid::TileGrid(...): dimensions must be positive (image " + std::to_string(imageWidth) +
+            "x" + std::to_string(imageHeight) + ", tile " + std::to_string(tileWidth) + "x" + std::to_string(tileHeight) + ")"
+        );
+    }
+    this->columns_ = imageWidth / tileWidth > 0 ? imageWidth / tileWidth : 1;
+    this->rows_ = imageHeight / tileHeight > 0 ? imageHeight / tileHeight : 1;
+}
+
+TileGrid::Rect TileGrid::tile(size_t index) const {
+    if(index >= this->count()) {
+        throw std::out_of_range("In member function TileGrid::tile(size_t) const: no tile " + std::to_string(index));
+    }
+    const size_t column = index % this->columns_, row = index / this->columns_;
+    Rect r;
+    r.x = column * this->tileWidth_;
+    r.y = row * this->tileHeight_;
+    r.width = column + 1 == this->columns_ ? this->imageWidth_ - r.x : this->tileWidth_;
+    r.height = row + 1 == this->rows_ ? this->imageHeight_ - r.y : this->tileHeight_;
+    return r;
+}
+
+size_t TileGrid::tile_bytes(size_t index) const {
+    const Rect r = this->tile(index);
+    return r.width * r.height * this->channels_;
+}
+
+std::vector<size_t> TileGrid::intersecting(const Rect& region) const {
+    std::vector<size_t> indices;
+    if(region.width == 0 || region.height == 0 || region.x >= this->imageWidth_ || region.y >= this->imageHeight_) {
+        return indices;
+    }
+    const size_t right = region.x + region.width < this->imageWidth_ ? region.x + region.width : this->imageWidth_;
+    const size_t bottom = region.y + region.height < this->imageHeight_ ? region.y + region.height : this->imageHeight_;
+    auto column_of = [this](size_t x) {                                         // -Last column absorbs the remainder
+        const size_t c = x / this->tileWidth_;
+        return c < this->columns_ ? c : this->columns_ - 1;
+    };
+    auto row_of = [this](size_t y) {
+        const size_t r = y / this->tileHeight_;
+        return r < this->rows_ ? r : this->rows_ - 1;
+    };
+    for(size_t row = row_of(region.y); row <= row_of(bottom - 1); row++) {
+        for(size_t column = column_of(region.x); column <= column_of(right - 1); column++) {
+            indices.push_back(row * this->columns_ + column);
+        }
+    }
+    return indices;
+}
+
+void TileGrid::gather(size_t index, const uint8_t* pixels, uint8_t* tile) const {
+    const Rect r = this->tile(index);
+    const size_t stride = this->imageWidth_ * this->channels_, rowBytes = r.width * this->channels_;
+    for(size_t y = 0; y < r.height; y++) {
+        std::memcpy(tile + y * rowBytes, pixels + (r.y + y) * stride + r.x * this->channels_, rowBytes);
+    }
+}
+
+void TileGrid::scatter(size_t index, const uint8_t* tile, uint8_t* pixels) const {
+    const Rect r = this->tile(index);
+    const size_t stride = this->imageWidth_ * this->channels_, rowBytes = r.width * this->channels_;
+    for(size_t y = 0; y < r.height; y++) {
+        std::memcpy(pixels + (r.y + y) * stride + r.x * this->channels_, tile + y * rowBytes, rowBytes);
+    }
+}
+
+std::string TileGrid::to_string() const {
+    return std::to_string(this->tileWidth_) + "x" + std::to_string(this->tileHeight_);
+}
+
+bool TileGrid::parse(const std::string& text, size_t& tileWidth, size_t& tileHeight) {
+    const size_t x = text.find('x');
+    if(x == std::string::npos || x == 0 || x + 1 == text.size()) return false;
+    if(text.find_first_not_of("0123456789", 0) != x || text.find_first_not_of("0123456789", x + 1) != std::string::npos) {
+        return false;
+    }
+    try {
+        tileWidth = std::stoul(text.substr(0, x));
+        tileHeight = std::stoul(text.substr(x + 1));
+    } catch(const std::exception&) {
+        return false;
+    }
+    return tileWidth > 0 && tileHeight > 0;
+}
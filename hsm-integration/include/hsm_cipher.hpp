@@ -54,6 +54,17 @@ public:
         const std::vector<uint8_t>& input, std::vector<uint8_t>& output
     ) const override;
 
+    // False in CBC mode: encryption() pads (CKM_AES_CBC_PAD).
+    bool preservesLength() const override;
+
+    // Raw buffers go to the token as they are, without the vector copies
+    // of the default implementation; 'output' may equal 'input'. The
+    // length is kept, so CBC runs unpadded (CKM_AES_CBC) and, like ECB,
+    // takes whole 16-byte blocks only. Not interchangeable with the
+    // padded CBC of encryption()/decryption().
+    void encryptBytes(const uint8_t* input, size_t size, uint8_t* output) const override;
+    void decryptBytes(const uint8_t* input, size_t size, uint8_t* output) const override;
+
     // ── Configuration ─────────────────────────────────────────────────
 
     void setActiveKey(const HSMKeyHandle& key);
@@ -68,7 +79,8 @@ private:
     const HSMKeyHandle*               active_key_ = nullptr;
     std::vector<uint8_t>              iv_;
 
-    CK_MECHANISM buildMechanism() const;
+    CK_MECHANISM buildMechanism(bool padded = true) const;
+    void         transformBytes(const uint8_t* input, size_t size, uint8_t* output, bool decrypt) const;
     void         checkActiveKey() const;
     void         checkRV(const std::string& fn, CK_RV rv) const;
 };
@@ -3,6 +3,7 @@
 #include <sstream>
 #include <iomanip>
 #include <stdexcept>
+#include <string>
 
 namespace CipherFortis {
 namespace HSM {
@@ -155,7 +156,7 @@ void HSMCipher::setIV(const std::vector<uint8_t>& iv) {
 // Mechanism builder
 // ---------------------------------------------------------------------------
 
-CK_MECHANISM HSMCipher::buildMechanism() const {
+CK_MECHANISM HSMCipher::buildMechanism(bool padded) const {
     switch (mode_) {
         case Cipher::OperationMode::Identifier::ECB:
             return { CKM_AES_ECB, nullptr, 0 };
@@ -166,7 +167,7 @@ CK_MECHANISM HSMCipher::buildMechanism() const {
                     "HSMCipher: CBC mode requires a 16-byte IV"
                 );
             // iv_.data() is stable for the duration of the synchronous call.
-            return { CKM_AES_CBC_PAD,
+            return { padded ? CKM_AES_CBC_PAD : CKM_AES_CBC,
                      const_cast<uint8_t*>(iv_.data()),
                      static_cast<CK_ULONG>(iv_.size()) };
 
@@ -266,5 +267,48 @@ void HSMCipher::decryption(
     output.resize(out_len);
 }
 
+bool HSMCipher::preservesLength() const {
+    return mode_ != Cipher::OperationMode::Identifier::CBC;
+}
+
+void HSMCipher::encryptBytes(const uint8_t* input, size_t size, uint8_t* output) const {
+    transformBytes(input, size, output, false);
+}
+
+void HSMCipher::decryptBytes(const uint8_t* input, size_t size, uint8_t* output) const {
+    transformBytes(input, size, output, true);
+}
+
+void HSMCipher::transformBytes(
+    const uint8_t* input, size_t size, uint8_t* output, bool decrypt
+) const {
+    checkActiveKey();
+    if (mode_ != Cipher::OperationMode::Identifier::CTR && size % 16 != 0)
+        throw std::invalid_argument(
+            "HSMCipher: raw buffers must hold whole 16-byte blocks in ECB and CBC mode (got " +
+            std::to_string(size) + " bytes)"
+        );
+    CK_MECHANISM mech = buildMechanism(false);
+
+    checkRV(
+        decrypt ? "C_DecryptInit" : "C_EncryptInit",
+        decrypt ? session_.p11()->C_DecryptInit(session_.session(), &mech, active_key_->handle())
+                : session_.p11()->C_EncryptInit(session_.session(), &mech, active_key_->handle())
+    );
+
+    // PKCS#11 allows the output to overlap the input exactly, so in-place calls need no copy.
+    CK_ULONG out_len = static_cast<CK_ULONG>(size);
+    CK_BYTE_PTR in   = const_cast<CK_BYTE_PTR>(input);
+    checkRV(
+        decrypt ? "C_Decrypt" : "C_Encrypt",
+        decrypt ? session_.p11()->C_Decrypt(session_.session(), in, static_cast<CK_ULONG>(size), output, &out_len)
+                : session_.p11()->C_Encrypt(session_.session(), in, static_cast<CK_ULONG>(size), output, &out_len)
+    );
+    if (out_len != size)
+        throw std::runtime_error(
+            "HSMCipher: token returned " + std::to_string(out_len) + " bytes for " + std::to_string(size)
+        );
+}
+
 } // namespace HSM
 } // namespace CipherFortis
@@ -69,6 +69,12 @@ public:
 
 	// SYSTEM TEST 5: Metadata round-trip (encrypt with --metadata, decrypt with --metadata)
 	bool test_metadata_round_trip();
+
+	// SYSTEM TEST 6: JPEG encryption in the DCT coefficient domain (--jpeg-dct) keeps a JPEG and round-trips exactly
+	bool test_jpeg_dct_round_trip();
+
+	// SYSTEM TEST 7: Tiled encryption (--tiles) records the grid in the metadata; --region decrypts only a region
+	bool test_tiled_region_decryption();
 }; // class SystemTests
 
 } // namespace CommandLineToolsTest
@@ -0,0 +1,28 @@
+#ifndef TEMP_DIR_FIXTURE_HPP
+#define TEMP_DIR_FIXTURE_HPP
+
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <cstdint>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Scratch directory private to the running test: named after the suite, the test and the process id, so that
+// tests run in parallel (ctest -j) never share files. Created before the test body and removed after it.
+class TempDirFixture : public ::testing::Test {
+public:
+    static void writeFile(const fs::path& path, const std::vector<uint8_t>& bytes);
+    static std::vector<uint8_t> readFile(const fs::path& path);
+
+protected:
+    fs::path dir = uniqueDir();
+
+    void SetUp() override;
+    void TearDown() override;
+
+private:
+    static fs::path uniqueDir();
+};
+
+#endif // TEMP_DIR_FIXTURE_HPP
@@ -4,6 +4,8 @@
 #include "../include/raster_image_fixture.hpp"  // pulls in <gtest/gtest.h>
 #include <gtest/gtest.h>
 #include "../include/system_workflows.hpp"
+#include "../../file-handlers/include/png_image.hpp"
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <cstdlib>
@@ -511,3 +513,118 @@ bool SystemTests::test_large_file_performance() {
 
     return success;
 }
+
+// SYSTEM TEST 6: JPEG encryption in the DCT coefficient domain
+bool SystemTests::test_jpeg_dct_round_trip() {
+    bool success = true;
+
+    std::string gen_key_cmd =
+        this->executable_path + " --generate-key --output " + this->keyPath.string();
+    SystemUtils::execute_cli_command(gen_key_cmd);
+
+    const fs::path jpegInput = this->testDataDir / "dct_input.jpg";
+    const fs::path encJpg    = this->testDataDir / "dct_enc.jpg";
+    const fs::path decJpg    = this->testDataDir / "dct_dec.jpg";
+    RasterImageFixture::createValidJpeg(jpegInput, 64, 48);
+
+    const std::string common =
+        " --key " + this->keyPath.string() + " --mode CTR --iv 00112233445566778899AABBCCDDEEFF --jpeg-dct";
+    int enc_result = SystemUtils::execute_cli_command(
+        this->executable_path + common + " --input " + jpegInput.string() + " --output " + encJpg.string());
+    EXPECT_EQ(0, enc_result) << "DCT-domain JPEG encryption should succeed";
+    success &= (enc_result == 0);
+
+    bool stillJpeg = fs::exists(encJpg) && !fs::exists(this->testDataDir / "dct_enc.png");
+    EXPECT_TRUE(stillJpeg) << "Encrypted output should stay a .jpg";
+    success &= stillJpeg;
+
+    const std::vector<uint8_t> original  = SystemUtils::read_file(jpegInput.string(), true);
+    const std::vector<uint8_t> encrypted = SystemUtils::read_file(encJpg.string(), true);
+    bool differs = encrypted != original && encrypted.size() < original.size() + original.size() / 10;
+    EXPECT_TRUE(differs) << "Encrypted JPEG should differ and keep about the original size";
+    success &= differs;
+
+    int dec_result = SystemUtils::execute_cli_command(
+        this->executable_path + " --decrypt" + common + " --input " + encJpg.string() + " --output " + decJpg.string());
+    EXPECT_EQ(0, dec_result) << "DCT-domain JPEG decryption should succeed";
+    success &= (dec_result == 0);
+
+    bool exact = SystemUtils::read_file(decJpg.string(), true) == original;
+    EXPECT_TRUE(exact) << "Decryption should restore the original file byte for byte";
+    success &= exact;
+
+    int ecb_result = SystemUtils::execute_cli_command(
+        this->executable_path + " --key " + this->keyPath.string() + " --mode ECB --jpeg-dct --input " +
+        jpegInput.string() + " --output " + encJpg.string());
+    EXPECT_NE(0, ecb_result) << "ECB has no keystream to encrypt coefficients with";
+    success &= (ecb_result != 0);
+
+    return success;
+}
+
+// SYSTEM TEST 7: Tiled encryption, grid recorded in the metadata, region-of-interest decryption
+bool SystemTests::test_tiled_region_decryption() {
+    bool success = true;
+
+    std::string gen_key_cmd =
+        this->executable_path + " --generate-key --output " + this->keyPath.string();
+    SystemUtils::execute_cli_command(gen_key_cmd);
+
+    const fs::path input     = this->testDataDir / "tiled_input.png";
+    const fs::path metaPath  = this->testDataDir / "tiled_meta.json";
+    const fs::path encrypted = this->testDataDir / "tiled_enc.png";
+    const fs::path decrypted = this->testDataDir / "tiled_dec.png";
+    const fs::path region    = this->testDataDir / "tiled_region.png";
+    RasterImageFixture::createValidPng(input, 80, 60);
+
+    int enc_result = SystemUtils::execute_cli_command(
+        this->executable_path + " --key " + this->keyPath.string() + " --mode CTR --tiles 32x16 --input " +
+        input.string() + " --output " + encrypted.string() + " --metadata " + metaPath.string());
+    EXPECT_EQ(0, enc_result) << "Tiled encryption should succeed";
+    success &= (enc_result == 0);
+
+    const std::vector<uint8_t> meta = SystemUtils::read_file(metaPath.string(), true);
+    bool gridRecorded = std::string(meta.begin(), meta.end()).find("\"tiles\": \"32x16\"") != std::string::npos;
+    EXPECT_TRUE(gridRecorded) << "Metadata should record the tile grid";
+    success &= gridRecorded;
+
+    const std::string decrypt = this->executable_path + " --decrypt --key " + this->keyPath.string() +
+        " --metadata " + metaPath.string() + " --input " + encrypted.string();
+    int dec_result = SystemUtils::execute_cli_command(decrypt + " --output " + decrypted.string());
+    int reg_result = SystemUtils::execute_cli_command(decrypt + " --region 30,10,40,20 --output " + region.string());
+    EXPECT_EQ(0, dec_result) << "Tiled decryption should succeed";
+    EXPECT_EQ(0, reg_result) << "Region decryption should succeed";
+    success &= (dec_result == 0 && reg_result == 0);
+    if (!success) return false;
+
+    File::PNG original(input), restored(decrypted), part(region);
+    original.load();
+    restored.load();
+    part.load();
+    bool exact = original.get_data() == restored.get_data();
+    EXPECT_TRUE(exact) << "Tiled decryption should restore every pixel";
+    success &= exact;
+
+    bool regionMatches = part.width() == 40 && part.height() == 20 && part.channels() == original.channels();
+    const size_t channels = static_cast<size_t>(original.channels());
+    for (size_t y = 0; regionMatches && y < 20; y++) {
+        regionMatches = std::equal(part.get_bytes() + y * 40 * channels, part.get_bytes() + (y + 1) * 40 * channels,
+                                   original.get_bytes() + ((10 + y) * 80 + 30) * channels);
+    }
+    EXPECT_TRUE(regionMatches) << "The region should hold the original pixels";
+    success &= regionMatches;
+
+    int bad_result = SystemUtils::execute_cli_command(
+        this->executable_path + " --key " + this->keyPath.string() + " --region 0,0,4,4 --input " +
+        input.string() + " --output " + region.string());
+    EXPECT_NE(0, bad_result) << "--region needs a tiled decryption";
+    success &= (bad_result != 0);
+
+    const fs::path bmpRegion = this->testDataDir / "tiled_region.bmp";
+    int ext_result = SystemUtils::execute_cli_command(decrypt + " --region 30,10,40,20 --output " + bmpRegion.string());
+    EXPECT_NE(0, ext_result) << "--region only writes PNG";
+    EXPECT_FALSE(fs::exists(bmpRegion));
+    success &= (ext_result != 0);
+
+    return success;
+}
@@ -0,0 +1,29 @@
+#include "../include/temp_dir_fixture.hpp"
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unistd.h>
+
+void TempDirFixture::SetUp()    { fs::create_directories(dir); }
+void TempDirFixture::TearDown() { fs::remove_all(dir); }
+
+fs::path TempDirFixture::uniqueDir() {
+    const ::testing::TestInfo* test = ::testing::UnitTest::GetInstance()->current_test_info();
+    std::string name = "ciphfortis_";
+    if (test != nullptr) name += std::string(test->test_suite_name()) + "_" + test->name() + "_";
+    name += std::to_string(::getpid());
+    for (char& c : name) {
+        if (c == '/') c = '_';                                                  // -Parameterized test names
+    }
+    return fs::temp_directory_path() / name;
+}
+
+void TempDirFixture::writeFile(const fs::path& path, const std::vector<uint8_t>& bytes) {
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+std::vector<uint8_t> TempDirFixture::readFile(const fs::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
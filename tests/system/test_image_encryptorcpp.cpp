@@ -29,3 +29,13 @@ TEST(SystemTest, MetadataRoundTrip) {
     cltt::SystemTests st(IMAGE_ENCRYPTOR_PATH, cltt::FileFormat::BITMAP);
     EXPECT_TRUE(st.test_metadata_round_trip());
 }
+
+TEST(SystemTest, JpegDctRoundTrip) {
+    cltt::SystemTests st(IMAGE_ENCRYPTOR_PATH, cltt::FileFormat::BITMAP);
+    EXPECT_TRUE(st.test_jpeg_dct_round_trip());
+}
+
+TEST(SystemTest, TiledRegionDecryption) {
+    cltt::SystemTests st(IMAGE_ENCRYPTOR_PATH, cltt::FileFormat::BITMAP);
+    EXPECT_TRUE(st.test_tiled_region_decryption());
+}
@@ -0,0 +1,128 @@
+// Unit test suite for File::AsyncFileEncryptor and the IOEngine backends
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fcntl.h>
+#include <unistd.h>
+#include "../../file-handlers/include/async_file_encryptor.hpp"
+#include "../include/temp_dir_fixture.hpp"
+
+namespace fs = std::filesystem;
+
+#define AESKEY_LENBITS CipherFortis::Key::LengthBits
+#define AESCIPHER CipherFortis::Cipher
+#define AESCIPHER_OPTMODE CipherFortis::Cipher::OperationMode::Identifier
+#define BACKEND File::IOEngine::Backend
+
+class AsyncFileEncryptorTest : public TempDirFixture {
+protected:
+    fs::path plainPath = dir / "plain.bin";
+    fs::path cipherPath = dir / "cipher.bin";
+    fs::path roundTripPath = dir / "roundtrip.bin";
+
+    static std::vector<uint8_t> pattern(size_t size) {
+        std::vector<uint8_t> bytes(size);
+        for (size_t i = 0; i < size; i++) bytes[i] = static_cast<uint8_t>(i * 29 + (i >> 11));
+        return bytes;
+    }
+    static std::vector<BACKEND> backends() {
+        std::vector<BACKEND> list = {BACKEND::ThreadPool};
+        if (File::IOEngine::io_uring_available()) list.push_back(BACKEND::IoUring);
+        return list;
+    }
+};
+
+TEST_F(AsyncFileEncryptorTest, MatchesWholeFileEncryption) {
+    const std::vector<uint8_t> plain = pattern(200 * 1024 + 32);               // -Last chunk is partial
+    writeFile(plainPath, plain);
+
+    for (BACKEND backend : backends()) {
+        for (AESCIPHER_OPTMODE cm : {AESCIPHER_OPTMODE::ECB, AESCIPHER_OPTMODE::CBC, AESCIPHER_OPTMODE::OFB, AESCIPHER_OPTMODE::CTR}) {
+            SCOPED_TRACE(static_cast<int>(backend) * 10 + static_cast<int>(cm));
+            AESCIPHER ciph(AESKEY_LENBITS::_128, cm);
+            std::vector<uint8_t> expected(plain.size());
+            ciph.encrypt(plain.data(), plain.size(), expected.data());
+
+            File::AsyncFileEncryptor::Config config;
+            config.chunkBytes = 16 * 1024;
+            config.queueDepth = 4;
+            config.backend = backend;
+            File::AsyncFileEncryptor encryptor(ciph, config);
+
+            File::AsyncFileEncryptor::Stats stats = encryptor.encrypt_file(plainPath, cipherPath);
+            EXPECT_EQ(backend, stats.backend);
+            EXPECT_EQ(13u, stats.chunks);
+            EXPECT_GE(stats.reads, stats.chunks);
+            EXPECT_GE(stats.writes, stats.chunks);
+            EXPECT_LE(stats.maxInFlight, config.queueDepth);
+            EXPECT_GT(stats.meanInFlight, 0.0);
+            EXPECT_EQ(expected, readFile(cipherPath));
+
+            encryptor.decrypt_file(cipherPath, roundTripPath);
+            EXPECT_EQ(plain, readFile(roundTripPath));
+        }
+    }
+}
+
+TEST_F(AsyncFileEncryptorTest, DirectIOAndInPlace) {
+    const std::vector<uint8_t> plain = pattern(50 * 1000 * 16);                // -Not a multiple of the page size
+    writeFile(plainPath, plain);
+    AESCIPHER ciph(AESKEY_LENBITS::_256, AESCIPHER_OPTMODE::CTR);
+    std::vector<uint8_t> expected(plain.size());
+    ciph.encrypt(plain.data(), plain.size(), expected.data());
+
+    File::AsyncFileEncryptor::Config config;
+    config.chunkBytes = 10000;                                                  // -Rounded up to a page multiple
+    config.directIO = true;
+    File::AsyncFileEncryptor encryptor(ciph, config);
+    EXPECT_EQ(0u, encryptor.get_config().chunkBytes % 4096);
+
+    encryptor.encrypt_file(plainPath, cipherPath);                              // -O_DIRECT, or buffered where unsupported
+    EXPECT_EQ(expected, readFile(cipherPath));
+
+    encryptor.decrypt_file(cipherPath, cipherPath);
+    EXPECT_EQ(plain, readFile(cipherPath));
+}
+
+TEST_F(AsyncFileEncryptorTest, InvalidInputs) {
+    AESCIPHER ciph(AESKEY_LENBITS::_128, AESCIPHER_OPTMODE::ECB);
+    File::AsyncFileEncryptor::Config config;
+    config.queueDepth = 0;
+    EXPECT_THROW(File::AsyncFileEncryptor(ciph, config), std::invalid_argument);
+    config.queueDepth = 8;
+    config.chunkBytes = File::AsyncFileEncryptor::MAX_CHUNK_BYTES + 4096;     // -Would not fit one io_uring request
+    EXPECT_THROW(File::AsyncFileEncryptor(ciph, config), std::invalid_argument);
+    config.chunkBytes = File::AsyncFileEncryptor::MAX_CHUNK_BYTES;
+    EXPECT_NO_THROW(File::AsyncFileEncryptor(ciph, config));
+
+    File::AsyncFileEncryptor encryptor(ciph);
+    writeFile(plainPath, pattern(17));
+    EXPECT_THROW(encryptor.encrypt_file(plainPath, cipherPath), std::invalid_argument);
+    EXPECT_THROW(encryptor.encrypt_file(dir / "missing.bin", cipherPath), std::runtime_error);
+}
+
+TEST_F(AsyncFileEncryptorTest, EngineRoundTrip) {
+    writeFile(plainPath, pattern(4096));
+    for (BACKEND backend : backends()) {
+        std::unique_ptr<File::IOEngine> engine = File::IOEngine::create(backend, 2);
+        EXPECT_EQ(backend, engine->backend());
+        EXPECT_THROW(engine->wait(), std::logic_error);
+
+        int fd = ::open(plainPath.c_str(), O_RDONLY);
+        ASSERT_GE(fd, 0);
+        std::vector<uint8_t> a(2048), b(2048);
+        engine->submit(File::IOEngine::Request{fd, a.data(), a.size(), 0, false, 1, -1});
+        engine->submit(File::IOEngine::Request{fd, b.data(), b.size(), 2048, false, 2, -1});
+        EXPECT_EQ(2u, engine->in_flight());
+        File::IOEngine::Completion c1 = engine->wait();
+        File::IOEngine::Completion c2 = engine->wait();
+        EXPECT_EQ(3u, c1.tag + c2.tag);
+        EXPECT_EQ(2048, c1.result);
+        EXPECT_EQ(2048, c2.result);
+        EXPECT_EQ(0u, engine->in_flight());
+        ::close(fd);
+
+        std::vector<uint8_t> expected = pattern(4096);
+        EXPECT_TRUE(std::equal(a.begin(), a.end(), expected.begin()));
+        EXPECT_TRUE(std::equal(b.begin(), b.end(), expected.begin() + 2048));
+    }
+}
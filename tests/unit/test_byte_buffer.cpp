@@ -0,0 +1,138 @@
+// Unit test suite for File::ByteBuffer and File::BufferPool
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdlib>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+#include "../../file-handlers/include/byte_buffer.hpp"
+
+TEST(BufferPoolTest, SizeClasses) {
+    EXPECT_EQ(0u, File::BufferPool::size_class(0));
+    EXPECT_EQ(64u, File::BufferPool::size_class(1));
+    EXPECT_EQ(128u, File::BufferPool::size_class(65));
+    EXPECT_EQ(4096u, File::BufferPool::size_class(4096));
+    EXPECT_EQ(5120u, File::BufferPool::size_class(4097));
+    EXPECT_EQ(8192u, File::BufferPool::size_class(7169));
+    for (size_t size : {size_t(100000), size_t(3000000), size_t(123456789)}) {
+        size_t c = File::BufferPool::size_class(size);
+        EXPECT_GE(c, size);
+        EXPECT_LE(c, size + size / 4) << "At most 25% waste";
+    }
+}
+
+TEST(BufferPoolTest, ReusesReleasedBlocks) {
+    File::BufferPool pool;
+    size_t capacity;
+    uint8_t* a = pool.acquire(100000, capacity);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(a) % File::BufferPool::PAGE);
+    pool.release(a, capacity);
+    EXPECT_EQ(capacity, pool.stats().cachedBytes);
+
+    size_t capacity2;
+    uint8_t* b = pool.acquire(99000, capacity2);                               // -Same size class
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(capacity, capacity2);
+    EXPECT_EQ(1u, pool.stats().hits);
+    EXPECT_EQ(1u, pool.stats().misses);
+    pool.release(b, capacity2);
+
+    uint8_t* huge = pool.acquire(File::BufferPool::HUGE_PAGE, capacity);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(huge) % File::BufferPool::HUGE_PAGE);
+    pool.release(huge, capacity);
+    pool.trim();
+    EXPECT_EQ(0u, pool.stats().cachedBytes);
+}
+
+TEST(BufferPoolTest, CacheLimit) {
+    File::BufferPool::Config config;
+    config.maxCachedBytes = 8192;
+    File::BufferPool pool(config);
+    size_t capacity;
+    uint8_t* a = pool.acquire(8192, capacity);
+    uint8_t* b = pool.acquire(8192, capacity);
+    pool.release(a, capacity);
+    pool.release(b, capacity);                                                  // -Over the limit: freed
+    EXPECT_EQ(8192u, pool.stats().cachedBytes);
+}
+
+TEST(ByteBufferTest, ContainerInterface) {
+    File::BufferPool pool;
+    File::ByteBuffer buffer(1000, pool);
+    EXPECT_EQ(1000u, buffer.size());
+    EXPECT_GE(buffer.capacity(), 1000u);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(buffer.data()) % File::BufferPool::CACHE_LINE);
+    std::iota(buffer.begin(), buffer.end(), uint8_t(0));
+
+    buffer.resize(3000);                                                        // -Growth keeps the prefix
+    for (size_t i = 0; i < 1000; i++) ASSERT_EQ(static_cast<uint8_t>(i), buffer[i]);
+    buffer.resize(10);
+    std::vector<uint8_t> expected(10);
+    std::iota(expected.begin(), expected.end(), uint8_t(0));
+    EXPECT_EQ(expected, buffer);
+    EXPECT_EQ(buffer, expected);
+    std::vector<uint8_t> converted = buffer.to_vector();
+    EXPECT_EQ(expected, converted);
+    static_assert(!std::is_convertible<File::ByteBuffer, std::vector<uint8_t>>::value &&
+                  !std::is_convertible<std::vector<uint8_t>, File::ByteBuffer>::value, "Copies are spelled out");
+
+    File::ByteBuffer copy(buffer);
+    EXPECT_EQ(buffer, copy);
+    copy[0] = 0xFF;
+    EXPECT_NE(buffer, copy);
+    EXPECT_NE(expected, copy);
+
+    File::ByteBuffer moved(std::move(copy));
+    EXPECT_TRUE(copy.empty());
+    EXPECT_EQ(10u, moved.size());
+
+    buffer.clear();
+    EXPECT_TRUE(buffer.empty());
+    EXPECT_GT(buffer.capacity(), 0u);
+    buffer.reset();
+    EXPECT_EQ(0u, buffer.capacity());
+    EXPECT_EQ(File::ByteBuffer(), buffer);
+}
+
+TEST(ByteBufferTest, BuffersReturnToThePool) {
+    File::BufferPool pool;
+    const uint8_t* first;
+    {
+        File::ByteBuffer a(1 << 20, pool);
+        first = a.data();
+    }
+    File::ByteBuffer b(1 << 20, pool);
+    EXPECT_EQ(first, b.data()) << "A second file of the same size reuses the first one's memory";
+    EXPECT_EQ(1u, pool.stats().hits);
+}
+
+static int adoptedReleases = 0;
+static void countingFree(void* p) {
+    adoptedReleases++;
+    std::free(p);
+}
+
+TEST(ByteBufferTest, AdoptsForeignMemory) {
+    uint8_t* block = static_cast<uint8_t*>(std::malloc(256));
+    for (size_t i = 0; i < 256; i++) block[i] = static_cast<uint8_t>(i);
+    adoptedReleases = 0;
+    {
+        File::ByteBuffer buffer;
+        buffer.adopt(block, 256, countingFree);
+        EXPECT_EQ(block, buffer.data()) << "No copy";
+        EXPECT_EQ(256u, buffer.size());
+        File::ByteBuffer moved(std::move(buffer));
+        EXPECT_EQ(block, moved.data());
+        EXPECT_EQ(0, adoptedReleases);
+    }
+    EXPECT_EQ(1, adoptedReleases) << "Released once, with the adopted function";
+
+    block = static_cast<uint8_t*>(std::malloc(64));
+    for (size_t i = 0; i < 64; i++) block[i] = static_cast<uint8_t>(i);
+    File::ByteBuffer grown;
+    grown.adopt(block, 64, countingFree);
+    grown.resize(5000);                                                         // -Moves to pooled memory
+    EXPECT_EQ(2, adoptedReleases);
+    EXPECT_NE(block, grown.data());
+    for (size_t i = 0; i < 64; i++) ASSERT_EQ(static_cast<uint8_t>(i), grown[i]);
+}
@@ -0,0 +1,35 @@
+// Unit test suite for ByteHistogram: every kernel gives the scalar counts
+#include <gtest/gtest.h>
+#include "../../analysis/include/byte_histogram.hpp"
+#include <cstring>
+#include <random>
+#include <vector>
+
+TEST(ByteHistogramTest, KernelsAgree) {
+    using ByteHistogram::Kernel;
+    std::mt19937 rng(11);
+    std::vector<uint8_t> data(70001);
+    for (uint8_t& v : data) v = static_cast<uint8_t>(rng() % 7 == 0 ? 42 : rng());  // -Runs of equal bins too
+
+    for (size_t stride : {1, 2, 3, 4, 5, 16, 1000}) {
+        for (size_t count : {size_t(1), size_t(7), size_t(15), size_t(16), size_t(17), (data.size() - 1) / stride + 1}) {
+            uint64_t expected[256] = {0};
+            for (size_t i = 0; i < count; i++) expected[data[i * stride]]++;
+            for (Kernel kernel : {Kernel::Auto, Kernel::Scalar, Kernel::AVX2, Kernel::AVX512}) {
+                if (!ByteHistogram::supported(kernel)) continue;
+                uint64_t histogram[256] = {0};
+                histogram[0] = 5;                                               // -Counts are added, not assigned
+                ByteHistogram::accumulate(data.data(), count, stride, histogram, kernel);
+                histogram[0] -= 5;
+                EXPECT_EQ(0, std::memcmp(expected, histogram, sizeof(expected)))
+                    << "Stride " << stride << ", count " << count << ", kernel " << static_cast<int>(kernel);
+            }
+        }
+    }
+
+    uint64_t histogram[256] = {0};
+    EXPECT_NO_THROW(ByteHistogram::accumulate(nullptr, 0, 1, histogram));
+    EXPECT_THROW(ByteHistogram::accumulate(nullptr, 4, 1, histogram), std::invalid_argument);
+    EXPECT_THROW(ByteHistogram::accumulate(data.data(), 4, 0, histogram), std::invalid_argument);
+    EXPECT_TRUE(ByteHistogram::supported(Kernel::Scalar));
+}
@@ -0,0 +1,75 @@
+// Unit test suite for File::ChunkedFileEncryptor: streamed output must equal the whole-file path
+#include <gtest/gtest.h>
+#include <filesystem>
+#include "../../file-handlers/include/chunked_file_encryptor.hpp"
+#include "../include/temp_dir_fixture.hpp"
+
+namespace fs = std::filesystem;
+
+#define AESKEY_LENBITS CipherFortis::Key::LengthBits
+#define AESCIPHER CipherFortis::Cipher
+#define AESCIPHER_OPTMODE CipherFortis::Cipher::OperationMode::Identifier
+
+class ChunkedFileEncryptorTest : public TempDirFixture {
+protected:
+    fs::path plainPath = dir / "plain.bin";
+    fs::path cipherPath = dir / "cipher.bin";
+    fs::path roundTripPath = dir / "roundtrip.bin";
+
+    static std::vector<uint8_t> pattern(size_t size) {
+        std::vector<uint8_t> bytes(size);
+        for (size_t i = 0; i < size; i++) bytes[i] = static_cast<uint8_t>(i * 13 + (i >> 9));
+        return bytes;
+    }
+};
+
+TEST_F(ChunkedFileEncryptorTest, MatchesWholeFileEncryption) {
+    const std::vector<uint8_t> plain = pattern(64 * 1024 + 48);                 // -Last chunk is partial
+    writeFile(plainPath, plain);
+
+    for (AESCIPHER_OPTMODE cm : {AESCIPHER_OPTMODE::ECB, AESCIPHER_OPTMODE::CBC, AESCIPHER_OPTMODE::OFB, AESCIPHER_OPTMODE::CTR}) {
+        SCOPED_TRACE(static_cast<int>(cm));
+        AESCIPHER ciph(AESKEY_LENBITS::_256, cm);
+        std::vector<uint8_t> expected(plain.size());
+        ciph.encrypt(plain.data(), plain.size(), expected.data());
+
+        File::ChunkedFileEncryptor::Config config;
+        config.chunkBytes = 4096 + 8;                                           // -Rounded down to 4096
+        File::ChunkedFileEncryptor encryptor(ciph, config);
+        EXPECT_EQ(4096u, encryptor.get_chunk_size());
+
+        encryptor.encrypt_file(plainPath, cipherPath);
+        EXPECT_EQ(expected, readFile(cipherPath));
+
+        encryptor.decrypt_file(cipherPath, roundTripPath);
+        EXPECT_EQ(plain, readFile(roundTripPath));
+    }
+}
+
+TEST_F(ChunkedFileEncryptorTest, InPlaceRewrite) {
+    const std::vector<uint8_t> plain = pattern(10 * 1024);
+    writeFile(plainPath, plain);
+    AESCIPHER ciph(AESKEY_LENBITS::_128, AESCIPHER_OPTMODE::CBC);
+    std::vector<uint8_t> expected(plain.size());
+    ciph.encrypt(plain.data(), plain.size(), expected.data());
+
+    File::ChunkedFileEncryptor::Config config;
+    config.chunkBytes = 1024;
+    File::ChunkedFileEncryptor encryptor(ciph, config);
+    encryptor.encrypt_file(plainPath, plainPath);
+    EXPECT_EQ(expected, readFile(plainPath));
+    encryptor.decrypt_file(plainPath, plainPath);
+    EXPECT_EQ(plain, readFile(plainPath));
+}
+
+TEST_F(ChunkedFileEncryptorTest, InvalidInputs) {
+    AESCIPHER ciph(AESKEY_LENBITS::_128, AESCIPHER_OPTMODE::CTR);
+    File::ChunkedFileEncryptor::Config tiny;
+    tiny.chunkBytes = 8;
+    EXPECT_THROW(File::ChunkedFileEncryptor(ciph, tiny), std::invalid_argument);
+
+    File::ChunkedFileEncryptor encryptor(ciph);
+    writeFile(plainPath, pattern(100));
+    EXPECT_THROW(encryptor.encrypt_file(plainPath, cipherPath), std::invalid_argument);
+    EXPECT_THROW(encryptor.encrypt_file(dir / "missing.bin", cipherPath), std::runtime_error);
+}
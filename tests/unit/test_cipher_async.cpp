@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <stdexcept>
+#include <chrono>
+#include "../../core-crypto/include/cipher.hpp"
+
+#define AESKEY_LENBITS CipherFortis::Key::LengthBits
+#define AESCIPHER CipherFortis::Cipher
+#define AESCIPHER_OPTMODE CipherFortis::Cipher::OperationMode::Identifier
+
+namespace {
+// Small chunks so that a few KiB of data already exercise the split path.
+CipherFortis::ThreadPool& testPool() {
+    static CipherFortis::ThreadPool pool(CipherFortis::ThreadPool::Config{4, {}, 64});
+    return pool;
+}
+
+std::vector<uint8_t> patternData(size_t size) {
+    std::vector<uint8_t> data(size);
+    for(size_t i = 0; i < size; i++) data[i] = static_cast<uint8_t>(i*31 + (i >> 8));
+    return data;
+}
+
+void checkAsyncMatchesSync(AESKEY_LENBITS ks, AESCIPHER_OPTMODE cm) {
+    AESCIPHER ciph(ks, cm);
+    const size_t size = 4096 + 16;
+    std::vector<uint8_t> input = patternData(size);
+    std::vector<uint8_t> expected(size), encrypted(size), decrypted(size);
+
+    ciph.encrypt(input.data(), size, expected.data());
+    ciph.encryptAsync(input.data(), size, encrypted.data(), testPool()).get();
+    EXPECT_EQ(expected, encrypted) << "Asynchronous encryption differs from synchronous encryption";
+
+    ciph.decryptAsync(encrypted.data(), size, decrypted.data(), testPool()).get();
+    EXPECT_EQ(input, decrypted) << "Asynchronous decryption does not recover the plaintext";
+}
+}
+
+TEST(CipherAsync, MatchesSynchronousAllModes) {
+    const AESKEY_LENBITS sizes[] = {AESKEY_LENBITS::_128, AESKEY_LENBITS::_192, AESKEY_LENBITS::_256};
+    const AESCIPHER_OPTMODE modes[] = {AESCIPHER_OPTMODE::ECB, AESCIPHER_OPTMODE::CBC, AESCIPHER_OPTMODE::OFB, AESCIPHER_OPTMODE::CTR};
+    for(AESKEY_LENBITS ks : sizes) {
+        for(AESCIPHER_OPTMODE cm : modes) {
+            SCOPED_TRACE(static_cast<int>(cm));
+            checkAsyncMatchesSync(ks, cm);
+        }
+    }
+}
+
+TEST(CipherAsync, CounterCarryAcrossChunks) {
+    AESCIPHER ciph(AESKEY_LENBITS::_128, AESCIPHER_OPTMODE::CTR);
+    std::vector<uint8_t> counter(16, 0xFF);                                    // -Every chunk boundary carries through all bytes
+    counter[0] = 0x00;
+    ASSERT_TRUE(ciph.setInitialVectorForTesting(counter));
+
+    const size_t size = 2048;
+    std::vector<uint8_t> input = patternData(size);
+    std::vector<uint8_t> expected(size), encrypted(size);
+    ciph.encrypt(input.data(), size, expected.data());
+    ciph.encryptAsync(input.data(), size, encrypted.data(), testPool()).get();
+    EXPECT_EQ(expected, encrypted);
+}
+
+TEST(CipherAsync, InPlaceCBCDecryption) {
+    AESCIPHER ciph(AESKEY_LENBITS::_256, AESCIPHER_OPTMODE::CBC);
+    const size_t size = 8192;
+    std::vector<uint8_t> input = patternData(size);
+    std::vector<uint8_t> buffer(size);
+
+    ciph.encrypt(input.data(), size, buffer.data());
+    ciph.decryptAsync(buffer.data(), size, buffer.data(), testPool()).get();
+    EXPECT_EQ(input, buffer);
+}
+
+TEST(CipherAsync, BatchSubmission) {
+    AESCIPHER ciph(AESKEY_LENBITS::_128, AESCIPHER_OPTMODE::CBC);
+    const size_t sizes[] = {16, 1024, 5008, 48};                               // -CBC encryption runs every item as one task
+    std::vector<std::vector<uint8_t>> inputs, expected, outputs;
+    std::vector<AESCIPHER::BatchItem> items;
+    for(size_t size : sizes) {
+        inputs.push_back(patternData(size));
+        expected.emplace_back(size);
+        outputs.emplace_back(size);
+    }
+    for(size_t i = 0; i < inputs.size(); i++) {
+        uint8_t chainingBlock[AESCIPHER::CHAINING_BLOCK_SIZE];
+        ciph.tileChainingBlock(i, chainingBlock);                              // -Every item starts from its own chaining block
+        ciph.encryptFrom(inputs[i].data(), inputs[i].size(), expected[i].data(), chainingBlock);
+        items.push_back(AESCIPHER::BatchItem{inputs[i].data(), inputs[i].size(), outputs[i].data()});
+    }
+    ciph.encryptBatchAsync(items, testPool()).get();
+    for(size_t i = 0; i < inputs.size(); i++) EXPECT_EQ(expected[i], outputs[i]) << "Batch item " << i;
+
+    for(size_t i = 0; i < inputs.size(); i++) items[i].input = outputs[i].data(); // -Decrypt in place
+    ciph.decryptBatchAsync(items, testPool()).get();
+    for(size_t i = 0; i < inputs.size(); i++) EXPECT_EQ(inputs[i], outputs[i]) << "Batch item " << i;
+}
+
+TEST(CipherAsync, BatchItemsDoNotShareKeystream) {
+    AESCIPHER ciph(AESKEY_LENBITS::_128, AESCIPHER_OPTMODE::CTR);
+    const size_t size = 2048;
+    std::vector<uint8_t> input = patternData(size);
+    std::vector<uint8_t> first(size), second(size);
+    ciph.encryptBatchAsync({AESCIPHER::BatchItem{input.data(), size, first.data()},
+                            AESCIPHER::BatchItem{input.data(), size, second.data()}}, testPool()).get();
+    EXPECT_NE(first, second) << "Equal plaintexts in one batch give different ciphertexts";
+}
+
+TEST(CipherAsync, EmptyBatchIsReady) {
+    AESCIPHER ciph(AESKEY_LENBITS::_128, AESCIPHER_OPTMODE::CTR);
+    std::future<void> result = ciph.encryptBatchAsync({}, testPool());
+    ASSERT_EQ(std::future_status::ready, result.wait_for(std::chrono::seconds(0)));
+    EXPECT_NO_THROW(result.get());
+}
+
+TEST(CipherAsync, CipherMayBeDestroyedBeforeCompletion) {
+    const size_t size = 64*1024;
+    std::vector<uint8_t> input = patternData(size);
+    std::vector<uint8_t> expected(size), encrypted(size);
+    std::future<void> pending;
+    {
+        AESCIPHER ciph(AESKEY_LENBITS::_192, AESCIPHER_OPTMODE::CTR);
+        ciph.encrypt(input.data(), size, expected.data());
+        pending = ciph.encryptAsync(input.data(), size, encrypted.data(), testPool());
+    }
+    pending.get();
+    EXPECT_EQ(expected, encrypted);
+}
+
+TEST(CipherAsync, InvalidArgumentsThrowImmediately) {
+    AESCIPHER ciph(AESKEY_LENBITS::_128, AESCIPHER_OPTMODE::ECB);
+    std::vector<uint8_t> output(32);
+    EXPECT_THROW(ciph.encryptAsync(nullptr, 32, output.data(), testPool()), std::invalid_argument);
+    EXPECT_THROW(ciph.decryptAsync(output.data(), 8, output.data(), testPool()), std::invalid_argument);
+}
+
+TEST(CipherAsync, ErrorsPropagateThroughFuture) {
+    AESCIPHER ciph(AESKEY_LENBITS::_128, AESCIPHER_OPTMODE::ECB);
+    std::vector<uint8_t> input(33), output(33);                                // -Not a multiple of the block size
+    std::future<void> result = ciph.encryptAsync(input.data(), input.size(), output.data(), testPool());
+    EXPECT_THROW(result.get(), std::invalid_argument);
+}
+
+TEST(ThreadPool, ConfigurationAndAsync) {
+    CipherFortis::ThreadPool pool(CipherFortis::ThreadPool::Config{2, {}, 4096});
+    EXPECT_EQ(pool.getThreadCount(), 2u);
+    EXPECT_EQ(pool.getMinChunkBytes(), 4096u);
+    EXPECT_FALSE(pool.isWorkerThread());
+    EXPECT_TRUE(pool.async([&pool]() noexcept { return pool.isWorkerThread(); }).get());
+    EXPECT_EQ(pool.async([]() noexcept { return 42; }).get(), 42);
+}
+
+TEST(ThreadPool, InvalidConfiguration) {
+    EXPECT_THROW(CipherFortis::ThreadPool(CipherFortis::ThreadPool::Config{1, {}, 0}), std::invalid_argument);
+#ifdef __linux__
+    EXPECT_THROW(CipherFortis::ThreadPool(CipherFortis::ThreadPool::Config{1, {100000}, 4096}), std::invalid_argument);
+#endif
+}
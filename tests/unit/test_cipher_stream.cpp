@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include <stdexcept>
+#include "../../core-crypto/include/cipher_stream.hpp"
+
+#define AESKEY_LENBITS CipherFortis::Key::LengthBits
+#define AESCIPHER CipherFortis::Cipher
+#define AESCIPHER_OPTMODE CipherFortis::Cipher::OperationMode::Identifier
+#define STREAM_OP CipherFortis::CipherStreamBuf::Operation
+
+namespace {
+const AESCIPHER_OPTMODE kModes[] = {AESCIPHER_OPTMODE::ECB, AESCIPHER_OPTMODE::CBC, AESCIPHER_OPTMODE::OFB, AESCIPHER_OPTMODE::CTR};
+
+std::string patternString(size_t size) {
+    std::string data(size, '\0');
+    for(size_t i = 0; i < size; i++) data[i] = static_cast<char>(i*7 + (i >> 5));
+    return data;
+}
+
+std::string encryptWhole(const AESCIPHER& ciph, const std::string& plain) {
+    std::string out(plain.size(), '\0');
+    ciph.encrypt(reinterpret_cast<const uint8_t*>(plain.data()), plain.size(), reinterpret_cast<uint8_t*>(&out[0]));
+    return out;
+}
+
+std::string readAll(std::istream& in) {
+    std::ostringstream collected;
+    collected << in.rdbuf();
+    return collected.str();
+}
+}
+
+TEST(CipherSegment, SegmentsMatchSingleCall) {
+    for(AESCIPHER_OPTMODE cm : kModes) {
+        SCOPED_TRACE(static_cast<int>(cm));
+        AESCIPHER ciph(AESKEY_LENBITS::_192, cm);
+        std::string plain = patternString(160);
+        std::string expected = encryptWhole(ciph, plain);
+
+        std::string segmented = plain;
+        uint8_t chain[AESCIPHER::CHAINING_BLOCK_SIZE];
+        ciph.initChainingBlock(chain);
+        uint8_t* p = reinterpret_cast<uint8_t*>(&segmented[0]);
+        ciph.encryptSegment(p, 48, p, chain);                                  // -In place, uneven segment sizes
+        ciph.encryptSegment(p + 48, 16, p + 48, chain);
+        ciph.encryptSegment(p + 64, 96, p + 64, chain);
+        EXPECT_EQ(expected, segmented);
+
+        ciph.initChainingBlock(chain);
+        ciph.decryptSegment(p, 80, p, chain);
+        ciph.decryptSegment(p + 80, 80, p + 80, chain);
+        EXPECT_EQ(plain, segmented);
+    }
+}
+
+TEST(CipherSegment, RejectsPartialBlocks) {
+    AESCIPHER ciph(AESKEY_LENBITS::_128, AESCIPHER_OPTMODE::CBC);
+    uint8_t data[40] = {0};
+    uint8_t chain[AESCIPHER::CHAINING_BLOCK_SIZE];
+    ciph.initChainingBlock(chain);
+    EXPECT_THROW(ciph.encryptSegment(data, 40, data, chain), std::invalid_argument);
+    EXPECT_THROW(ciph.decryptSegment(data, 32, data, nullptr), std::invalid_argument);
+}
+
+TEST(CipherSegment, ObservedEncryptionMatchesSingleCall) {
+    const size_t segment = AESCIPHER::OBSERVED_SEGMENT_SIZE;
+    for(AESCIPHER_OPTMODE cm : kModes) {
+        SCOPED_TRACE(static_cast<int>(cm));
+        AESCIPHER ciph(AESKEY_LENBITS::_128, cm);
+        for(size_t size : {size_t(16), segment, segment + 16, 3*segment + 48}) {
+            std::string plain = patternString(size);
+            std::string observed = plain;
+            uint8_t* p = reinterpret_cast<uint8_t*>(&observed[0]);
+            size_t covered = 0, pieces = 0;
+            ciph.encryptBytesObserved(p, size, p, [&](const uint8_t* piece, size_t pieceSize) {
+                EXPECT_EQ(p + covered, piece) << "Pieces are consecutive";
+                covered += pieceSize;
+                pieces++;
+            });
+            EXPECT_EQ(encryptWhole(ciph, plain), observed) << size << " bytes";
+            EXPECT_EQ(size, covered);
+            EXPECT_EQ((size + segment - 1) / segment, pieces) << size << " bytes";
+        }
+    }
+}
+
+TEST(CipherSegment, ObservedEncryptionRejectsBeforeWriting) {
+    for(AESCIPHER_OPTMODE cm : kModes) {
+        SCOPED_TRACE(static_cast<int>(cm));
+        AESCIPHER ciph(AESKEY_LENBITS::_128, cm);
+        const std::string plain = patternString(100003);                       // -Several segments, misaligned tail
+        std::string buffer = plain;
+        uint8_t* p = reinterpret_cast<uint8_t*>(&buffer[0]);
+        size_t observed = 0;
+        EXPECT_THROW(ciph.encryptBytesObserved(p, buffer.size(), p, [&](const uint8_t*, size_t size) noexcept { observed += size; }),
+                     std::invalid_argument);
+        EXPECT_EQ(0u, observed);
+        EXPECT_EQ(plain, buffer) << "Nothing encrypted in place";
+    }
+}
+
+TEST(CipherStream, InputStreamMatchesEncrypt) {
+    for(AESCIPHER_OPTMODE cm : kModes) {
+        SCOPED_TRACE(static_cast<int>(cm));
+        AESCIPHER ciph(AESKEY_LENBITS::_256, cm);
+        std::string plain = patternString(1000*16);
+        std::istringstream source(plain);
+        CipherFortis::icipherstream encrypted(source, ciph, STREAM_OP::Encrypt, 100);   // -Rounded down to 96 bytes
+        EXPECT_EQ(encrypted.rdbuf()->getBufferSize(), 96u);
+        std::string ciphertext = readAll(encrypted);
+        EXPECT_EQ(encryptWhole(ciph, plain), ciphertext);
+
+        std::istringstream cipherSource(ciphertext);
+        CipherFortis::icipherstream decrypted(cipherSource, ciph, STREAM_OP::Decrypt);
+        EXPECT_EQ(plain, readAll(decrypted));
+    }
+}
+
+TEST(CipherStream, OutputStreamMatchesEncrypt) {
+    for(AESCIPHER_OPTMODE cm : kModes) {
+        SCOPED_TRACE(static_cast<int>(cm));
+        AESCIPHER ciph(AESKEY_LENBITS::_128, cm);
+        std::string plain = patternString(257*16);
+        std::ostringstream sink;
+        {
+            CipherFortis::ocipherstream out(sink, ciph, STREAM_OP::Encrypt, 64);
+            for(size_t offset = 0; offset < plain.size(); offset += 37) {      // -Writes that straddle block boundaries
+                out.write(plain.data() + offset, static_cast<std::streamsize>(std::min<size_t>(37, plain.size() - offset)));
+                out.flush();
+            }
+            out.close();
+            EXPECT_TRUE(out.good());
+        }
+        EXPECT_EQ(encryptWhole(ciph, plain), sink.str());
+
+        std::ostringstream plainSink;
+        CipherFortis::ocipherstream out(plainSink, ciph, STREAM_OP::Decrypt);
+        out << sink.str();
+        out.close();
+        EXPECT_EQ(plain, plainSink.str());
+    }
+}
+
+TEST(CipherStream, PartialFinalBlockIsAnError) {
+    AESCIPHER ciph(AESKEY_LENBITS::_128, AESCIPHER_OPTMODE::CTR);
+    std::istringstream source(patternString(40));
+    CipherFortis::icipherstream in(source, ciph, STREAM_OP::Encrypt, 64);
+    char buffer[64];
+    in.read(buffer, sizeof(buffer));
+    EXPECT_TRUE(in.bad());
+
+    std::ostringstream sink;
+    CipherFortis::ocipherstream out(sink, ciph, STREAM_OP::Encrypt, 64);
+    out << patternString(40);
+    EXPECT_THROW(out.close(), std::runtime_error);
+    EXPECT_TRUE(out.fail());
+}
+
+TEST(CipherStream, BufferMustHoldOneBlock) {
+    AESCIPHER ciph(AESKEY_LENBITS::_128, AESCIPHER_OPTMODE::ECB);
+    std::istringstream source;
+    EXPECT_THROW(CipherFortis::icipherstream(source, ciph, STREAM_OP::Encrypt, 15), std::invalid_argument);
+}
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstring>
+#include <set>
+#include <thread>
+#include "../../core-crypto/include/ctr_drbg.hpp"
+#include "../../core-crypto/include/cipher.hpp"
+
+#define AESKEY CipherFortis::Key
+#define AESKEY_LENBITS CipherFortis::Key::LengthBits
+#define AESCIPHER CipherFortis::Cipher
+#define AESCIPHER_OPTMODE CipherFortis::Cipher::OperationMode::Identifier
+
+namespace {
+std::vector<uint8_t> aes256ecb(const std::vector<uint8_t>& key, const std::vector<uint8_t>& blocks) {
+    AESCIPHER ciph(AESKEY(key, AESKEY_LENBITS::_256), AESCIPHER::OperationMode(AESCIPHER_OPTMODE::ECB));
+    std::vector<uint8_t> out(blocks.size());
+    ciph.encrypt(blocks.data(), blocks.size(), out.data());
+    return out;
+}
+
+std::vector<uint8_t> counterBlock(const std::vector<uint8_t>& V, unsigned add) {
+    std::vector<uint8_t> block(V);
+    for(int i = 15; i >= 0 && add != 0; i--) {
+        unsigned sum = block[static_cast<size_t>(i)] + add;
+        block[static_cast<size_t>(i)] = static_cast<uint8_t>(sum);
+        add = sum >> 8;
+    }
+    return block;
+}
+}
+
+// Instantiate and first generate recomputed with the block cipher, following SP800-90A section 10.2.1.
+TEST(CtrDrbg, MatchesSP800_90AConstruction) {
+    uint8_t seed[CipherFortis::CtrDrbg::SEED_LENGTH];
+    for(size_t i = 0; i < sizeof(seed); i++) seed[i] = static_cast<uint8_t>(0xA0 + i);
+
+    // Update(seed) from Key = 0, V = 0
+    std::vector<uint8_t> zeroV(16, 0), counters;
+    for(unsigned j = 1; j <= 3; j++) {
+        std::vector<uint8_t> c = counterBlock(zeroV, j);
+        counters.insert(counters.end(), c.begin(), c.end());
+    }
+    std::vector<uint8_t> temp = aes256ecb(std::vector<uint8_t>(32, 0), counters);
+    for(size_t i = 0; i < temp.size(); i++) temp[i] ^= seed[i];
+    std::vector<uint8_t> key(temp.begin(), temp.begin() + 32), V(temp.begin() + 32, temp.end());
+
+    // Generate: E(Key, V+1) || E(Key, V+2)
+    std::vector<uint8_t> generateCounters = counterBlock(V, 1);
+    std::vector<uint8_t> second = counterBlock(V, 2);
+    generateCounters.insert(generateCounters.end(), second.begin(), second.end());
+    std::vector<uint8_t> expected = aes256ecb(key, generateCounters);
+
+    CipherFortis::CtrDrbg drbg(seed);
+    std::vector<uint8_t> output(32);
+    drbg.fill(output);
+    EXPECT_EQ(expected, output);
+}
+
+TEST(CtrDrbg, DeterministicForSameSeed) {
+    uint8_t seed[CipherFortis::CtrDrbg::SEED_LENGTH] = {1, 2, 3};
+    CipherFortis::CtrDrbg a(seed), b(seed);
+    std::vector<uint8_t> outA(100000 + 7), outB(100000 + 7);                   // -Crosses the per-request limit, ends mid-block
+    a.fill(outA);
+    b.fill(outB);
+    EXPECT_EQ(outA, outB);
+
+    seed[0] ^= 1;
+    CipherFortis::CtrDrbg c(seed);
+    std::vector<uint8_t> outC(outA.size());
+    c.fill(outC);
+    EXPECT_NE(outA, outC);
+}
+
+TEST(CtrDrbg, SuccessiveRequestsDiffer) {
+    CipherFortis::CtrDrbg& drbg = CipherFortis::CtrDrbg::threadLocal();
+    std::vector<uint8_t> first(32), second(32);
+    drbg.fill(first);
+    drbg.fill(second);
+    EXPECT_NE(first, second);
+    EXPECT_NE(first, std::vector<uint8_t>(32, 0));
+    drbg.reseed();
+    EXPECT_NO_THROW(drbg.fill(first));
+}
+
+TEST(CtrDrbg, ThreadLocalInstancesAreIndependent) {
+    std::vector<std::vector<uint8_t>> outputs(4, std::vector<uint8_t>(32));
+    std::vector<const CipherFortis::CtrDrbg*> instances(4);
+    std::atomic<size_t> filled{0};
+    std::vector<std::thread> threads;
+    for(size_t t = 0; t < outputs.size(); t++) {
+        threads.emplace_back([&outputs, &instances, &filled, t]() {
+            instances[t] = &CipherFortis::CtrDrbg::threadLocal();
+            CipherFortis::CtrDrbg::threadLocal().fill(outputs[t]);
+            filled++;
+            while(filled < outputs.size()) std::this_thread::yield();          // -All alive: addresses cannot be reused
+        });
+    }
+    for(std::thread& th : threads) th.join();
+    std::set<std::vector<uint8_t>> distinct(outputs.begin(), outputs.end());
+    EXPECT_EQ(distinct.size(), outputs.size());
+    std::set<const CipherFortis::CtrDrbg*> distinctInstances(instances.begin(), instances.end());
+    EXPECT_EQ(distinctInstances.size(), instances.size());
+}
+
+TEST(CtrDrbg, KeysAndIVsAreFresh) {
+    AESKEY k1(AESKEY_LENBITS::_192), k2(AESKEY_LENBITS::_192);
+    EXPECT_FALSE(k1 == k2);
+
+    AESCIPHER::OperationMode m1(AESCIPHER_OPTMODE::CBC), m2(AESCIPHER_OPTMODE::CBC);
+    ASSERT_NE(m1.getIVpointerData(), nullptr);
+    EXPECT_NE(0, std::memcmp(m1.getIVpointerData(), m2.getIVpointerData(), 16));
+}
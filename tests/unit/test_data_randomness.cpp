@@ -0,0 +1,146 @@
+// Unit test suite for DataRandomness and ByteMoments
+#include <gtest/gtest.h>
+#include "../../analysis/include/data_randomness.hpp"
+#include "../../analysis/include/byte_moments.hpp"
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// Interleaved 3-channel data: channel 0 cycles through all 256 values, channel 1 is constant, channel 2 alternates
+static std::vector<std::byte> interleaved(size_t pixels) {
+    std::vector<std::byte> data(pixels * 3);
+    for (size_t i = 0; i < pixels; i++) {
+        data[i * 3]     = static_cast<std::byte>(i & 0xFF);
+        data[i * 3 + 1] = static_cast<std::byte>(7);
+        data[i * 3 + 2] = static_cast<std::byte>(i % 2 == 0 ? 0 : 255);
+    }
+    return data;
+}
+
+TEST(DataRandomnessTest, SubArrayMeasuresOneChannel) {
+    const std::vector<std::byte> data = interleaved(1024);
+
+    DataRandomness cycle = DataRandomness::calculateDataRandomnessSubArray(data, 0, 3);
+    EXPECT_DOUBLE_EQ(8.0, cycle.getEntropy());
+    EXPECT_NEAR(0.0, cycle.getChiSquare(), 1e-9) << "Each value exactly 4 times in 1024 samples";
+    EXPECT_GT(cycle.getCorrelationAdjacentByte(), 0.9) << "Ramp: neighbours are close";
+
+    DataRandomness constant = DataRandomness::calculateDataRandomnessSubArray(data, 1, 3);
+    EXPECT_DOUBLE_EQ(0.0, constant.getEntropy());
+
+    DataRandomness alternating = DataRandomness::calculateDataRandomnessSubArray(data, 2, 3);
+    EXPECT_DOUBLE_EQ(1.0, alternating.getEntropy());
+    EXPECT_NEAR(-1.0, alternating.getCorrelationAdjacentByte(), 1e-9);
+
+    // Copies keep the whole frequency table and the metrics
+    DataRandomness copy(alternating);
+    EXPECT_DOUBLE_EQ(alternating.getEntropy(), copy.getEntropy());
+    EXPECT_DOUBLE_EQ(alternating.getChiSquare(), copy.getChiSquare());
+}
+
+TEST(DataRandomnessTest, SubArrayEdgeCases) {
+    const std::vector<std::byte> data = interleaved(256);
+    DataRandomness whole(data);
+    DataRandomness sameAsWhole = DataRandomness::calculateDataRandomnessSubArray(data, 0, 1);
+    EXPECT_DOUBLE_EQ(whole.getEntropy(), sameAsWhole.getEntropy());
+    EXPECT_DOUBLE_EQ(whole.getChiSquare(), sameAsWhole.getChiSquare());
+    EXPECT_DOUBLE_EQ(whole.getEntropy(), DataRandomness::calculateDataRandomnessSubArray(data, 0, 0).getEntropy())
+        << "A jump of zero is read as one";
+    EXPECT_TRUE(std::isfinite(DataRandomness::calculateDataRandomnessSubArray(data, 5, 0).getChiSquare()));
+    EXPECT_THROW(DataRandomness::calculateDataRandomnessSubArray(std::vector<std::byte>(), 0, 1), std::runtime_error);
+    EXPECT_THROW(DataRandomness::calculateDataRandomnessSubArray(data, data.size(), 1), std::out_of_range)
+        << "No wrapping into an unrelated sub-array";
+}
+
+// Reference: the multi-pass double-precision computation DataRandomness used before ByteMoments
+static double reference_correlation(const std::vector<uint8_t>& x, size_t k) {
+    const size_t n = x.size();
+    double average = 0.0, variance = 0.0, covariance = 0.0;
+    for (uint8_t v : x) average += v;
+    average /= static_cast<double>(n);
+    for (size_t i = 0; i < n; i++) {
+        variance   += (x[i] - average) * (x[i] - average);
+        covariance += (x[i] - average) * (x[(i + k) % n] - average);
+    }
+    return covariance / variance;
+}
+
+TEST(ByteMomentsTest, MatchesMultiPassComputation) {
+    std::mt19937 rng(7);
+    std::vector<uint8_t> data(200000);                                          // -Several sweep blocks
+    for (size_t i = 0; i < data.size(); i++) data[i] = static_cast<uint8_t>((rng() % 64) + (i % 200));
+
+    const ByteMoments m = ByteMoments::measure(data.data(), data.size(), {1, 2, 77, 200000 + 3});
+    ASSERT_EQ(data.size(), m.count);
+    EXPECT_EQ(3u, m.lags[3]) << "Lags wrap modulo the length";
+
+    uint64_t histogram[256] = {0}, sum = 0, squares = 0;
+    for (uint8_t v : data) { histogram[v]++; sum += v; squares += uint64_t(v) * v; }
+    EXPECT_EQ(0, std::memcmp(histogram, m.histogram, sizeof(histogram)));
+    EXPECT_EQ(sum, m.sum());
+    EXPECT_EQ(squares, m.sumSquares());
+    for (size_t l = 0; l < m.lags.size(); l++) {
+        uint64_t products = 0;
+        for (size_t i = 0; i < data.size(); i++) products += uint64_t(data[i]) * data[(i + m.lags[l]) % data.size()];
+        EXPECT_EQ(products, m.lagProducts[l]) << "Lag " << m.lags[l];
+        EXPECT_NEAR(reference_correlation(data, m.lags[l]), m.correlation(l), 1e-12);
+    }
+
+    // Entropy and chi-square are bit-identical to the DataRandomness formulas
+    std::vector<std::byte> bytes(reinterpret_cast<const std::byte*>(data.data()),
+                                 reinterpret_cast<const std::byte*>(data.data()) + data.size());
+    DataRandomness dr(bytes);
+    EXPECT_EQ(dr.getEntropy(), m.entropy());
+    EXPECT_EQ(dr.getChiSquare(), m.chiSquare());
+    EXPECT_EQ(m.correlation(0), dr.getCorrelationAdjacentByte());
+    EXPECT_EQ(m.correlation(1), DataRandomness::calculateCorrelation(bytes, 2));
+}
+
+TEST(ByteMomentsTest, StridedSequences) {
+    std::vector<uint8_t> data(3 * 1001);
+    for (size_t i = 0; i < data.size(); i++) data[i] = static_cast<uint8_t>(i * 37 ^ (i >> 3));
+    for (size_t start : {0, 1, 2}) {
+        std::vector<uint8_t> channel;
+        for (size_t i = start; i < data.size(); i += 3) channel.push_back(data[i]);
+        const ByteMoments strided = ByteMoments::measure(data.data(), data.size(), start, 3, {1, 5});
+        const ByteMoments packed = ByteMoments::measure(channel.data(), channel.size(), {1, 5});
+        EXPECT_EQ(packed.count, strided.count);
+        EXPECT_EQ(0, std::memcmp(packed.histogram, strided.histogram, sizeof(packed.histogram)));
+        EXPECT_EQ(packed.lagProducts, strided.lagProducts);
+    }
+    EXPECT_EQ(2u, ByteMoments::measure(data.data(), 5, 1, 3, {1}).count) << "Elements 1 and 4";
+
+    const uint8_t constant[32] = {9};
+    EXPECT_TRUE(std::isnan(ByteMoments::measure(constant + 1, 31, {1}).correlation(0)));
+    EXPECT_THROW(ByteMoments::measure(data.data(), 10, 10, 1, {1}), std::invalid_argument);
+    EXPECT_THROW(ByteMoments::measure(data.data(), 10, 0, 0, {1}), std::invalid_argument);
+    EXPECT_THROW(ByteMoments::measure(nullptr, 10, {1}), std::invalid_argument);
+    EXPECT_THROW(ByteMoments::measure(data.data(), 10, {1}).correlation(1), std::out_of_range);
+}
+
+TEST(ByteMomentsTest, ParallelMatchesSerial) {
+    std::mt19937 rng(13);
+    std::vector<uint8_t> data(9 * 1024 * 1024 + 5);                             // -Enough elements to split, strided too
+    for (size_t i = 0; i < data.size(); i++) data[i] = static_cast<uint8_t>(rng() % 97 + (i >> 16));
+
+    for (size_t stride : {1, 3}) {
+        const size_t count = (data.size() - 1) / stride + 1;
+        const std::vector<size_t> lags = {1, 2, 1500000, count - 1};            // -Pairs crossing one and several chunks
+        const ByteMoments serial = ByteMoments::measure(data.data(), data.size(), 1, stride, lags, 1);
+        for (size_t threads : {0, 2, 3, 4, 7}) {
+            const ByteMoments parallel = ByteMoments::measure(data.data(), data.size(), 1, stride, lags, threads);
+            EXPECT_EQ(serial.count, parallel.count);
+            EXPECT_EQ(0, std::memcmp(serial.histogram, parallel.histogram, sizeof(serial.histogram)))
+                << "Stride " << stride << ", " << threads << " threads";
+            EXPECT_EQ(serial.lagProducts, parallel.lagProducts) << "Stride " << stride << ", " << threads << " threads";
+        }
+    }
+
+    std::vector<std::byte> bytes(reinterpret_cast<const std::byte*>(data.data()),
+                                 reinterpret_cast<const std::byte*>(data.data()) + data.size());
+    const DataRandomness serial(bytes, 1), parallel(bytes, 4);
+    EXPECT_EQ(serial.getEntropy(), parallel.getEntropy());
+    EXPECT_EQ(serial.getChiSquare(), parallel.getChiSquare());
+    EXPECT_EQ(serial.getCorrelationAdjacentByte(), parallel.getCorrelationAdjacentByte());
+}
@@ -0,0 +1,147 @@
+// Unit test suite for File::EncryptionPipeline and File::BoundedQueue
+#include <gtest/gtest.h>
+#include <atomic>
+#include <filesystem>
+#include <thread>
+#include "../../file-handlers/include/encryption_pipeline.hpp"
+#include "../../file-handlers/include/bounded_queue.hpp"
+#include "../include/temp_dir_fixture.hpp"
+
+namespace fs = std::filesystem;
+
+#define AESKEY_LENBITS CipherFortis::Key::LengthBits
+#define AESCIPHER CipherFortis::Cipher
+#define AESCIPHER_OPTMODE CipherFortis::Cipher::OperationMode::Identifier
+
+class EncryptionPipelineTest : public TempDirFixture {
+protected:
+    fs::path plainPath = dir / "plain.bin";
+    fs::path cipherPath = dir / "cipher.bin";
+    fs::path roundTripPath = dir / "roundtrip.bin";
+
+    static std::vector<uint8_t> pattern(size_t size) {
+        std::vector<uint8_t> bytes(size);
+        for (size_t i = 0; i < size; i++) bytes[i] = static_cast<uint8_t>(i * 31 + (i >> 9));
+        return bytes;
+    }
+};
+
+TEST_F(EncryptionPipelineTest, MatchesWholeFileEncryption) {
+    const std::vector<uint8_t> plain = pattern(300 * 1024 + 48);               // -Last chunk is partial
+    writeFile(plainPath, plain);
+
+    for (AESCIPHER_OPTMODE cm : {AESCIPHER_OPTMODE::ECB, AESCIPHER_OPTMODE::CBC, AESCIPHER_OPTMODE::OFB, AESCIPHER_OPTMODE::CTR}) {
+        SCOPED_TRACE(static_cast<int>(cm));
+        AESCIPHER ciph(AESKEY_LENBITS::_192, cm);
+        std::vector<uint8_t> expected(plain.size());
+        ciph.encrypt(plain.data(), plain.size(), expected.data());
+
+        File::EncryptionPipeline::Config config;
+        config.chunkBytes = 16 * 1024;
+        config.workers = 3;
+        config.buffers = 4;                                                     // -Forces back-pressure
+        File::EncryptionPipeline pipeline(ciph, config);
+
+        File::EncryptionPipeline::Stats stats = pipeline.encrypt_file(plainPath, cipherPath);
+        EXPECT_EQ(expected, readFile(cipherPath));
+        EXPECT_EQ(19u, stats.chunks);
+        EXPECT_EQ(cm == AESCIPHER_OPTMODE::ECB || cm == AESCIPHER_OPTMODE::CTR ? 3u : 1u, stats.workers);
+        EXPECT_EQ(stats.chunks + stats.workers, stats.work.pushed);             // -Chunks plus end-of-work markers
+        EXPECT_EQ(stats.chunks, stats.done.pushed);
+        EXPECT_EQ(stats.chunks, stats.freeBuffers.pushed);
+        EXPECT_LE(stats.done.maxOccupancy, config.buffers);
+        EXPECT_LE(stats.freeBuffers.maxOccupancy, config.buffers);
+
+        stats = pipeline.decrypt_file(cipherPath, roundTripPath);
+        EXPECT_EQ(plain, readFile(roundTripPath));
+        EXPECT_EQ(cm == AESCIPHER_OPTMODE::OFB ? 1u : 3u, stats.workers);       // -CBC decryption runs in parallel
+    }
+}
+
+TEST_F(EncryptionPipelineTest, InPlaceAndDefaults) {
+    const std::vector<uint8_t> plain = pattern(5000 * 16);
+    writeFile(plainPath, plain);
+    AESCIPHER ciph(AESKEY_LENBITS::_256, AESCIPHER_OPTMODE::CBC);
+    std::vector<uint8_t> expected(plain.size());
+    ciph.encrypt(plain.data(), plain.size(), expected.data());
+
+    File::EncryptionPipeline::Config config;
+    config.chunkBytes = 1000;                                                   // -Rounded down to 992
+    File::EncryptionPipeline pipeline(ciph, config);
+    EXPECT_EQ(992u, pipeline.get_config().chunkBytes);
+    EXPECT_GE(pipeline.get_config().workers, 1u);
+    EXPECT_EQ(2 * pipeline.get_config().workers + 2, pipeline.get_config().buffers);
+
+    pipeline.encrypt_file(plainPath, plainPath);
+    EXPECT_EQ(expected, readFile(plainPath));
+    pipeline.decrypt_file(plainPath, plainPath);
+    EXPECT_EQ(plain, readFile(plainPath));
+    EXPECT_EQ(81u, pipeline.get_live_stats().chunks);
+}
+
+TEST_F(EncryptionPipelineTest, ConcurrentRunsKeepOwnStats) {
+    const fs::path smallPath = dir / "small.bin", smallOut = dir / "small_out.bin";
+    writeFile(plainPath, pattern(64 * 1024));
+    writeFile(smallPath, pattern(8 * 1024));
+    AESCIPHER ciph(AESKEY_LENBITS::_128, AESCIPHER_OPTMODE::CTR);
+    File::EncryptionPipeline::Config config;
+    config.chunkBytes = 1024;
+    config.workers = 2;
+    const File::EncryptionPipeline pipeline(ciph, config);
+
+    for (int round = 0; round < 8; round++) {
+        File::EncryptionPipeline::Stats large, small;
+        std::thread other([&]() { large = pipeline.encrypt_file(plainPath, cipherPath); });
+        small = pipeline.encrypt_file(smallPath, smallOut);
+        other.join();
+        EXPECT_EQ(64u, large.chunks);
+        EXPECT_EQ(64u, large.done.pushed) << "Counters of one run are not mixed with the other";
+        EXPECT_EQ(8u, small.chunks);
+        EXPECT_EQ(8u, small.done.pushed);
+    }
+}
+
+TEST_F(EncryptionPipelineTest, InvalidInputs) {
+    AESCIPHER ciph(AESKEY_LENBITS::_128, AESCIPHER_OPTMODE::ECB);
+    File::EncryptionPipeline::Config config;
+    config.chunkBytes = 15;
+    EXPECT_THROW(File::EncryptionPipeline(ciph, config), std::invalid_argument);
+
+    File::EncryptionPipeline pipeline(ciph);
+    writeFile(plainPath, pattern(33));
+    EXPECT_THROW(pipeline.encrypt_file(plainPath, cipherPath), std::invalid_argument);
+    EXPECT_THROW(pipeline.encrypt_file(dir / "missing.bin", cipherPath), std::runtime_error);
+}
+
+TEST(BoundedQueueTest, MultiProducerMultiConsumer) {
+    File::BoundedQueue<size_t> queue(6);
+    EXPECT_EQ(8u, queue.capacity());
+    EXPECT_THROW(File::BoundedQueue<size_t>(0), std::invalid_argument);
+
+    const size_t perProducer = 20000;
+    std::atomic<size_t> sum{0}, popped{0};
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < 2; p++) {
+        threads.emplace_back([&, p]() {
+            for (size_t i = 1; i <= perProducer; i++) {
+                while (!queue.try_push(p * perProducer + i)) std::this_thread::yield();
+            }
+        });
+    }
+    for (size_t c = 0; c < 2; c++) {
+        threads.emplace_back([&]() {
+            size_t value;
+            while (popped.load() < 2 * perProducer) {
+                if (queue.try_pop(value)) { sum += value; popped++; }
+                else std::this_thread::yield();
+            }
+        });
+    }
+    for (std::thread& t : threads) t.join();
+
+    const size_t n = 2 * perProducer;
+    EXPECT_EQ(n * (n + 1) / 2, sum.load());
+    size_t value;
+    EXPECT_FALSE(queue.try_pop(value));
+    EXPECT_EQ(0u, queue.size_approx());
+}
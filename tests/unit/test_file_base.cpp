@@ -3,7 +3,10 @@
 #include "../../file-handlers/include/file_base.hpp"
 #include "../include/file_base_fixture.hpp"
 #include "../../core-crypto/include/encryptor.hpp"
+#include "../../core-crypto/include/cipher.hpp"
+#include "../../analysis/include/data_randomness.hpp"
 #include <filesystem>
+#include <cstring>
 
 namespace fs = std::filesystem;
 
@@ -19,6 +22,21 @@ public:
     }
 };
 
+// Mock of a padding mode: XOR with 0xAB plus PKCS#7-style padding to 16 bytes, so the ciphertext is longer
+class PaddingEncryptor : public Encryptor {
+public:
+    void encryption(const std::vector<uint8_t>& in, std::vector<uint8_t>& out) const override {
+        const uint8_t pad = static_cast<uint8_t>(16 - in.size() % 16);
+        out.assign(in.size() + pad, pad);
+        for (size_t i = 0; i < in.size(); i++) out[i] = in[i] ^ 0xAB;
+    }
+    void decryption(const std::vector<uint8_t>& in, std::vector<uint8_t>& out) const override {
+        out.resize(in.size() - in.back());
+        for (size_t i = 0; i < out.size(); i++) out[i] = in[i] ^ 0xAB;
+    }
+    bool preservesLength() const override { return false; }
+};
+
 TEST_F(FileBaseFixture, LoadOperations) {
     EXPECT_THROW({
         File::FileBase fb(nonexistentPath);
@@ -39,7 +57,7 @@ TEST_F(FileBaseFixture, EncryptionDecryption) {
     {
         File::FileBase fb(validFilePath);
         fb.load();
-        std::vector<uint8_t> original = fb.get_data();
+        std::vector<uint8_t> original = fb.get_data().to_vector();
         fb.apply_encryption(xor_enc);
         EXPECT_NE(fb.get_data(), original) << "Encrypted data differs from original";
     }
@@ -47,7 +65,7 @@ TEST_F(FileBaseFixture, EncryptionDecryption) {
     {
         File::FileBase fb(validFilePath);
         fb.load();
-        std::vector<uint8_t> original = fb.get_data();
+        std::vector<uint8_t> original = fb.get_data().to_vector();
         fb.apply_encryption(xor_enc);
         fb.apply_decryption(xor_enc);
         EXPECT_EQ(fb.get_data(), original) << "Decrypt after encrypt restores original data";
@@ -61,7 +79,7 @@ TEST_F(FileBaseFixture, SaveOperations) {
     {
         File::FileBase fb(validFilePath);
         fb.load();
-        std::vector<uint8_t> original = fb.get_data();
+        std::vector<uint8_t> original = fb.get_data().to_vector();
         fb.apply_encryption(xor_enc);
         fb.save();
 
@@ -90,3 +108,143 @@ TEST_F(FileBaseFixture, SaveOperations) {
         fs::remove(outputPath);
     }
 }
+
+TEST_F(FileBaseFixture, MappedPrivateStorage) {
+    XorEncryptor xor_enc;
+    File::FileBase buffered(validFilePath);
+    buffered.load();
+    std::vector<uint8_t> original = buffered.get_data().to_vector();
+
+    File::FileBase fb(validFilePath, File::FileBase::Storage::MappedPrivate);
+    fb.load();
+    ASSERT_EQ(original.size(), fb.get_size());
+    EXPECT_EQ(0, std::memcmp(original.data(), fb.get_bytes(), fb.get_size()));
+    EXPECT_THROW(fb.get_data(), std::logic_error) << "Mapped content is not exposed as a vector";
+
+    fb.apply_encryption(xor_enc);
+    EXPECT_EQ(original[0] ^ 0xAB, fb.get_bytes()[0]);
+
+    File::FileBase untouched(validFilePath);
+    untouched.load();
+    EXPECT_EQ(original, untouched.get_data()) << "Private mapping does not write through to the file";
+
+    fb.save();                                                                  // -Write back over the mapped file itself
+    File::FileBase reloaded(validFilePath);
+    reloaded.load();
+    ASSERT_EQ(original.size(), reloaded.get_size());
+    for (size_t i = 0; i < original.size(); i++) EXPECT_EQ(original[i] ^ 0xAB, reloaded.get_data()[i]);
+}
+
+TEST_F(FileBaseFixture, MappedSharedStorage) {
+    XorEncryptor xor_enc;
+    File::FileBase buffered(validFilePath);
+    buffered.load();
+    std::vector<uint8_t> original = buffered.get_data().to_vector();
+
+    {
+        File::FileBase fb(validFilePath, File::FileBase::Storage::MappedShared);
+        fb.load();
+        fb.apply_encryption(xor_enc);
+        fb.save();
+    }
+    File::FileBase reloaded(validFilePath);
+    reloaded.load();
+    EXPECT_NE(original, reloaded.get_data()) << "Shared mapping encrypts the file in place";
+
+    {
+        File::FileBase fb(validFilePath, File::FileBase::Storage::MappedShared);
+        fb.load();
+        fb.apply_decryption(xor_enc);
+    }
+    File::FileBase restored(validFilePath);
+    restored.load();
+    EXPECT_EQ(original, restored.get_data());
+}
+
+TEST_F(FileBaseFixture, EncryptAndMeasure) {
+    XorEncryptor xor_enc;                                                       // -Default Encryptor: one piece
+    CipherFortis::Cipher cipher(CipherFortis::Key::LengthBits::_128, CipherFortis::Cipher::OperationMode::Identifier::CTR);
+    for (const Encryptor* algorithm : {static_cast<const Encryptor*>(&xor_enc), static_cast<const Encryptor*>(&cipher)}) {
+        File::FileBase expected(validFilePath), measured(validFilePath);
+        expected.load();
+        measured.load();
+        expected.apply_encryption(*algorithm);
+        const DataRandomness metrics = measured.encrypt_and_measure(*algorithm);
+        EXPECT_EQ(expected.get_data(), measured.get_data()) << "Same ciphertext as apply_encryption()";
+        const DataRandomness reference = expected.calculate_randomness();
+        EXPECT_EQ(reference.getEntropy(), metrics.getEntropy());
+        EXPECT_EQ(reference.getChiSquare(), metrics.getChiSquare());
+        EXPECT_EQ(reference.getCorrelationAdjacentByte(), metrics.getCorrelationAdjacentByte());
+    }
+}
+
+TEST_F(FileBaseFixture, EncryptToMappedOutput) {
+    XorEncryptor xor_enc;
+    fs::path outputPath = testDataDir / "encrypted_to.bin";
+
+    for (File::FileBase::Storage storage : {File::FileBase::Storage::Buffered, File::FileBase::Storage::MappedPrivate}) {
+        File::FileBase fb(validFilePath, storage);
+        fb.load();
+        fb.encrypt_to(xor_enc, outputPath);
+
+        File::FileBase out(outputPath);
+        out.load();
+        ASSERT_EQ(fb.get_size(), out.get_size());
+        for (size_t i = 0; i < out.get_size(); i++) EXPECT_EQ(fb.get_bytes()[i] ^ 0xAB, out.get_data()[i]);
+
+        EXPECT_THROW(fb.encrypt_to(xor_enc, validFilePath), std::invalid_argument);
+    }
+    fs::remove(outputPath);
+}
+
+TEST_F(FileBaseFixture, LengthChangingEncryptor) {
+    PaddingEncryptor padding;
+    fs::path outputPath = testDataDir / "padded_to.bin";
+    File::FileBase buffered(validFilePath);
+    buffered.load();
+    const std::vector<uint8_t> original = buffered.get_data().to_vector();
+
+    uint8_t block[16] = {};
+    EXPECT_THROW(padding.encryptBytes(block, sizeof(block), block), std::length_error)
+        << "Raw-buffer default refuses to truncate the padded output";
+
+    for (File::FileBase::Storage storage : {File::FileBase::Storage::Buffered, File::FileBase::Storage::MappedPrivate}) {
+        File::FileBase fb(validFilePath, storage);
+        fb.load();
+        fb.encrypt_to(padding, outputPath);
+        File::FileBase out(outputPath);
+        out.load();
+        EXPECT_EQ(original.size() + 16, out.get_size()) << "encrypt_to() writes the whole padded ciphertext";
+
+        fb.apply_encryption(padding);
+        EXPECT_EQ(File::FileBase::Storage::Buffered, fb.get_storage()) << "Content of the new length is buffered";
+        EXPECT_EQ(out.get_data(), fb.get_data());
+        fb.apply_decryption(padding);
+        EXPECT_EQ(original, fb.get_data());
+    }
+
+    File::FileBase untouched(validFilePath);
+    untouched.load();
+    EXPECT_EQ(original, untouched.get_data()) << "Private mapping is dropped, not written through";
+    fs::remove(outputPath);
+}
+
+TEST_F(FileBaseFixture, MoveTransfersContent) {
+    File::FileBase buffered(validFilePath);
+    buffered.load();
+    const std::vector<uint8_t> original = buffered.get_data().to_vector();
+
+    File::FileBase moved(std::move(buffered));
+    EXPECT_EQ(original, moved.get_data());
+    EXPECT_EQ(0u, buffered.get_size()) << "Moved-from object is left empty";
+
+    File::FileBase mapped(validFilePath, File::FileBase::Storage::MappedPrivate);
+    mapped.load();
+    const uint8_t* bytes = mapped.get_bytes();
+    File::FileBase target(nonexistentPath);
+    target = std::move(mapped);
+    EXPECT_EQ(File::FileBase::Storage::MappedPrivate, target.get_storage());
+    EXPECT_EQ(bytes, target.get_bytes()) << "The mapping itself is handed over, not copied";
+    EXPECT_EQ(File::FileBase::Storage::Buffered, mapped.get_storage());
+    EXPECT_EQ(0u, mapped.get_size());
+}
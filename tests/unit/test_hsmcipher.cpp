@@ -218,6 +218,45 @@ TEST_F(HSMCipherTest, NistCbcRoundtrip) {
     }
 }
 
+TEST_F(HSMCipherTest, NistCbcRawBytesInPlace) {
+    // encryptBytes() keeps the length: unpadded CBC, so the NIST vector is matched exactly.
+    SCOPED_TRACE("NIST CBC raw buffers (SP 800-38A)");
+    try {
+        HSMSession session(LIB_PATH, TOKEN_LABEL, USER_PIN);
+        HSMCipher  cipher(session, Cipher::OperationMode::Identifier::CBC);
+
+        auto vec      = SP::CBC::create(KS);
+        auto key_vec  = vec->getKey();
+        auto input    = vec->getInput();
+        auto iv_vec   = vec->getIV();
+        auto expected = vec->getExpectedOutput();
+
+        HSMKeyHandle key = importTestKey(
+            session, reinterpret_cast<const uint8_t*>(key_vec.data()),
+            key_vec.size(), "nist-cbc-raw");
+        cipher.setActiveKey(key);
+        cipher.setIV(std::vector<uint8_t>(iv_vec.begin(), iv_vec.end()));
+
+        std::vector<uint8_t> buffer(input.begin(), input.begin() + SP::kDataSize);
+        cipher.encryptBytes(buffer.data(), buffer.size(), buffer.data());
+        EXPECT_EQ(0, memcmp(
+            reinterpret_cast<const uint8_t*>(expected.data()),
+            buffer.data(), SP::kDataSize))
+            << "CBC raw ciphertext matches SP 800-38A expected";
+
+        cipher.decryptBytes(buffer.data(), buffer.size(), buffer.data());
+        EXPECT_EQ(0, memcmp(
+            reinterpret_cast<const uint8_t*>(input.data()),
+            buffer.data(), SP::kDataSize))
+            << "CBC raw roundtrip preserves plaintext";
+
+        EXPECT_THROW(cipher.encryptBytes(buffer.data(), 20, buffer.data()),
+                     std::invalid_argument) << "Partial block";
+    } catch (const std::exception& e) {
+        FAIL() << "Exception: " << e.what();
+    }
+}
+
 /* Uncomment only with confirmation of OFB mode support
 TEST_F(HSMCipherTest, NistOfbEncryptMatchesNist) { ... }
 TEST_F(HSMCipherTest, NistOfbRoundtrip) { ... }
@@ -0,0 +1,71 @@
+// Unit test suite for ImageCorrelation: neighbour correlations of image channels
+#include <gtest/gtest.h>
+#include "../../analysis/include/image_correlation.hpp"
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+// Pearson's coefficient straight from the list of pairs
+static double pairwise_correlation(const std::vector<uint8_t>& image, size_t w, size_t h, size_t channels, size_t c,
+                                   size_t dr, size_t dc) {
+    double n = 0, sx = 0, sy = 0, sxx = 0, syy = 0, sxy = 0;
+    for (size_t r = 0; r + dr < h; r++) {
+        for (size_t col = 0; col + dc < w; col++) {
+            const double x = image[(r * w + col) * channels + c], y = image[((r + dr) * w + col + dc) * channels + c];
+            n++; sx += x; sy += y; sxx += x * x; syy += y * y; sxy += x * y;
+        }
+    }
+    return (n * sxy - sx * sy) / std::sqrt((n * sxx - sx * sx) * (n * syy - sy * sy));
+}
+
+TEST(ImageCorrelationTest, MatchesPairwiseDefinition) {
+    using Direction = ImageCorrelation::Direction;
+    std::mt19937 rng(19);
+    const size_t shapes[][3] = {{37, 23, 3}, {101, 5, 1}, {2, 50, 2}, {33, 17, 4}, {1000, 3, 3}};  // -Rows around the lane width
+    for (const auto& shape : shapes) {
+        const size_t w = shape[0], h = shape[1], channels = shape[2];
+        std::vector<uint8_t> image(w * h * channels);
+        for (size_t i = 0; i < image.size(); i++)                              // -Smooth gradient plus noise
+            image[i] = static_cast<uint8_t>((i / channels) % w * 3 + (i / channels) / w * 2 + rng() % 40 + (i % channels) * 20);
+        const ImageCorrelation measured = ImageCorrelation::measure(image.data(), w, h, channels, 1);
+        ASSERT_EQ(channels, measured.channels());
+        for (size_t c = 0; c < channels; c++) {
+            SCOPED_TRACE(std::to_string(w) + "x" + std::to_string(h) + "x" + std::to_string(channels) + ", channel " + std::to_string(c));
+            EXPECT_EQ(h * (w - 1), measured.moments(c, Direction::Horizontal).count);
+            EXPECT_NEAR(pairwise_correlation(image, w, h, channels, c, 0, 1), measured.correlation(c, Direction::Horizontal), 1e-9);
+            EXPECT_NEAR(pairwise_correlation(image, w, h, channels, c, 1, 0), measured.correlation(c, Direction::Vertical), 1e-9);
+            EXPECT_NEAR(pairwise_correlation(image, w, h, channels, c, 1, 1), measured.correlation(c, Direction::Diagonal), 1e-9);
+        }
+    }
+
+    const uint8_t column[4] = {1, 2, 3, 4};                                     // -No horizontal neighbours
+    const ImageCorrelation narrow = ImageCorrelation::measure(column, 1, 4, 1);
+    EXPECT_TRUE(std::isnan(narrow.correlation(0, Direction::Horizontal)));
+    EXPECT_TRUE(std::isnan(narrow.correlation(0, Direction::Diagonal)));
+    EXPECT_DOUBLE_EQ(1.0, narrow.correlation(0, Direction::Vertical));
+    EXPECT_THROW(narrow.moments(1, Direction::Vertical), std::out_of_range);
+    EXPECT_THROW(ImageCorrelation::measure(column, 1, 1, 5), std::invalid_argument);
+    EXPECT_THROW(ImageCorrelation::measure(column, 0, 4, 1), std::invalid_argument);
+}
+
+TEST(ImageCorrelationTest, ParallelMatchesSerial) {
+    using Direction = ImageCorrelation::Direction;
+    std::mt19937 rng(23);
+    const size_t w = 1031, h = 713, channels = 3;                               // -Above the 2 MiB parallel threshold
+    std::vector<uint8_t> image(w * h * channels);
+    for (uint8_t& v : image) v = static_cast<uint8_t>(rng());
+    const ImageCorrelation serial = ImageCorrelation::measure(image.data(), w, h, channels, 1);
+    for (size_t threads : {0, 2, 5}) {
+        const ImageCorrelation parallel = ImageCorrelation::measure(image.data(), w, h, channels, threads);
+        for (size_t c = 0; c < channels; c++) {
+            for (Direction d : {Direction::Horizontal, Direction::Vertical, Direction::Diagonal}) {
+                const ImageCorrelation::Moments &a = serial.moments(c, d), &b = parallel.moments(c, d);
+                EXPECT_EQ(a.sumX, b.sumX);
+                EXPECT_EQ(a.sumYY, b.sumYY);
+                EXPECT_EQ(a.sumXY, b.sumXY) << threads << " threads, " << ImageCorrelation::DirectionLabels[static_cast<unsigned>(d)];
+            }
+        }
+    }
+    EXPECT_LT(std::fabs(serial.correlation(1, Direction::Diagonal)), 0.01) << "Random pixels";
+}
@@ -0,0 +1,212 @@
+// Unit test suite for File::JpegCoefficients: baseline JPEG entropy coding and coefficient-domain encryption
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <vector>
+#include "../../core-crypto/include/cipher.hpp"
+#include "../../file-handlers/include/jpeg_coefficients.hpp"
+#include "../../third-party/stb/stb_image.h"
+#include "../../third-party/stb/stb_image_write.h"
+
+namespace fs = std::filesystem;
+using namespace CipherFortis;
+
+class JpegCoefficientsTest : public ::testing::Test {
+protected:
+    static void append(void* context, void* data, int size) {
+        std::vector<uint8_t>* out = static_cast<std::vector<uint8_t>*>(context);
+        out->insert(out->end(), static_cast<uint8_t*>(data), static_cast<uint8_t*>(data) + size);
+    }
+    // Smooth content plus some texture, encoded by stb_image_write as YCbCr (quality <= 90 subsamples chroma 4:2:0).
+    static std::vector<uint8_t> jpeg(int width, int height, int channels, int quality, uint32_t seed = 1) {
+        std::vector<uint8_t> pixels(static_cast<size_t>(width * height * channels));
+        for (size_t i = 0; i < pixels.size(); i++) {
+            seed = seed * 1103515245u + 12345u;
+            const size_t x = (i / static_cast<size_t>(channels)) % static_cast<size_t>(width);
+            const size_t y = i / static_cast<size_t>(channels * width);
+            pixels[i] = static_cast<uint8_t>(x * 3 + y * 2 + (i % static_cast<size_t>(channels)) * 60 + (seed >> 28));
+        }
+        std::vector<uint8_t> out;
+        stbi_write_jpg_to_func(append, &out, width, height, channels, pixels.data(), quality);
+        return out;
+    }
+    static std::vector<uint8_t> decode(const std::vector<uint8_t>& file, int& width, int& height, int& channels) {
+        uint8_t* pixels = stbi_load_from_memory(file.data(), static_cast<int>(file.size()), &width, &height, &channels, 0);
+        if (pixels == nullptr) return {};
+        std::vector<uint8_t> bytes(pixels, pixels + width * height * channels);
+        stbi_image_free(pixels);
+        return bytes;
+    }
+    static Cipher cipher(Cipher::OperationMode::Identifier mode) {
+        const std::vector<uint8_t> keyBytes(16, 0x2B);
+        Cipher::OperationMode optmode(mode);
+        if (mode != Cipher::OperationMode::Identifier::ECB) optmode.setInitialVector(std::vector<uint8_t>(16, 0x5A));
+        return Cipher(Key(keyBytes, Key::LengthBits::_128), optmode);
+    }
+};
+
+TEST_F(JpegCoefficientsTest, ReencodesUnmodifiedFilesByteForByte) {
+    for (int quality : {30, 75, 95}) {
+        SCOPED_TRACE(quality);
+        const std::vector<uint8_t> file = jpeg(123, 77, 3, quality);
+        File::JpegCoefficients coefficients(file.data(), file.size());
+        EXPECT_EQ(123, coefficients.width());
+        EXPECT_EQ(77, coefficients.height());
+        ASSERT_EQ(3u, coefficients.components().size());
+        const size_t subsampling = quality <= 90 ? 2 : 1;
+        EXPECT_EQ(16u, coefficients.components()[0].blocksPerLine);             // -Whole MCUs: 123 -> 128
+        EXPECT_EQ(16u, coefficients.components()[1].blocksPerLine * subsampling);
+        EXPECT_EQ(file, coefficients.encode());
+    }
+}
+
+TEST_F(JpegCoefficientsTest, GreyscaleNonInterleavedScan) {
+    // 24x8 greyscale, three blocks of DC 1, -1 and 0, with hand-made tables: DC categories 0-2 coded 00, 01, 10, and
+    // EOB as the only AC symbol, coded 0.
+    std::vector<uint8_t> file = {0xFF, 0xD8, 0xFF, 0xDB, 0x00, 0x43, 0x00};
+    file.insert(file.end(), 64, 0x01);
+    const std::vector<uint8_t> rest = {
+        0xFF, 0xC0, 0x00, 0x0B, 0x08, 0x00, 0x08, 0x00, 0x18, 0x01, 0x01, 0x11, 0x00,
+        0xFF, 0xC4, 0x00, 0x16, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x01, 0x02,
+        0xFF, 0xC4, 0x00, 0x14, 0x10, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00,
+        0xFF, 0xDA, 0x00, 0x08, 0x01, 0x01, 0x00, 0x00, 0x3F, 0x00,
+        0x69, 0x37,                                                             // -0110 10010 0110, padded with ones
+        0xFF, 0xD9
+    };
+    file.insert(file.end(), rest.begin(), rest.end());
+
+    File::JpegCoefficients coefficients(file.data(), file.size());
+    ASSERT_EQ(1u, coefficients.components().size());
+    const File::JpegCoefficients::Component& grey = coefficients.components()[0];
+    EXPECT_EQ(1, grey.block(0, 0)[0]);
+    EXPECT_EQ(-1, grey.block(0, 1)[0]);
+    EXPECT_EQ(0, grey.block(0, 2)[0]);
+    EXPECT_EQ(file, coefficients.encode());
+    int w, h, c;
+    EXPECT_EQ(24u * 8u, decode(file, w, h, c).size());
+
+    const Cipher aes = cipher(Cipher::OperationMode::Identifier::CTR);
+    coefficients.encrypt(aes);
+    const std::vector<uint8_t> encrypted = coefficients.encode();
+    EXPECT_EQ(file.size(), encrypted.size());
+    File::JpegCoefficients received(encrypted.data(), encrypted.size());
+    received.decrypt(aes);
+    EXPECT_EQ(file, received.encode());
+}
+
+TEST_F(JpegCoefficientsTest, FlatImageHasOnlyDcCoefficients) {
+    const std::vector<uint8_t> pixels(32 * 16, 200);
+    std::vector<uint8_t> file;
+    stbi_write_jpg_to_func(append, &file, 32, 16, 1, pixels.data(), 90);
+    File::JpegCoefficients coefficients(file.data(), file.size());
+    const File::JpegCoefficients::Component& grey = coefficients.components()[0];
+    ASSERT_EQ(4u, grey.blocksPerLine);
+    ASSERT_EQ(2u, grey.blocksPerColumn);
+    const int expectedDc = (8 * (200 - 128) + grey.quantization[0] / 2) / grey.quantization[0];
+    for (size_t b = 0; b < 8; b++) {
+        const int16_t* block = grey.block(b / 4, b % 4);
+        EXPECT_NEAR(expectedDc, block[0], 1);
+        EXPECT_EQ(block[0], grey.block(0, 0)[0]);
+        EXPECT_TRUE(std::all_of(block + 1, block + 64, [](int16_t c) { return c == 0; }));
+    }
+}
+
+TEST_F(JpegCoefficientsTest, EncryptionKeepsAJpegAndDecryptsExactly) {
+    for (Cipher::OperationMode::Identifier mode : {Cipher::OperationMode::Identifier::CTR,
+                                                   Cipher::OperationMode::Identifier::CBC}) {
+        for (int quality : {50, 95}) {
+            SCOPED_TRACE(quality);
+            const std::vector<uint8_t> file = jpeg(200, 150, 3, quality);
+            const Cipher aes = cipher(mode);
+            File::JpegCoefficients coefficients(file.data(), file.size());
+            coefficients.encrypt(aes);
+            const std::vector<uint8_t> encrypted = coefficients.encode();
+            EXPECT_NE(file, encrypted);
+            EXPECT_LT(encrypted.size(), file.size() + file.size() / 50) << "Same Huffman symbols, same size";
+            EXPECT_GT(encrypted.size(), file.size() - file.size() / 50);
+
+            int w, h, c;
+            const std::vector<uint8_t> plainPixels = decode(file, w, h, c);
+            const std::vector<uint8_t> cipherPixels = decode(encrypted, w, h, c);
+            ASSERT_EQ(plainPixels.size(), cipherPixels.size()) << "Still decodable";
+            EXPECT_EQ(200, w);
+            double difference = 0;
+            for (size_t i = 0; i < plainPixels.size(); i++) difference += std::abs(plainPixels[i] - cipherPixels[i]);
+            EXPECT_GT(difference / static_cast<double>(plainPixels.size()), 20.0) << "Content is scrambled";
+
+            File::JpegCoefficients received(encrypted.data(), encrypted.size());
+            received.decrypt(aes);
+            EXPECT_EQ(file, received.encode());
+        }
+    }
+}
+
+TEST_F(JpegCoefficientsTest, EcbIsRejected) {
+    const std::vector<uint8_t> file = jpeg(64, 64, 3, 75);
+    File::JpegCoefficients coefficients(file.data(), file.size());
+    EXPECT_THROW(coefficients.encrypt(cipher(Cipher::OperationMode::Identifier::ECB)), std::invalid_argument);
+}
+
+TEST_F(JpegCoefficientsTest, RestartIntervals) {
+    // Two single-block images with the same tables, joined side by side with a restart marker between them: the
+    // predictor reset makes each block's coding identical to its standalone file.
+    const std::vector<uint8_t> left = jpeg(8, 8, 3, 95, 7), right = jpeg(8, 8, 3, 95, 99);
+    auto find = [](const std::vector<uint8_t>& f, uint8_t marker) {
+        for (size_t i = 2; i + 1 < f.size(); i++) if (f[i] == 0xFF && f[i + 1] == marker) return i;
+        return f.size();
+    };
+    const size_t sofLeft = find(left, 0xC0), sosLeft = find(left, 0xDA), sosRight = find(right, 0xDA);
+    ASSERT_LT(sosLeft, left.size());
+    const size_t dataRight = sosRight + 2 + (right[sosRight + 2] << 8 | right[sosRight + 3]);
+
+    std::vector<uint8_t> joined(left.begin(), left.begin() + static_cast<long>(sosLeft));
+    joined[sofLeft + 8] = 16;                                                   // -Width 8 -> 16
+    const uint8_t dri[6] = {0xFF, 0xDD, 0x00, 0x04, 0x00, 0x01};
+    joined.insert(joined.end(), dri, dri + 6);
+    joined.insert(joined.end(), left.begin() + static_cast<long>(sosLeft), left.end() - 2);
+    joined.push_back(0xFF);
+    joined.push_back(0xD0);
+    joined.insert(joined.end(), right.begin() + static_cast<long>(dataRight), right.end());
+
+    File::JpegCoefficients coefficients(joined.data(), joined.size());
+    File::JpegCoefficients a(left.data(), left.size()), b(right.data(), right.size());
+    for (size_t k = 0; k < 3; k++) {
+        const File::JpegCoefficients::Component& component = coefficients.components()[k];
+        EXPECT_TRUE(std::equal(component.block(0, 0), component.block(0, 0) + 64, a.components()[k].block(0, 0)));
+        EXPECT_TRUE(std::equal(component.block(0, 1), component.block(0, 1) + 64, b.components()[k].block(0, 0)));
+    }
+    EXPECT_EQ(joined, coefficients.encode());
+
+    const Cipher aes = cipher(Cipher::OperationMode::Identifier::OFB);
+    coefficients.encrypt(aes);
+    const std::vector<uint8_t> encrypted = coefficients.encode();
+    int w, h, c;
+    EXPECT_EQ(16u * 8u * 3u, decode(encrypted, w, h, c).size());
+    File::JpegCoefficients received(encrypted.data(), encrypted.size());
+    received.decrypt(aes);
+    EXPECT_EQ(joined, received.encode());
+}
+
+TEST_F(JpegCoefficientsTest, RejectsUnsupportedFiles) {
+    const std::vector<uint8_t> garbage = {0xDE, 0xAD, 0xBE, 0xEF, 0x00, 0x11};
+    EXPECT_THROW(File::JpegCoefficients(garbage.data(), garbage.size()), std::invalid_argument);
+    std::vector<uint8_t> progressive = jpeg(16, 16, 3, 75);
+    for (size_t i = 2; i + 1 < progressive.size(); i++) {
+        if (progressive[i] == 0xFF && progressive[i + 1] == 0xC0) { progressive[i + 1] = 0xC2; break; }
+    }
+    EXPECT_THROW(File::JpegCoefficients(progressive.data(), progressive.size()), std::invalid_argument);
+    std::vector<uint8_t> truncated = jpeg(16, 16, 3, 75);
+    truncated.resize(truncated.size() / 2);
+    EXPECT_THROW(File::JpegCoefficients(truncated.data(), truncated.size()), std::invalid_argument);
+
+    const fs::path dir = fs::temp_directory_path() / "ciphfortis_jpeg_coefficients_test";
+    fs::create_directories(dir);
+    const std::vector<uint8_t> file = jpeg(16, 16, 3, 75);
+    File::JpegCoefficients(file.data(), file.size()).save(dir / "ok.jpg");
+    EXPECT_TRUE(File::JpegCoefficients::is_baseline(dir / "ok.jpg"));
+    EXPECT_FALSE(File::JpegCoefficients::is_baseline(dir / "missing.jpg"));
+    fs::remove_all(dir);
+}
@@ -6,6 +6,7 @@
 #include "../../core-crypto/aes/include/operation_modes.h"
 #include "../../testing/include/test-vectors/sp800_38a_modes.hpp"
 #include <cstring>
+#include <vector>
 
 namespace TV = TestVectors::AES;
 namespace SP = TestVectors::AES::SP800_38A;
@@ -16,6 +17,7 @@ void test_ofb_mode(TV::KeySize ks);
 void test_ctr_mode(TV::KeySize ks);
 void test_iv_independence(TV::KeySize ks);
 void test_error_conditions(TV::KeySize ks);
+void test_vectored_modes(TV::KeySize ks);
 
 void test_ecb_mode(TV::KeySize ks) {
     SP::ECB::TestVector example_ecb(ks, TV::Direction::Encrypt);
@@ -188,6 +190,82 @@ void test_error_conditions(TV::KeySize ks) {
         << "CTR should handle zero length";
 }
 
+// Splits 'data' into segments of the given lengths (the last one takes the rest).
+static std::vector<struct iovec> split(uint8_t* data, size_t size, const std::vector<size_t>& lengths) {
+    std::vector<struct iovec> segments;
+    size_t used = 0;
+    for (size_t len : lengths) {
+        segments.push_back({data + used, len});
+        used += len;
+    }
+    segments.push_back({data + used, size - used});
+    return segments;
+}
+
+void test_vectored_modes(TV::KeySize ks) {
+    SP::CBC::TestVector example_cbc(ks, TV::Direction::Encrypt);
+    SP::CTR::TestVector example_ctr(ks, TV::Direction::Encrypt);
+    const KeylenBits_t klb = static_cast<KeylenBits_t>(ks);
+    std::vector<uint8_t> expanded_key(getKeyExpansionLengthBytesfromKeylenBits(klb));
+    KeyExpansionInitWrite(example_cbc.getKey().data(), static_cast<size_t>(ks), expanded_key.data(), false);
+    const uint8_t* key = expanded_key.data();
+    const std::vector<uint8_t> ivBytes = example_cbc.getIV();
+    const std::vector<uint8_t> counterBytes = example_ctr.getCounter();
+    const uint8_t* iv = ivBytes.data();
+    const uint8_t* counter = counterBytes.data();
+
+    const size_t size = 1024 + 64;
+    std::vector<uint8_t> plain(size), expected(size), result(size), restored(size), inplace(size);
+    for (size_t i = 0; i < size; i++) plain[i] = static_cast<uint8_t>(i * 131 + 7);
+
+    // Input and output cut at unrelated places, including empty segments and segments shorter than a block
+    const std::vector<size_t> inCuts = {3, 0, 20, 1, 40, 16, 500, 7};
+    const std::vector<size_t> outCuts = {16, 9, 41, 0, 2, 600};
+    std::vector<uint8_t> in = plain;
+    std::vector<struct iovec> inSegs = split(in.data(), size, inCuts);
+    std::vector<struct iovec> outSegs = split(result.data(), size, outCuts);
+    std::vector<struct iovec> backSegs = split(restored.data(), size, inCuts);
+    std::vector<struct iovec> resultAsInput = split(result.data(), size, outCuts);
+
+    EXPECT_EQ(NoException, encryptECB(plain.data(), size, key, klb, expected.data()));
+    EXPECT_EQ(NoException, encryptECBv(inSegs.data(), inSegs.size(), key, klb, outSegs.data(), outSegs.size()));
+    EXPECT_EQ(expected, result) << "ECBv should match ECB";
+    EXPECT_EQ(NoException, decryptECBv(resultAsInput.data(), resultAsInput.size(), key, klb, backSegs.data(), backSegs.size()));
+    EXPECT_EQ(plain, restored) << "ECBv roundtrip should preserve plaintext";
+
+    EXPECT_EQ(NoException, encryptCBC(plain.data(), size, key, klb, iv, expected.data()));
+    EXPECT_EQ(NoException, encryptCBCv(inSegs.data(), inSegs.size(), key, klb, iv, outSegs.data(), outSegs.size()));
+    EXPECT_EQ(expected, result) << "CBCv should match CBC";
+    EXPECT_EQ(NoException, decryptCBCv(resultAsInput.data(), resultAsInput.size(), key, klb, iv, backSegs.data(), backSegs.size()));
+    EXPECT_EQ(plain, restored) << "CBCv roundtrip should preserve plaintext";
+
+    inplace = expected;                                                         // -In place: same segments both ways
+    std::vector<struct iovec> inplaceSegs = split(inplace.data(), size, inCuts);
+    EXPECT_EQ(NoException, decryptCBCv(inplaceSegs.data(), inplaceSegs.size(), key, klb, iv, inplaceSegs.data(), inplaceSegs.size()));
+    EXPECT_EQ(plain, inplace) << "In-place CBCv decryption should preserve plaintext";
+
+    EXPECT_EQ(NoException, encryptCTR(plain.data(), size, key, klb, counter, expected.data()));
+    EXPECT_EQ(NoException, encryptCTRv(inSegs.data(), inSegs.size(), key, klb, counter, outSegs.data(), outSegs.size()));
+    EXPECT_EQ(expected, result) << "CTRv should match CTR";
+    EXPECT_EQ(NoException, decryptCTRv(resultAsInput.data(), resultAsInput.size(), key, klb, counter, backSegs.data(), backSegs.size()));
+    EXPECT_EQ(plain, restored) << "CTRv roundtrip should preserve plaintext";
+    EXPECT_EQ(in, plain) << "Input segments should be left untouched";
+
+    // Errors
+    struct iovec odd[] = {{in.data(), 17}};
+    struct iovec nullBase[] = {{nullptr, 16}};
+    struct iovec empty[] = {{in.data(), 0}};
+    std::vector<struct iovec> shortOut = split(result.data(), size - 16, {});
+    EXPECT_EQ(NullInput, encryptECBv(nullptr, 1, key, klb, outSegs.data(), outSegs.size()));
+    EXPECT_EQ(NullOutput, encryptECBv(inSegs.data(), inSegs.size(), key, klb, nullptr, 1));
+    EXPECT_EQ(NullInput, encryptCTRv(nullBase, 1, key, klb, counter, outSegs.data(), outSegs.size()));
+    EXPECT_EQ(NullInitialVector, encryptCBCv(inSegs.data(), inSegs.size(), key, klb, nullptr, outSegs.data(), outSegs.size()));
+    EXPECT_EQ(ZeroLength, encryptCBCv(empty, 1, key, klb, iv, outSegs.data(), outSegs.size()));
+    EXPECT_EQ(InvalidInputSize, encryptECBv(odd, 1, key, klb, odd, 1));
+    EXPECT_EQ(InvalidInputSize, encryptCTRv(inSegs.data(), inSegs.size(), key, klb, counter, shortOut.data(), shortOut.size()))
+        << "Input and output totals must agree";
+}
+
 // ── 18 TEST cases (3 key sizes × 6 test functions) ───────────────────────────
 
 TEST(OperationModesTest, ECB_AES128)           { test_ecb_mode(TV::KeySize::AES128); }
@@ -213,3 +291,7 @@ TEST(OperationModesTest, IVIndependence_AES256) { test_iv_independence(TV::KeySi
 TEST(OperationModesTest, ErrorConditions_AES128) { test_error_conditions(TV::KeySize::AES128); }
 TEST(OperationModesTest, ErrorConditions_AES192) { test_error_conditions(TV::KeySize::AES192); }
 TEST(OperationModesTest, ErrorConditions_AES256) { test_error_conditions(TV::KeySize::AES256); }
+
+TEST(OperationModesTest, Vectored_AES128)      { test_vectored_modes(TV::KeySize::AES128); }
+TEST(OperationModesTest, Vectored_AES192)      { test_vectored_modes(TV::KeySize::AES192); }
+TEST(OperationModesTest, Vectored_AES256)      { test_vectored_modes(TV::KeySize::AES256); }
@@ -0,0 +1,207 @@
+// Unit test suite for File::PngWriter and the PNG checksums
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+#include "../../file-handlers/include/png_writer.hpp"
+#include "../../third-party/stb/stb_image.h"
+#include "../include/temp_dir_fixture.hpp"
+
+namespace fs = std::filesystem;
+
+class PngWriterTest : public TempDirFixture {
+protected:
+    fs::path outPath = dir / "out.png";
+
+    static std::vector<uint8_t> noise(size_t size) {
+        std::vector<uint8_t> bytes(size);
+        uint64_t x = 0x9E3779B97F4A7C15ull;
+        for (uint8_t& b : bytes) {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            b = static_cast<uint8_t>(x >> 32);
+        }
+        return bytes;
+    }
+    static std::vector<uint8_t> gradient(int width, int height, int channels) {
+        std::vector<uint8_t> bytes(static_cast<size_t>(width * height * channels));
+        for (int y = 0; y < height; y++)
+            for (int x = 0; x < width * channels; x++)
+                bytes[static_cast<size_t>(y * width * channels + x)] = static_cast<uint8_t>(x / channels + y);
+        return bytes;
+    }
+    // Decodes with stb_image, an independent PNG reader.
+    static std::vector<uint8_t> decode(const fs::path& path, int& width, int& height, int& channels) {
+        uint8_t* pixels = stbi_load(path.string().c_str(), &width, &height, &channels, 0);
+        if (pixels == nullptr) return {};
+        std::vector<uint8_t> bytes(pixels, pixels + width * height * channels);
+        stbi_image_free(pixels);
+        return bytes;
+    }
+};
+
+static uint32_t crc32_bitwise(const uint8_t* data, size_t size) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; i++) {
+        crc ^= data[i];
+        for (int k = 0; k < 8; k++) crc = (crc & 1) ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+    }
+    return ~crc;
+}
+
+TEST(PngChecksumTest, KnownValues) {
+    const char* check = "123456789";
+    EXPECT_EQ(0xCBF43926u, File::crc32(reinterpret_cast<const uint8_t*>(check), 9));
+    const char* wiki = "Wikipedia";
+    EXPECT_EQ(0x11E60398u, File::adler32(reinterpret_cast<const uint8_t*>(wiki), 9));
+    EXPECT_EQ(0u, File::crc32(nullptr, 0));
+    EXPECT_EQ(1u, File::adler32(nullptr, 0));
+}
+
+TEST(PngChecksumTest, MatchesReferenceAndContinues) {
+    std::vector<uint8_t> data(100003);
+    for (size_t i = 0; i < data.size(); i++) data[i] = static_cast<uint8_t>(i * 7 + (i >> 8));
+    for (size_t offset : {size_t(0), size_t(1), size_t(5)}) {
+        for (size_t size : {size_t(7), size_t(8), size_t(63), size_t(100000)}) {
+            EXPECT_EQ(crc32_bitwise(data.data() + offset, size), File::crc32(data.data() + offset, size));
+        }
+    }
+    // Running checksums equal one-shot ones; 0xFF bytes exercise the Adler-32 overflow bound.
+    std::vector<uint8_t> ones(20000, 0xFF);
+    for (const std::vector<uint8_t>* v : {&data, &ones}) {
+        const uint8_t* p = v->data();
+        const size_t split = 12345;
+        EXPECT_EQ(File::crc32(p, v->size()), File::crc32(p + split, v->size() - split, File::crc32(p, split)));
+        EXPECT_EQ(File::adler32(p, v->size()), File::adler32(p + split, v->size() - split, File::adler32(p, split)));
+    }
+}
+
+TEST(PngChecksumTest, AdlerCombine) {
+    std::vector<uint8_t> data(300000);
+    for (size_t i = 0; i < data.size(); i++) data[i] = static_cast<uint8_t>(i * 13 + (i >> 9));
+    for (size_t split : {size_t(0), size_t(1), size_t(65521), size_t(200000), data.size()}) {
+        const uint32_t first = File::adler32(data.data(), split);
+        const uint32_t second = File::adler32(data.data() + split, data.size() - split);
+        EXPECT_EQ(File::adler32(data.data(), data.size()), File::adler32_combine(first, second, data.size() - split));
+    }
+}
+
+TEST_F(PngWriterTest, StoredRoundTrip) {
+    for (int channels = 1; channels <= 4; channels++) {
+        SCOPED_TRACE(channels);
+        const int width = 301, height = 257;                                    // -Stored blocks split rows
+        const std::vector<uint8_t> pixels = noise(static_cast<size_t>(width * height * channels));
+        File::PngWriter::Options options;
+        options.compression = File::PngCompression::Stored;
+        File::PngWriter::write(outPath, pixels.data(), width, height, channels, options);
+
+        int w, h, c;
+        EXPECT_EQ(pixels, decode(outPath, w, h, c));
+        EXPECT_EQ(width, w);
+        EXPECT_EQ(height, h);
+        EXPECT_EQ(channels, c);
+        const size_t raw = pixels.size() + static_cast<size_t>(height);
+        EXPECT_LT(fs::file_size(outPath), raw + raw / 1000 + 128) << "Stored overhead is a few bytes per 64 KiB";
+    }
+}
+
+TEST_F(PngWriterTest, AutoStoresCiphertextAndDeflatesImages) {
+    const std::vector<uint8_t> random = noise(200 * 100 * 3);
+    const std::vector<uint8_t> smooth = gradient(200, 100, 3);
+    EXPECT_EQ(File::PngCompression::Stored, File::PngWriter::choose(random.data(), random.size()));
+    EXPECT_EQ(File::PngCompression::Deflate, File::PngWriter::choose(smooth.data(), smooth.size()));
+    EXPECT_EQ(File::PngCompression::Deflate, File::PngWriter::choose(random.data(), 100)) << "Too small to judge";
+
+    File::PngWriter::write(outPath, smooth.data(), 200, 100, 3);
+    int w, h, c;
+    EXPECT_EQ(smooth, decode(outPath, w, h, c));
+    EXPECT_LT(fs::file_size(outPath), smooth.size() / 4) << "Image data is compressed";
+
+    File::PngWriter::write(outPath, random.data(), 200, 100, 3);
+    EXPECT_EQ(random, decode(outPath, w, h, c));
+}
+
+TEST_F(PngWriterTest, ParallelDeflateRoundTrip) {
+    for (int channels = 1; channels <= 4; channels++) {
+        SCOPED_TRACE(channels);
+        const int width = 1021, height = 700;                                   // -Several 1 MiB bands
+        std::vector<uint8_t> pixels = gradient(width, height, channels);
+        const std::vector<uint8_t> random = noise(pixels.size() / 8);
+        std::copy(random.begin(), random.end(), pixels.begin() + static_cast<long>(pixels.size() / 2));
+        File::PngWriter::Options options;
+        options.compression = File::PngCompression::Deflate;
+        options.parallelThreshold = 0;
+        for (size_t threads : {size_t(0), size_t(1), size_t(3)}) {
+            SCOPED_TRACE(threads);
+            options.threads = threads;
+            File::PngWriter::write(outPath, pixels.data(), width, height, channels, options);
+            int w, h, c;
+            EXPECT_EQ(pixels, decode(outPath, w, h, c));
+            EXPECT_EQ(width, w);
+            EXPECT_EQ(channels, c);
+            EXPECT_LT(fs::file_size(outPath), pixels.size() / 4) << "Filtered and compressed";
+        }
+    }
+    // One row per band, rows wider than a band, and a single pixel.
+    File::PngWriter::Options options;
+    options.compression = File::PngCompression::Deflate;
+    options.parallelThreshold = 0;
+    const std::vector<uint8_t> wide = noise(400000 * 3 * 3);
+    File::PngWriter::write(outPath, wide.data(), 400000, 3, 3, options);
+    int w, h, c;
+    EXPECT_EQ(wide, decode(outPath, w, h, c));
+    const uint8_t pixel[1] = {42};
+    File::PngWriter::write(outPath, pixel, 1, 1, 1, options);
+    EXPECT_EQ(std::vector<uint8_t>(1, 42), decode(outPath, w, h, c));
+}
+
+TEST_F(PngWriterTest, StreamWriterTakesRowsInBatches) {
+    const int width = 777, height = 613, channels = 3;                          // -Several deflate groups
+    const std::vector<uint8_t> pixels = gradient(width, height, channels);
+    const size_t rowBytes = static_cast<size_t>(width * channels);
+    for (File::PngCompression compression : {File::PngCompression::Deflate, File::PngCompression::Stored}) {
+        File::PngStreamWriter writer(outPath, width, height, channels, compression);
+        size_t row = 0;
+        for (size_t batch = 1; row < static_cast<size_t>(height); batch = batch * 2 + 1) {
+            const size_t count = std::min(batch, static_cast<size_t>(height) - row);
+            writer.write_rows(pixels.data() + row * rowBytes, count);
+            row += count;
+        }
+        EXPECT_EQ(static_cast<size_t>(height), writer.rows_written());
+        writer.finish();
+        int w, h, c;
+        EXPECT_EQ(pixels, decode(outPath, w, h, c));
+        EXPECT_EQ(height, h);
+    }
+    const size_t raw = pixels.size() + static_cast<size_t>(height);
+    EXPECT_LT(fs::file_size(outPath), raw + raw / 1000 + 128) << "Stored";
+
+    // Auto looks at the first rows: ciphertext is stored.
+    const std::vector<uint8_t> random = noise(pixels.size());
+    File::PngStreamWriter writer(outPath, width, height, channels);
+    writer.write_rows(random.data(), static_cast<size_t>(height));
+    writer.finish();
+    int w, h, c;
+    EXPECT_EQ(random, decode(outPath, w, h, c));
+    EXPECT_GT(fs::file_size(outPath), random.size());
+}
+
+TEST_F(PngWriterTest, StreamWriterChecksRowCount) {
+    const std::vector<uint8_t> pixels(4 * 4 * 3);
+    File::PngStreamWriter writer(outPath, 4, 4, 3);
+    writer.write_rows(pixels.data(), 3);
+    EXPECT_THROW(writer.write_rows(pixels.data(), 2), std::invalid_argument);
+    EXPECT_THROW(writer.finish(), std::logic_error);
+    writer.write_rows(pixels.data(), 1);
+    writer.finish();
+    EXPECT_THROW(writer.write_rows(pixels.data(), 1), std::logic_error);
+    EXPECT_THROW(File::PngStreamWriter(outPath, 4, 0, 3), std::invalid_argument);
+}
+
+TEST_F(PngWriterTest, InvalidArguments) {
+    const std::vector<uint8_t> pixels(64);
+    EXPECT_THROW(File::PngWriter::write(outPath, pixels.data(), 0, 4, 3), std::invalid_argument);
+    EXPECT_THROW(File::PngWriter::write(outPath, pixels.data(), 4, 4, 5), std::invalid_argument);
+    EXPECT_THROW(File::PngWriter::write(outPath, nullptr, 4, 4, 3), std::invalid_argument);
+    EXPECT_THROW(File::PngWriter::write(dir / "missing" / "out.png", pixels.data(), 4, 4, 3), std::runtime_error);
+}
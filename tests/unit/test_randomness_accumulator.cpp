@@ -0,0 +1,54 @@
+// Unit test suite for RandomnessAccumulator: streamed and merged moments equal a single sweep
+#include <gtest/gtest.h>
+#include "../../analysis/include/randomness_accumulator.hpp"
+#include "../../analysis/include/byte_moments.hpp"
+#include "../../analysis/include/data_randomness.hpp"
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+TEST(RandomnessAccumulatorTest, ChunkedStreamMatchesWholeBuffer) {
+    std::mt19937 rng(17);
+    std::vector<uint8_t> data(300000);
+    for (size_t i = 0; i < data.size(); i++) data[i] = static_cast<uint8_t>(rng() % 150 + (i % 100));
+    const std::vector<size_t> lags = {1, 0, 3, 1000};
+    const ByteMoments whole = ByteMoments::measure(data.data(), data.size(), lags);
+
+    RandomnessAccumulator streamed(lags);                                       // -Chunks shorter and longer than the lags
+    for (size_t offset = 0; offset < data.size();) {
+        const size_t size = std::min<size_t>(rng() % 3000, data.size() - offset);
+        streamed.update(data.data() + offset, size);
+        offset += size;
+    }
+    ByteMoments m = streamed.finalize();
+    EXPECT_EQ(whole.count, m.count);
+    EXPECT_EQ(0, std::memcmp(whole.histogram, m.histogram, sizeof(whole.histogram)));
+    EXPECT_EQ(whole.lagProducts, m.lagProducts);
+
+    // Pieces accumulated separately, as threads would, then merged in stream order
+    std::vector<RandomnessAccumulator> pieces(5, RandomnessAccumulator(lags));
+    const size_t cuts[6] = {0, 2, 700, 1500, 150000, data.size()};
+    for (size_t p = 0; p < 5; p++) pieces[p].update(data.data() + cuts[p], cuts[p + 1] - cuts[p]);
+    RandomnessAccumulator merged(lags);
+    for (const RandomnessAccumulator& piece : pieces) merged.merge(piece);
+    m = merged.finalize();
+    EXPECT_EQ(0, std::memcmp(whole.histogram, m.histogram, sizeof(whole.histogram)));
+    EXPECT_EQ(whole.lagProducts, m.lagProducts);
+
+    std::vector<std::byte> bytes(reinterpret_cast<const std::byte*>(data.data()),
+                                 reinterpret_cast<const std::byte*>(data.data()) + data.size());
+    const DataRandomness fromVector(bytes), fromStream(m);
+    EXPECT_EQ(fromVector.getEntropy(), fromStream.getEntropy());
+    EXPECT_EQ(fromVector.getChiSquare(), fromStream.getChiSquare());
+    EXPECT_EQ(fromVector.getCorrelationAdjacentByte(), fromStream.getCorrelationAdjacentByte());
+
+    RandomnessAccumulator shortStream(lags);                                    // -Shorter than the longest lag
+    shortStream.update(data.data(), 10);
+    shortStream.update(data.data() + 10, 7);
+    EXPECT_EQ(ByteMoments::measure(data.data(), 17, lags).lagProducts, shortStream.finalize().lagProducts);
+
+    EXPECT_THROW(RandomnessAccumulator(lags).finalize(), std::logic_error);
+    EXPECT_THROW(merged.merge(RandomnessAccumulator({1})), std::invalid_argument);
+    EXPECT_THROW(DataRandomness(ByteMoments::measure(data.data(), data.size(), {2})), std::invalid_argument);
+}
@@ -0,0 +1,109 @@
+// Unit test suite for File::RandomnessSampler: sampled estimates, their intervals, and escalation to a full scan
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <random>
+#include "../../file-handlers/include/randomness_sampler.hpp"
+#include "../../analysis/include/data_randomness.hpp"
+#include "../include/temp_dir_fixture.hpp"
+
+namespace fs = std::filesystem;
+
+class RandomnessSamplerTest : public TempDirFixture {
+protected:
+    fs::path randomPath = dir / "random.bin";
+    fs::path structuredPath = dir / "structured.bin";
+
+    static std::vector<uint8_t> randomBytes(size_t size, uint32_t seed) {
+        std::mt19937 rng(seed);
+        std::vector<uint8_t> bytes(size);
+        for (uint8_t& b : bytes) b = static_cast<uint8_t>(rng() >> 24);
+        return bytes;
+    }
+};
+
+TEST_F(RandomnessSamplerTest, RandomFilePassesOnSample) {
+    writeFile(randomPath, randomBytes(16 * 1024 * 1024 + 100, 29));             // -Partial last block
+    File::RandomnessSampler::Config config;
+    config.seed = 5;
+    const File::RandomnessSampler sampler(config);
+    const File::RandomnessSampler::Report sample = sampler.analyze(randomPath);
+    const File::RandomnessSampler::Report exact = sampler.scan(randomPath);
+
+    EXPECT_FALSE(sample.fullScan);
+    EXPECT_TRUE(sample.passed);
+    EXPECT_EQ(16u * 1024 * 1024 + 100, sample.fileBytes);
+    EXPECT_LE(sample.bytesRead, config.blocks * config.blockBytes) << "Cost set by the sample, not the file";
+    EXPECT_GT(sample.bytesRead, (config.blocks - 1) * config.blockBytes);
+
+    EXPECT_TRUE(exact.fullScan);
+    EXPECT_EQ(exact.fileBytes, exact.bytesRead);
+    for (const auto& pair : {std::make_pair(sample.entropy, exact.entropy),
+                             std::make_pair(sample.chiSquare, exact.chiSquare),
+                             std::make_pair(sample.correlation, exact.correlation)}) {
+        EXPECT_LT(pair.first.low, pair.first.value);
+        EXPECT_GT(pair.first.high, pair.first.value);
+        EXPECT_EQ(pair.second.low, pair.second.value) << "Exact values have zero-width intervals";
+    }
+    EXPECT_LE(sample.entropy.low, exact.entropy.value) << "Plug-in entropy of a sample is biased low";
+    EXPECT_GE(sample.correlation.high, exact.correlation.value);
+    EXPECT_LE(sample.correlation.low, exact.correlation.value);
+
+    const File::RandomnessSampler::Report again = sampler.analyze(randomPath);
+    EXPECT_EQ(sample.entropy.value, again.entropy.value) << "Same seed, same blocks";
+}
+
+TEST_F(RandomnessSamplerTest, RandomFilesRarelyEscalate) {
+    writeFile(randomPath, randomBytes(4 * 1024 * 1024, 41));
+    File::RandomnessSampler::Config config;
+    config.escalate = false;
+    size_t passed = 0;
+    for (uint64_t seed = 1; seed <= 100; seed++) {
+        config.seed = seed;
+        const File::RandomnessSampler::Report sample = File::RandomnessSampler(config).analyze(randomPath);
+        ASSERT_FALSE(sample.fullScan);
+        if (sample.passed) passed++;
+    }
+    EXPECT_GE(passed, 95u) << "Random data should almost never pay for a full scan";
+}
+
+TEST_F(RandomnessSamplerTest, FailingSampleEscalatesToFullScan) {
+    std::vector<uint8_t> bytes = randomBytes(8 * 1024 * 1024, 31);
+    for (size_t i = 0; i < bytes.size(); i += 2) bytes[i] = static_cast<uint8_t>(i % 7);  // -Half the bytes take 7 values
+    writeFile(structuredPath, bytes);
+
+    File::RandomnessSampler::Config config;
+    config.seed = 7;
+    config.escalate = false;
+    const File::RandomnessSampler::Report sample = File::RandomnessSampler(config).analyze(structuredPath);
+    EXPECT_FALSE(sample.fullScan);
+    EXPECT_FALSE(sample.passed);
+
+    config.escalate = true;
+    const File::RandomnessSampler::Report escalated = File::RandomnessSampler(config).analyze(structuredPath);
+    EXPECT_TRUE(escalated.fullScan);
+    EXPECT_FALSE(escalated.passed);
+    EXPECT_EQ(bytes.size() + sample.bytesRead, escalated.bytesRead) << "Sample, then the whole file";
+
+    const DataRandomness reference(std::vector<std::byte>(reinterpret_cast<const std::byte*>(bytes.data()),
+                                                          reinterpret_cast<const std::byte*>(bytes.data()) + bytes.size()));
+    EXPECT_EQ(reference.getEntropy(), escalated.entropy.value);
+    EXPECT_EQ(reference.getChiSquare(), escalated.chiSquare.value);
+    EXPECT_EQ(reference.getCorrelationAdjacentByte(), escalated.correlation.value);
+}
+
+TEST_F(RandomnessSamplerTest, SmallFilesAndErrors) {
+    writeFile(randomPath, randomBytes(100000, 37));                             // -Fewer than twice the sampled blocks
+    const File::RandomnessSampler::Report small = File::RandomnessSampler().analyze(randomPath);
+    EXPECT_TRUE(small.fullScan);
+    EXPECT_EQ(100000u, small.bytesRead);
+
+    writeFile(structuredPath, {});
+    EXPECT_THROW(File::RandomnessSampler().analyze(structuredPath), std::invalid_argument);
+    EXPECT_THROW(File::RandomnessSampler().analyze(dir / "missing.bin"), std::runtime_error);
+    File::RandomnessSampler::Config config;
+    config.blocks = 1;
+    EXPECT_THROW(File::RandomnessSampler{config}, std::invalid_argument);
+    config.blocks = 8;
+    config.blockBytes = 0;
+    EXPECT_THROW(File::RandomnessSampler{config}, std::invalid_argument);
+}
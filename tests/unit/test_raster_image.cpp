@@ -1,9 +1,18 @@
-// Unit test suite for RasterImage contracts, exercised via File::PNG and File::JPEG
+// Unit test suite for RasterImage contracts, exercised via File::PNG, File::JPEG and File::Bitmap
 #include <gtest/gtest.h>
 #include "../../file-handlers/include/png_image.hpp"
 #include "../../file-handlers/include/jpeg_image.hpp"
+#include "../../file-handlers/include/bitmap.hpp"
+#include "../../file-handlers/include/tile_grid.hpp"
+#include "../../analysis/include/data_randomness.hpp"
+#include "../../analysis/include/image_correlation.hpp"
+#include "../../core-crypto/include/cipher.hpp"
 #include "../include/raster_image_fixture.hpp"
 #include "../../core-crypto/include/encryptor.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
 #include <filesystem>
 
 namespace fs = std::filesystem;
@@ -74,7 +83,7 @@ TEST_F(RasterImageFixture, SaveOperations) {
     {
         File::PNG png(validPngPath);
         png.load();
-        std::vector<uint8_t> original = png.get_data();
+        std::vector<uint8_t> original = png.get_data().to_vector();
 
         XorEncryptor xor_enc;
         png.apply_encryption(xor_enc);
@@ -163,7 +172,7 @@ TEST_F(RasterImageFixture, JpegLossyRoundTrip) {
         File::JPEG jpeg(workPath);
         jpeg.load();
         jpeg.apply_encryption(xor_enc);
-        std::vector<uint8_t> encrypted = jpeg.get_data();
+        std::vector<uint8_t> encrypted = jpeg.get_data().to_vector();
 
         jpeg.save();
 
@@ -182,7 +191,7 @@ TEST_F(RasterImageFixture, JpegLossyRoundTrip) {
 
         File::JPEG jpeg(workPath);
         jpeg.load();
-        std::vector<uint8_t> original = jpeg.get_data();
+        std::vector<uint8_t> original = jpeg.get_data().to_vector();
 
         jpeg.apply_encryption(xor_enc);
         jpeg.save();
@@ -196,3 +205,247 @@ TEST_F(RasterImageFixture, JpegLossyRoundTrip) {
         fs::remove(workPath);
     }
 }
+
+TEST_F(RasterImageFixture, NativeBmpPath) {
+    const fs::path bmpPath     = testDataDir / "native_7x16.bmp";                // -21-byte rows, padded to 24
+    const fs::path nativePath  = testDataDir / "native_encrypted.bmp";
+    const fs::path stbPath     = testDataDir / "stb_encrypted.bmp";
+    const fs::path restoredPath = testDataDir / "native_restored.bmp";
+    createValidBmp(bmpPath, 7, 16);
+    CipherFortis::Cipher cipher(CipherFortis::Key::LengthBits::_128, CipherFortis::Cipher::OperationMode::Identifier::CBC);
+
+    File::Bitmap::PixelLayout layout;
+    ASSERT_TRUE(File::Bitmap::native_layout(bmpPath, layout));
+    EXPECT_EQ(7u, layout.width);
+    EXPECT_EQ(16u, layout.height);
+    EXPECT_EQ(3u, layout.bytesPerPixel);
+    EXPECT_EQ(24u, layout.stride);
+    EXPECT_FALSE(File::Bitmap::native_layout(validPngPath, layout));
+    EXPECT_FALSE(File::Bitmap::native_layout(nonexistentPath, layout));
+
+    File::Bitmap original(bmpPath);
+    original.encrypt_native_to(cipher, nativePath);
+
+    File::Bitmap stb(bmpPath);                                                  // -Decode, encrypt, re-encode
+    stb.load();
+    stb.apply_encryption(cipher);
+    stb.save(stbPath);
+
+    File::Bitmap nativeImage(nativePath), stbImage(stbPath);
+    nativeImage.load();
+    stbImage.load();
+    EXPECT_EQ(stbImage.get_data(), nativeImage.get_data()) << "Both paths encrypt the same pixel stream";
+
+    File::FileBase rawOriginal(bmpPath), rawNative(nativePath);
+    rawOriginal.load();
+    rawNative.load();
+    ASSERT_EQ(rawOriginal.get_size(), rawNative.get_size());
+    EXPECT_TRUE(std::equal(rawOriginal.get_bytes(), rawOriginal.get_bytes() + layout.offset, rawNative.get_bytes()))
+        << "Header copied verbatim";
+
+    File::Bitmap(nativePath).decrypt_native_to(cipher, restoredPath);
+    File::FileBase restored(restoredPath);
+    restored.load();
+    EXPECT_EQ(rawOriginal.get_data(), restored.get_data()) << "Native round trip restores the file byte for byte";
+
+    File::Bitmap(stbPath).decrypt_native_to(cipher, stbPath);                  // -In place, across paths
+    File::Bitmap crossImage(stbPath);
+    crossImage.load();
+    File::Bitmap originalImage(bmpPath);
+    originalImage.load();
+    EXPECT_EQ(originalImage.get_data(), crossImage.get_data());
+
+    EXPECT_THROW(File::Bitmap(validPngPath).encrypt_native_to(cipher, nativePath), std::invalid_argument);
+}
+
+TEST(TileGridTest, Layout) {
+    File::TileGrid grid(100, 70, 3, 32, 32);                                    // -Remainders go to the last column/row
+    EXPECT_EQ(3u, grid.columns());
+    EXPECT_EQ(2u, grid.rows());
+    EXPECT_EQ(6u, grid.count());
+    File::TileGrid::Rect last = grid.tile(5);
+    EXPECT_EQ(64u, last.x);
+    EXPECT_EQ(32u, last.y);
+    EXPECT_EQ(36u, last.width);
+    EXPECT_EQ(38u, last.height);
+    EXPECT_EQ(36u * 38u * 3u, grid.tile_bytes(5));
+    EXPECT_THROW(grid.tile(6), std::out_of_range);
+
+    size_t area = 0;
+    for (size_t i = 0; i < grid.count(); i++) area += grid.tile(i).width * grid.tile(i).height;
+    EXPECT_EQ(100u * 70u, area);
+
+    EXPECT_EQ((std::vector<size_t>{0}), grid.intersecting({0, 0, 32, 32}));
+    EXPECT_EQ((std::vector<size_t>{1, 2, 4, 5}), grid.intersecting({40, 20, 30, 20}));
+    EXPECT_EQ((std::vector<size_t>{5}), grid.intersecting({99, 69, 50, 50}));
+    EXPECT_TRUE(grid.intersecting({100, 0, 1, 1}).empty());
+
+    File::TileGrid single(10, 10, 1, 64, 64);
+    EXPECT_EQ(1u, single.count());
+    EXPECT_EQ(10u, single.tile(0).width);
+
+    std::vector<uint8_t> pixels(100 * 70 * 3), copy(pixels.size()), tile;
+    for (size_t i = 0; i < pixels.size(); i++) pixels[i] = static_cast<uint8_t>(i * 7);
+    for (size_t i = 0; i < grid.count(); i++) {
+        tile.resize(grid.tile_bytes(i));
+        grid.gather(i, pixels.data(), tile.data());
+        grid.scatter(i, tile.data(), copy.data());
+    }
+    EXPECT_EQ(pixels, copy);
+
+    size_t w = 0, h = 0;
+    EXPECT_EQ("32x32", grid.to_string());
+    EXPECT_TRUE(File::TileGrid::parse("256x128", w, h));
+    EXPECT_EQ(256u, w);
+    EXPECT_EQ(128u, h);
+    EXPECT_FALSE(File::TileGrid::parse("256", w, h));
+    EXPECT_FALSE(File::TileGrid::parse("0x16", w, h));
+    EXPECT_FALSE(File::TileGrid::parse("16x-4", w, h));
+    EXPECT_THROW(File::TileGrid(0, 10, 3, 8, 8), std::invalid_argument);
+}
+
+TEST_F(RasterImageFixture, TiledEncryptionAndRegions) {
+    using Mode = CipherFortis::Cipher::OperationMode::Identifier;
+    for (Mode mode : {Mode::CBC, Mode::OFB, Mode::CTR}) {
+        CipherFortis::Cipher cipher(CipherFortis::Key::LengthBits::_128, mode);
+        File::PNG original(largePngPath);                                       // -100x100 RGB
+        original.load();
+        File::PNG image(largePngPath);
+        image.load();
+
+        image.apply_tiled_encryption(cipher, 32, 32);
+        EXPECT_NE(original.get_data(), image.get_data());
+
+        // Each region matches the plaintext, whichever tiles it spans
+        const std::vector<std::array<size_t, 4>> regions = {
+            {0, 0, 100, 100}, {0, 0, 1, 1}, {31, 31, 2, 2}, {40, 10, 50, 80}, {99, 99, 1, 1}};
+        for (const auto& r : regions) {
+            std::vector<uint8_t> pixels = image.decrypt_region(cipher, 32, 32, r[0], r[1], r[2], r[3]);
+            ASSERT_EQ(r[2] * r[3] * 3, pixels.size());
+            bool same = true;
+            for (size_t y = 0; y < r[3]; y++) {
+                same = same && std::equal(pixels.begin() + y * r[2] * 3, pixels.begin() + (y + 1) * r[2] * 3,
+                                          original.get_bytes() + ((r[1] + y) * 100 + r[0]) * 3);
+            }
+            EXPECT_TRUE(same) << "Region " << r[0] << "," << r[1] << "," << r[2] << "," << r[3];
+        }
+
+        // Tiles are independent: each one is its own message, started from its own chaining value
+        File::TileGrid grid(100, 100, 3, 32, 32);
+        for (size_t i : {size_t(0), size_t(4), size_t(8)}) {
+            std::vector<uint8_t> plain(grid.tile_bytes(i)), expected(plain.size()), actual(plain.size());
+            uint8_t chainingBlock[CipherFortis::Cipher::CHAINING_BLOCK_SIZE];
+            grid.gather(i, original.get_bytes(), plain.data());
+            grid.gather(i, image.get_bytes(), actual.data());
+            cipher.tileChainingBlock(i, chainingBlock);
+            cipher.encryptFrom(plain.data(), plain.size(), expected.data(), chainingBlock);
+            EXPECT_EQ(expected, actual) << "Tile " << i;
+        }
+        File::PNG copy(largePngPath);
+        copy.load();
+        copy.apply_tiled_encryption(cipher, 32, 32);
+        EXPECT_EQ(image.get_data(), copy.get_data()) << "Tile chaining values are deterministic";
+
+        image.apply_tiled_decryption(cipher, 32, 32);
+        EXPECT_EQ(original.get_data(), image.get_data());
+
+        EXPECT_THROW(image.decrypt_region(cipher, 32, 32, 90, 90, 20, 5), std::out_of_range);
+        EXPECT_THROW(image.apply_tiled_encryption(cipher, 2, 2), std::invalid_argument);
+
+        // 32x33 tiles: the last column is 36x33 RGB pixels, 3564 bytes; nothing may be encrypted before that is found
+        EXPECT_THROW(image.apply_tiled_encryption(cipher, 32, 33), std::invalid_argument);
+        EXPECT_EQ(original.get_data(), image.get_data());
+        EXPECT_THROW(image.decrypt_region(cipher, 32, 33, 0, 0, 1, 1), std::invalid_argument);
+    }
+
+    // Tiles do not share keystream: CTR tiles start 2^32 blocks apart
+    CipherFortis::Cipher cipher(CipherFortis::Key::LengthBits::_128, Mode::CTR);
+    uint8_t first[16], second[16], expected[16];
+    cipher.tileChainingBlock(0, first);
+    cipher.tileChainingBlock(1, second);
+    std::memcpy(expected, first, 16);
+    CipherFortis::Cipher::advanceCounter(expected, uint64_t(1) << 32);
+    EXPECT_EQ(0, std::memcmp(expected, second, 16));
+    File::PNG unloaded(largePngPath);
+    EXPECT_THROW(unloaded.apply_tiled_encryption(cipher, 32, 32), std::logic_error);
+}
+
+TEST_F(RasterImageFixture, SelectiveEncryption) {
+    using Mode = CipherFortis::Cipher::OperationMode::Identifier;
+    CipherFortis::Cipher cipher(CipherFortis::Key::LengthBits::_128, Mode::CTR);
+    File::PNG original(largePngPath);                                           // -100x100 RGB, blue constant 128
+    original.load();
+    const size_t pixels = 100 * 100;
+    auto bytes_of = [](const File::PNG& image) {
+        return std::vector<std::byte>(reinterpret_cast<const std::byte*>(image.get_bytes()),
+                                      reinterpret_cast<const std::byte*>(image.get_bytes()) + image.get_size());
+    };
+
+    // Blue channel only: the same bytes a full keystream (one AES-CTR message over the selected bytes) gives
+    File::PNG blue(largePngPath);
+    blue.load();
+    blue.apply_selective_encryption(cipher, {0x4, 8});
+    std::vector<uint8_t> zeros(pixels), keystream(pixels);
+    cipher.encrypt(zeros.data(), zeros.size(), keystream.data());
+    bool matches = true;
+    for (size_t i = 0; i < pixels; i++) {
+        matches = matches && blue.get_bytes()[i * 3 + 2] == (original.get_bytes()[i * 3 + 2] ^ keystream[i]);
+        matches = matches && blue.get_bytes()[i * 3] == original.get_bytes()[i * 3];
+        matches = matches && blue.get_bytes()[i * 3 + 1] == original.get_bytes()[i * 3 + 1];
+    }
+    EXPECT_TRUE(matches) << "Only the blue bytes change, by a contiguous keystream spanning both 8192-pixel chunks";
+
+    // Per-channel effect, measured on the interleaved buffer
+    const std::vector<std::byte> before = bytes_of(original), after = bytes_of(blue);
+    EXPECT_DOUBLE_EQ(0.0, DataRandomness::calculateDataRandomnessSubArray(before, 2, 3).getEntropy());
+    EXPECT_GT(DataRandomness::calculateDataRandomnessSubArray(after, 2, 3).getEntropy(), 7.9);
+    EXPECT_DOUBLE_EQ(DataRandomness::calculateDataRandomnessSubArray(before, 0, 3).getEntropy(),
+                     DataRandomness::calculateDataRandomnessSubArray(after, 0, 3).getEntropy());
+
+    blue.apply_selective_decryption(cipher, {0x4, 8});
+    EXPECT_EQ(original.get_data(), blue.get_data());
+
+    // Top two bit planes of every channel: the low six bits stay in clear
+    for (Mode mode : {Mode::CBC, Mode::OFB, Mode::CTR}) {
+        CipherFortis::Cipher modeCipher(CipherFortis::Key::LengthBits::_128, mode);
+        File::PNG planes(largePngPath);
+        planes.load();
+        planes.apply_selective_encryption(modeCipher, {0xFF, 2});
+        bool lowKept = true;
+        for (size_t i = 0; i < planes.get_size(); i++)
+            lowKept = lowKept && (planes.get_bytes()[i] & 0x3F) == (original.get_bytes()[i] & 0x3F);
+        EXPECT_TRUE(lowKept);
+        const double blueEntropy = DataRandomness::calculateDataRandomnessSubArray(bytes_of(planes), 2, 3).getEntropy();
+        EXPECT_GT(blueEntropy, 1.95) << "Four equally likely values";
+        EXPECT_LE(blueEntropy, 2.0 + 1e-9);
+        planes.apply_selective_decryption(modeCipher, {0xFF, 2});
+        EXPECT_EQ(original.get_data(), planes.get_data());
+    }
+
+    CipherFortis::Cipher ecb(CipherFortis::Key::LengthBits::_128, Mode::ECB);
+    EXPECT_THROW(blue.apply_selective_encryption(ecb, {0x1, 8}), std::invalid_argument);
+    EXPECT_THROW(blue.apply_selective_encryption(cipher, {0x8, 8}), std::invalid_argument)
+        << "RGB has no fourth channel";
+    EXPECT_THROW(blue.apply_selective_encryption(cipher, {0x1, 9}), std::invalid_argument);
+}
+
+TEST_F(RasterImageFixture, NeighbourCorrelation) {
+    using Direction = ImageCorrelation::Direction;
+    File::PNG image(largePngPath);                                              // -Pixel (x, y) = (x*25, y*25, 128)
+    image.load();
+    const ImageCorrelation plain = image.calculate_correlation();
+    ASSERT_EQ(3u, plain.channels());
+    EXPECT_DOUBLE_EQ(1.0, plain.correlation(0, Direction::Vertical)) << "Red only changes along x";
+    EXPECT_DOUBLE_EQ(1.0, plain.correlation(1, Direction::Horizontal)) << "Green only changes along y";
+    EXPECT_TRUE(std::isnan(plain.correlation(2, Direction::Diagonal))) << "Blue is constant";
+
+    CipherFortis::Cipher cipher(CipherFortis::Key::LengthBits::_128, CipherFortis::Cipher::OperationMode::Identifier::CTR);
+    image.apply_encryption(cipher);
+    const ImageCorrelation encrypted = image.calculate_correlation();
+    for (size_t c = 0; c < 3; c++)
+        for (Direction d : {Direction::Horizontal, Direction::Vertical, Direction::Diagonal})
+            EXPECT_LT(std::fabs(encrypted.correlation(c, d)), 0.1) << "Channel " << c;
+
+    File::PNG unloaded(largePngPath);
+    EXPECT_THROW(unloaded.calculate_correlation(), std::logic_error);
+}
@@ -0,0 +1,127 @@
+// Unit test suite for SP800_22: NIST SP 800-22 statistical tests
+#include <gtest/gtest.h>
+#include "../../analysis/include/sp800_22.hpp"
+#include <cmath>
+#include <random>
+#include <vector>
+
+// Bit i of the buffer, most significant bit first, as SP800_22 reads it
+static int bit_at(const std::vector<uint8_t>& data, size_t i) { return data[i / 8] >> (7 - i % 8) & 1; }
+
+TEST(SP800_22Test, LongestRunKnownAnswer) {
+    // Example of SP 800-22 rev. 1a, section 2.4.8: n = 128, nu = (4, 9, 3, 0), chi^2 = 4.882605, P-value = 0.180598
+    const std::vector<uint8_t> e = {0xCC, 0x15, 0x6C, 0x4C, 0xE0, 0x02, 0x4D, 0x51,
+                                    0x13, 0xD6, 0x80, 0xD7, 0xCC, 0xE6, 0xD8, 0xB2};
+    SP800_22::Config config;
+    config.serialBits = 4;
+    config.approximateEntropyBits = 2;
+    const SP800_22::Results r = SP800_22::run(e.data(), e.size(), config);
+    EXPECT_EQ(4u, r.serialBits);
+    EXPECT_EQ(1u, r.approximateEntropyBits) << "m < log2(128) - 5";
+    EXPECT_NEAR(4.882605, r.longestRun.statistic, 1e-6);
+    EXPECT_NEAR(0.180598, r.longestRun.pValue, 1e-6);
+
+    EXPECT_NEAR(std::exp(-2.5), SP800_22::igamc(1.0, 2.5), 1e-14);             // -Closed forms of Q(a, x)
+    EXPECT_NEAR(std::erfc(std::sqrt(0.7)), SP800_22::igamc(0.5, 0.7), 1e-14);
+    EXPECT_NEAR(std::exp(-40.0) * (1 + 40.0 + 800.0), SP800_22::igamc(3.0, 40.0), 1e-25);
+}
+
+TEST(SP800_22Test, StatisticsMatchBitByBitDefinitions) {
+    std::mt19937 rng(41);
+    std::vector<uint8_t> data(20003);                                           // -Not a whole number of words
+    for (uint8_t& b : data) b = static_cast<uint8_t>(rng() >> 24);
+    SP800_22::Config config;
+    config.blockFrequencyBits = 100;                                            // -Blocks not byte aligned
+    config.serialBits = 5;
+    config.approximateEntropyBits = 3;
+    const SP800_22::Results r = SP800_22::run(data.data(), data.size(), config);
+    const size_t n = data.size() * 8;
+    ASSERT_EQ(n, r.bits);
+
+    int64_t sum = 0;
+    size_t runs = 1;
+    for (size_t i = 0; i < n; i++) {
+        sum += bit_at(data, i) ? 1 : -1;
+        if (i + 1 < n && bit_at(data, i) != bit_at(data, i + 1)) runs++;
+    }
+    EXPECT_NEAR(std::fabs(double(sum)) / std::sqrt(double(n)), r.monobit.statistic, 1e-12);
+    EXPECT_NEAR(std::erfc(r.monobit.statistic / std::sqrt(2.0)), r.monobit.pValue, 1e-12);
+    EXPECT_EQ(double(runs), r.runs.statistic);
+
+    double chi = 0;
+    for (size_t k = 0; k < n / 100; k++) {
+        double ones = 0;
+        for (size_t i = k * 100; i < (k + 1) * 100; i++) ones += bit_at(data, i);
+        chi += (ones / 100 - 0.5) * (ones / 100 - 0.5);
+    }
+    EXPECT_NEAR(4 * 100 * chi, r.blockFrequency.statistic, 1e-6);
+
+    // Cyclic pattern counts, straight from the definition
+    auto psi2 = [&](size_t m) {
+        if (m == 0) return 0.0;
+        std::vector<double> counts(size_t(1) << m, 0);
+        for (size_t i = 0; i < n; i++) {
+            size_t p = 0;
+            for (size_t j = 0; j < m; j++) p = p << 1 | size_t(bit_at(data, (i + j) % n));
+            counts[p]++;
+        }
+        double squares = 0;
+        for (double c : counts) squares += c * c;
+        return squares * double(counts.size()) / double(n) - double(n);
+    };
+    auto phi = [&](size_t m) {
+        std::vector<double> counts(size_t(1) << m, 0);
+        for (size_t i = 0; i < n; i++) {
+            size_t p = 0;
+            for (size_t j = 0; j < m; j++) p = p << 1 | size_t(bit_at(data, (i + j) % n));
+            counts[p]++;
+        }
+        double s = 0;
+        for (double c : counts) if (c > 0) s += c / double(n) * std::log(c / double(n));
+        return s;
+    };
+    EXPECT_NEAR(psi2(5) - psi2(4), r.serial1.statistic, 1e-6);
+    EXPECT_NEAR(psi2(5) - 2 * psi2(4) + psi2(3), r.serial2.statistic, 1e-6);
+    EXPECT_NEAR(2.0 * double(n) * (std::log(2.0) - (phi(3) - phi(4))), r.approximateEntropy.statistic, 1e-6);
+
+    EXPECT_TRUE(r.passed()) << "Random bytes";
+}
+
+TEST(SP800_22Test, PatternLengthsBoundedBySequence) {
+    // 1 KiB: n = 8192, so serial m < 11 and approximate entropy m < 8; p-values stay calibrated at the cap
+    std::mt19937 rng(43);
+    std::vector<uint8_t> data(1024);
+    size_t failures = 0;
+    for (int trial = 0; trial < 300; trial++) {
+        for (uint8_t& b : data) b = static_cast<uint8_t>(rng() >> 24);
+        const SP800_22::Results r = SP800_22::run(data.data(), data.size());
+        ASSERT_EQ(10u, r.serialBits);
+        ASSERT_EQ(7u, r.approximateEntropyBits);
+        if (r.approximateEntropy.pValue < 0.01) failures++;
+    }
+    EXPECT_LE(failures, 10u) << "About 3 expected at alpha = 0.01";
+
+    std::vector<uint8_t> large(64 * 1024);
+    for (uint8_t& b : large) b = static_cast<uint8_t>(rng() >> 24);
+    const SP800_22::Results r = SP800_22::run(large.data(), large.size());
+    EXPECT_EQ(16u, r.serialBits) << "Defaults apply from 2^19 bits";
+    EXPECT_EQ(10u, r.approximateEntropyBits);
+}
+
+TEST(SP800_22Test, RepeatedBlocksFailPatternTests) {
+    std::mt19937 rng(3);
+    std::vector<uint8_t> random(1 << 20), repeated(1 << 20);
+    for (uint8_t& b : random) b = static_cast<uint8_t>(rng() >> 24);
+    for (size_t i = 0; i < repeated.size(); i++) repeated[i] = random[i % 16];  // -ECB over a constant plaintext
+    const SP800_22::Results good = SP800_22::run(random.data(), random.size());
+    const SP800_22::Results bad = SP800_22::run(repeated.data(), repeated.size());
+    EXPECT_TRUE(good.passed());
+    EXPECT_FALSE(bad.passed());
+    EXPECT_LT(bad.serial1.pValue, 1e-10);
+    EXPECT_LT(bad.approximateEntropy.pValue, 1e-10);
+
+    EXPECT_THROW(SP800_22::run(random.data(), 15), std::invalid_argument);
+    SP800_22::Config config;
+    config.serialBits = 2;
+    EXPECT_THROW(SP800_22::run(random.data(), random.size(), config), std::invalid_argument);
+}